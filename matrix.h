@@ -77,11 +77,690 @@
 
 #include <cstdio>
 #include <cstring>
+#include <cmath>
 #include <cassert>
 #include <new>
+#include <cstddef>
+#if __cplusplus >= 201103L
+#include <utility>
+#endif
 
 extern void canary_bird();
 
+/*
+ * Portable implementations of the DSPF kernels (TI C67x DSPLIB)
+ * 
+ * The specialized code paths for Matrix<double> and Matrix<float> 
+ * are enabled when the DSPLIB headers are included (see above).
+ * Define MATRIX_HOST_DSPF to enable them on other platforms, such as x86 Linux,
+ * with the following kernels of the same signatures, 
+ * e.g., in order to test the paths on a build server.
+ * A kernel is defined only if the corresponding DSPLIB header is not included.
+ * Unlike the DSPLIB ones, they accept any sizes.
+ */
+#if defined(MATRIX_HOST_DSPF)
+
+/**
+ * r = x * y, where x is r1 x c1, y is c1 x c2, and r is r1 x c2, all row-major.
+ * The loops are ordered so that the innermost one runs along the rows of y and r.
+ */
+template <class FloatT>
+void matrix_host_dspf_mat_mul(
+    const FloatT *x, const int &r1, const int &c1,
+    const FloatT *y, const int &c2,
+    FloatT *r){
+  for(int i(0); i < r1; i++, x += c1, r += c2){
+    for(int j(0); j < c2; j++){r[j] = FloatT(0);}
+    for(int k(0); k < c1; k++){
+      const FloatT x_ik(x[k]);
+      const FloatT *y_k(y + k * c2);
+      for(int j(0); j < c2; j++){r[j] += x_ik * y_k[j];}
+    }
+  }
+}
+
+/**
+ * r = x^{T}, where x is rows x cols, and r is cols x rows, both row-major.
+ * It is tiled so that both of the source and destination are accessed 
+ * in cache-friendly order.
+ */
+template <class FloatT>
+void matrix_host_dspf_mat_trans(
+    const FloatT *x, const int &rows, const int &cols,
+    FloatT *r){
+  static const int tile(16);
+  for(int i0(0); i0 < rows; i0 += tile){
+    const int i1((i0 + tile < rows) ? (i0 + tile) : rows);
+    for(int j0(0); j0 < cols; j0 += tile){
+      const int j1((j0 + tile < cols) ? (j0 + tile) : cols);
+      for(int j(j0); j < j1; j++){
+        for(int i(i0); i < i1; i++){r[j * rows + i] = x[i * cols + j];}
+      }
+    }
+  }
+}
+
+#if !defined(DSPF_DP_MAT_MUL_H_)
+#define DSPF_DP_MAT_MUL_H_
+inline void DSPF_dp_mat_mul(double *x, const int r1, const int c1,
+    double *y, const int c2, double *r){
+  matrix_host_dspf_mat_mul(x, r1, c1, y, c2, r);
+}
+#endif
+#if !defined(DSPF_SP_MAT_MUL_ASM_H_)
+#define DSPF_SP_MAT_MUL_ASM_H_
+inline void DSPF_sp_mat_mul(float *x, const int r1, const int c1,
+    float *y, const int c2, float *r){
+  matrix_host_dspf_mat_mul(x, r1, c1, y, c2, r);
+}
+#endif
+#if !defined(DSPF_DP_MAT_TRANS_H_)
+#define DSPF_DP_MAT_TRANS_H_
+inline void DSPF_dp_mat_trans(const double *x, const int rows, const int cols, double *r){
+  matrix_host_dspf_mat_trans(x, rows, cols, r);
+}
+#endif
+#if !defined(DSPF_SP_MAT_TRANS_ASM_H_)
+#define DSPF_SP_MAT_TRANS_ASM_H_
+inline void DSPF_sp_mat_trans(const float *x, const int rows, const int cols, float *r){
+  matrix_host_dspf_mat_trans(x, rows, cols, r);
+}
+#endif
+#if !defined(DSPF_DP_BLK_MOVE_H_)
+#define DSPF_DP_BLK_MOVE_H_
+inline void DSPF_dp_blk_move(const double *x, double *r, const int nx){
+  std::memmove(r, x, sizeof(double) * nx);
+}
+#endif
+#if !defined(DSPF_SP_BLK_MOVE_ASM_H_)
+#define DSPF_SP_BLK_MOVE_ASM_H_
+inline void DSPF_sp_blk_move(const float *x, float *r, const int nx){
+  std::memmove(r, x, sizeof(float) * nx);
+}
+#endif
+
+#endif
+
+/*
+ * Kernels for element-wise operations
+ * 
+ * Each operand is specified by its buffer and its row and column strides,
+ * i.e., element (i, j) of X is x[i * x_rs + j * x_cs], 
+ * so that dense storage and views on it are handled in the same way.
+ * The loops are reordered so that the innermost one runs along 
+ * the smaller stride of the destination, 
+ * and the unit stride case is written out for the auto-vectorization.
+ */
+
+/**
+ * Reorder a r x c strided problem so that the column stride of the destination 
+ * is not larger than its row stride.
+ * 
+ * @return (bool) true if the row and the column are exchanged
+ */
+inline bool mat_elementwise_order(
+    int &r, int &c, int &y_rs, int &y_cs){
+  if(((y_cs < 0) ? -y_cs : y_cs) <= ((y_rs < 0) ? -y_rs : y_rs)){return false;}
+  int temp;
+  temp = r; r = c; c = temp;
+  temp = y_rs; y_rs = y_cs; y_cs = temp;
+  return true;
+}
+
+/**
+ * X = alpha * X
+ */
+template <class FloatT>
+void mat_scale(
+    int r, int c, const FloatT &alpha,
+    FloatT *x, int x_rs, int x_cs){
+  mat_elementwise_order(r, c, x_rs, x_cs);
+  for(int i(0); i < r; i++, x += x_rs){
+    if(x_cs == 1){
+      for(int j(0); j < c; j++){x[j] *= alpha;}
+    }else{
+      for(int j(0); j < c; j++){x[j * x_cs] *= alpha;}
+    }
+  }
+}
+
+/*
+ * Kernels for transposition
+ * 
+ * A transposed copy, whose source and destination have their unit strides
+ * along different axes, is split recursively in halves of the longer side 
+ * until both sides fit in a tile (cache-oblivious), 
+ * so that neither of them streams through the cache with a large stride.
+ * Each tile is transposed by a kernel, which is replaced with 
+ * the one exchanging SIMD registers (4x4, 8x8) on x86.
+ * The tile size can be tuned by defining MATRIX_TRANSPOSE_TILE;
+ * the rows of a tile should be long enough for the hardware prefetcher.
+ */
+#ifndef MATRIX_TRANSPOSE_TILE
+#define MATRIX_TRANSPOSE_TILE 128
+#endif
+
+/**
+ * Transpose a tile, y[i * y_rs + j] = x[i + j * x_cs] (0 <= i < r, 0 <= j < c),
+ * generic version.
+ */
+template <class FloatT>
+void mat_transpose_kernel_generic(
+    const int r, const int c,
+    const FloatT *x, const int x_cs,
+    FloatT *y, const int y_rs){
+  for(int i(0); i < r; i++, x++, y += y_rs){
+    for(int j(0); j < c; j++){y[j] = x[j * x_cs];}
+  }
+}
+
+/**
+ * Tile kernel for transposition
+ */
+template <class FloatT>
+struct mat_transpose_kernel_t {
+  typedef void (*kernel_t)(
+      const int, const int,
+      const FloatT *, const int,
+      FloatT *, const int);
+  kernel_t kernel;
+  int width; ///< register block, to which the tiles are aligned
+  
+  mat_transpose_kernel_t() : kernel(mat_transpose_kernel_generic<FloatT>), width(1) {}
+  
+  /**
+   * Return the kernel for the type and the running CPU, 
+   * which is selected only once.
+   * 
+   */
+  static const mat_transpose_kernel_t &get(){
+    static const mat_transpose_kernel_t instance;
+    return instance;
+  }
+};
+
+/**
+ * Transposed copy, y[i * y_rs + j] = x[i + j * x_cs] (0 <= i < r, 0 <= j < c),
+ * where the problem is divided recursively down to the tile size.
+ */
+template <class FloatT>
+void mat_transpose_recursive(
+    int r, int c,
+    const FloatT *x, const int x_cs,
+    FloatT *y, const int y_rs,
+    const mat_transpose_kernel_t<FloatT> &k_info){
+  while((r > MATRIX_TRANSPOSE_TILE) || (c > MATRIX_TRANSPOSE_TILE)){
+    if(r >= c){
+      int r2(r / 2);
+      r2 += (k_info.width - (r2 % k_info.width)) % k_info.width;
+      mat_transpose_recursive(r2, c, x, x_cs, y, y_rs, k_info);
+      x += r2; y += r2 * y_rs; r -= r2;
+    }else{
+      int c2(c / 2);
+      c2 += (k_info.width - (c2 % k_info.width)) % k_info.width;
+      mat_transpose_recursive(r, c2, x, x_cs, y, y_rs, k_info);
+      x += c2 * x_cs; y += c2; c -= c2;
+    }
+  }
+  k_info.kernel(r, c, x, x_cs, y, y_rs);
+}
+
+/**
+ * In-place transposition of n x n matrix A (a[i * a_rs + j * a_cs] is A(i, j)).
+ * Each pair of the off-diagonal tiles is exchanged through a temporary tile.
+ */
+template <class FloatT>
+void mat_transpose_square(
+    const int n,
+    FloatT *a, int a_rs, int a_cs){
+  if(a_rs == 1){ // A^{T} is transposed as well
+    a_rs = a_cs; a_cs = 1;
+  }
+  if(a_cs != 1){
+    for(int i(0); i < n; i++){
+      for(int j(i + 1); j < n; j++){
+        FloatT temp(a[i * a_rs + j * a_cs]);
+        a[i * a_rs + j * a_cs] = a[j * a_rs + i * a_cs];
+        a[j * a_rs + i * a_cs] = temp;
+      }
+    }
+    return;
+  }
+  const mat_transpose_kernel_t<FloatT> &k_info(mat_transpose_kernel_t<FloatT>::get());
+  static const int nb(32); // two tiles and the temporary stay in L1
+  FloatT temp[nb * nb];
+  for(int i(0); i < n; i += nb){
+    const int bi((n - i < nb) ? (n - i) : nb);
+    FloatT *a_ii(a + i * a_rs + i);
+    for(int p(0); p < bi; p++){
+      for(int q(p + 1); q < bi; q++){
+        FloatT temp2(a_ii[p * a_rs + q]);
+        a_ii[p * a_rs + q] = a_ii[q * a_rs + p];
+        a_ii[q * a_rs + p] = temp2;
+      }
+    }
+    for(int j(i + nb); j < n; j += nb){
+      const int bj((n - j < nb) ? (n - j) : nb);
+      FloatT *a_ij(a + i * a_rs + j), *a_ji(a + j * a_rs + i);
+      k_info.kernel(bj, bi, a_ij, a_rs, temp, bi); // temp = A_ij^{T}
+      k_info.kernel(bi, bj, a_ji, a_rs, a_ij, a_rs); // A_ij = A_ji^{T}
+      for(int p(0); p < bj; p++){ // A_ji = temp
+        for(int q(0); q < bi; q++){a_ji[p * a_rs + q] = temp[p * bi + q];}
+      }
+    }
+  }
+}
+
+/**
+ * Y = X
+ */
+template <class FloatT>
+void mat_copy(
+    int r, int c,
+    const FloatT *x, int x_rs, int x_cs,
+    FloatT *y, int y_rs, int y_cs){
+  if(mat_elementwise_order(r, c, y_rs, y_cs)){
+    int temp(x_rs); x_rs = x_cs; x_cs = temp;
+  }
+  if((x_rs == 1) && (y_cs == 1) && (r > 1) && (c > 1)){
+    mat_transpose_recursive(r, c, x, x_cs, y, y_rs, 
+        mat_transpose_kernel_t<FloatT>::get());
+    return;
+  }
+  for(int i(0); i < r; i++, x += x_rs, y += y_rs){
+    if((x_cs == 1) && (y_cs == 1)){
+      for(int j(0); j < c; j++){y[j] = x[j];}
+    }else{
+      for(int j(0); j < c; j++){y[j * y_cs] = x[j * x_cs];}
+    }
+  }
+}
+
+/**
+ * Y = alpha * X + beta * Y, where Y is not read if beta is zero
+ */
+template <class FloatT>
+void mat_axpby(
+    int r, int c, const FloatT &alpha,
+    const FloatT *x, int x_rs, int x_cs,
+    const FloatT &beta,
+    FloatT *y, int y_rs, int y_cs){
+  if(mat_elementwise_order(r, c, y_rs, y_cs)){
+    int temp(x_rs); x_rs = x_cs; x_cs = temp;
+  }
+  for(int i(0); i < r; i++, x += x_rs, y += y_rs){
+    if((x_cs == 1) && (y_cs == 1)){
+      if(beta == FloatT(0)){
+        for(int j(0); j < c; j++){y[j] = alpha * x[j];}
+      }else if(beta == FloatT(1)){
+        for(int j(0); j < c; j++){y[j] += alpha * x[j];}
+      }else{
+        for(int j(0); j < c; j++){y[j] = alpha * x[j] + beta * y[j];}
+      }
+    }else{
+      if(beta == FloatT(0)){
+        for(int j(0); j < c; j++){y[j * y_cs] = alpha * x[j * x_cs];}
+      }else{
+        for(int j(0); j < c; j++){
+          y[j * y_cs] = alpha * x[j * x_cs] + beta * y[j * y_cs];
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Alignment of the memory supplied by the allocators in bytes,
+ * which must be a power of two and enough for any element type.
+ */
+#ifndef MATRIX_ALLOCATION_ALIGNMENT
+#define MATRIX_ALLOCATION_ALIGNMENT 16
+#endif
+
+/*
+ * Memory allocation of matrices
+ * 
+ * The buffers and the storage objects of matrices are obtained from
+ * the allocator selected on the current thread, which is the global heap 
+ * by default. Another allocator is selected within the lifetime of
+ * a Matrix_Allocator::scope_t, e.g.,
+ * 
+ *   Matrix_ArenaAllocator arena;
+ *   {
+ *     Matrix_Allocator::scope_t scope(arena);
+ *     // matrices created here are placed in the arena
+ *   }
+ *   arena.reset(); // after all of them are destroyed
+ * 
+ * Each allocation remembers its allocator, so that it is returned to
+ * the right one wherever it is released.
+ * The selection is per thread with C++11, otherwise global.
+ */
+class Matrix_Allocator {
+  public:
+    virtual ~Matrix_Allocator(){}
+    
+    /**
+     * Allocate memory aligned at least to MATRIX_ALLOCATION_ALIGNMENT.
+     * 
+     * @param size size in bytes
+     * @return (void *) allocated memory; std::bad_alloc is thrown on failure
+     */
+    virtual void *allocate(const std::size_t &size) = 0;
+    
+    /**
+     * Release memory obtained by allocate().
+     * 
+     * @param ptr memory
+     * @param size size in bytes, which was passed to allocate()
+     */
+    virtual void deallocate(void *ptr, const std::size_t &size) = 0;
+    
+    /**
+     * Allocator with the global operator new / delete.
+     */
+    static Matrix_Allocator &heap(){
+      struct heap_t : public Matrix_Allocator {
+        void *allocate(const std::size_t &size){return ::operator new(size);}
+        void deallocate(void *ptr, const std::size_t &){::operator delete(ptr);}
+      };
+      static heap_t allocator;
+      return allocator;
+    }
+  
+  protected:
+    /**
+     * @return (Matrix_Allocator *) allocator selected on the current thread,
+     * or NULL for the heap
+     */
+    static Matrix_Allocator *&selected(){
+#if __cplusplus >= 201103L
+      static thread_local Matrix_Allocator *allocator(NULL);
+#else
+      static Matrix_Allocator *allocator(NULL);
+#endif
+      return allocator;
+    }
+    
+  public:
+    /**
+     * Allocator selected on the current thread.
+     * 
+     * @return (Matrix_Allocator) allocator
+     */
+    static Matrix_Allocator &current(){
+      Matrix_Allocator *allocator(selected());
+      return allocator ? *allocator : heap();
+    }
+    
+    /**
+     * Allocation with an allocator, where NULL means the heap,
+     * which is called directly without a virtual function call.
+     * 
+     * @param allocator allocator, or NULL
+     * @param size size in bytes
+     * @return (void *) allocated memory
+     */
+    static void *allocate_with(Matrix_Allocator *allocator, const std::size_t &size){
+      return allocator ? allocator->allocate(size) : ::operator new(size);
+    }
+    
+    /**
+     * Release memory obtained by allocate_with().
+     * 
+     * @param allocator allocator, or NULL
+     * @param ptr memory
+     * @param size size in bytes
+     */
+    static void deallocate_with(
+        Matrix_Allocator *allocator, void *ptr, const std::size_t &size){
+      if(allocator){
+        allocator->deallocate(ptr, size);
+      }else{
+        ::operator delete(ptr);
+      }
+    }
+    
+    /**
+     * Allocation with the current allocator.
+     * 
+     * @param allocator where the current allocator (NULL for the heap) is stored 
+     * for deallocate_with()
+     * @param size size in bytes
+     * @return (void *) allocated memory
+     */
+    static void *allocate_current(Matrix_Allocator *&allocator, const std::size_t &size){
+      allocator = selected();
+      return allocate_with(allocator, size);
+    }
+    
+    /**
+     * Selector of the allocator, which is effective until it is destroyed.
+     * Scopes can be nested.
+     */
+    class scope_t {
+      Matrix_Allocator *previous;
+      scope_t(const scope_t &);
+      scope_t &operator=(const scope_t &);
+    public:
+      scope_t(Matrix_Allocator &allocator) : previous(selected()){
+        selected() = &allocator;
+      }
+      ~scope_t(){selected() = previous;}
+    };
+    
+    /**
+     * Allocate memory from the current allocator, 
+     * which is recorded in front of the returned memory.
+     * 
+     * @param size size in bytes
+     * @return (void *) allocated memory
+     */
+    static void *allocate_tagged(const std::size_t &size){
+      Matrix_Allocator *allocator;
+      char *ptr(static_cast<char *>(
+          allocate_current(allocator, MATRIX_ALLOCATION_ALIGNMENT + size)));
+      *reinterpret_cast<Matrix_Allocator **>(ptr) = allocator;
+      return ptr + MATRIX_ALLOCATION_ALIGNMENT;
+    }
+    
+    /**
+     * Release memory obtained by allocate_tagged().
+     * 
+     * @param ptr memory
+     * @param size size in bytes, which was passed to allocate_tagged()
+     */
+    static void deallocate_tagged(void *ptr, const std::size_t &size){
+      if(!ptr){return;}
+      char *head(static_cast<char *>(ptr) - MATRIX_ALLOCATION_ALIGNMENT);
+      deallocate_with(*reinterpret_cast<Matrix_Allocator **>(head),
+          head, MATRIX_ALLOCATION_ALIGNMENT + size);
+    }
+};
+
+/**
+ * Pool allocator with size classes.
+ * Requests are rounded up to the power of two sizes from 32 bytes 
+ * to 32 << (MATRIX_POOL_CLASSES - 1) bytes, and the released blocks are kept 
+ * in free lists of the classes for reuse, so that allocation and release 
+ * of small matrices are a few instructions without a lock.
+ * Larger requests are passed to the heap.
+ * The memory is returned to the heap when the pool is destroyed,
+ * therefore the pool must outlive the matrices allocated from it.
+ * It is not thread-safe; use an instance per thread, and 
+ * release matrices on the thread which created them.
+ */
+#ifndef MATRIX_POOL_CLASSES
+#define MATRIX_POOL_CLASSES 8
+#endif
+class Matrix_PoolAllocator : public Matrix_Allocator {
+  protected:
+    struct block_t {block_t *next;};
+    block_t *m_free[MATRIX_POOL_CLASSES];
+    block_t *m_chunks;
+    std::size_t m_chunk_size;
+    
+    static int class_of(const std::size_t &size){
+      int i(0);
+      for(std::size_t class_size(32); class_size < size; class_size <<= 1){
+        if(++i >= MATRIX_POOL_CLASSES){return -1;}
+      }
+      return i;
+    }
+    
+    /**
+     * Supply blocks of a class by carving a new chunk.
+     */
+    void refill(const int &i){
+      std::size_t block_size(std::size_t(32) << i);
+      std::size_t blocks((m_chunk_size - MATRIX_ALLOCATION_ALIGNMENT) / block_size);
+      if(blocks < 1){blocks = 1;}
+      char *chunk(static_cast<char *>(
+          ::operator new(MATRIX_ALLOCATION_ALIGNMENT + block_size * blocks)));
+      reinterpret_cast<block_t *>(chunk)->next = m_chunks;
+      m_chunks = reinterpret_cast<block_t *>(chunk);
+      chunk += MATRIX_ALLOCATION_ALIGNMENT;
+      for(std::size_t j(0); j < blocks; j++, chunk += block_size){
+        block_t *block(reinterpret_cast<block_t *>(chunk));
+        block->next = m_free[i];
+        m_free[i] = block;
+      }
+    }
+    
+  private:
+    Matrix_PoolAllocator(const Matrix_PoolAllocator &);
+    Matrix_PoolAllocator &operator=(const Matrix_PoolAllocator &);
+  
+  public:
+    /**
+     * Constructor
+     * 
+     * @param chunk_size size of the chunks obtained from the heap in bytes
+     */
+    Matrix_PoolAllocator(const std::size_t &chunk_size = 0x10000)
+        : m_chunks(NULL), m_chunk_size(chunk_size) {
+      for(int i(0); i < MATRIX_POOL_CLASSES; i++){m_free[i] = NULL;}
+    }
+    
+    ~Matrix_PoolAllocator(){
+      while(m_chunks){
+        block_t *next(m_chunks->next);
+        ::operator delete(m_chunks);
+        m_chunks = next;
+      }
+    }
+    
+    void *allocate(const std::size_t &size){
+      int i(class_of(size));
+      if(i < 0){return ::operator new(size);}
+      if(!m_free[i]){refill(i);}
+      block_t *block(m_free[i]);
+      m_free[i] = block->next;
+      return block;
+    }
+    
+    void deallocate(void *ptr, const std::size_t &size){
+      int i(class_of(size));
+      if(i < 0){
+        ::operator delete(ptr);
+        return;
+      }
+      block_t *block(static_cast<block_t *>(ptr));
+      block->next = m_free[i];
+      m_free[i] = block;
+    }
+};
+
+/**
+ * Arena allocator, which allocates by bumping a pointer in chunks and 
+ * releases everything at once by reset() in O(1).
+ * Individual release does nothing but count the live allocations.
+ * It is suitable for the temporaries of a processing step, e.g., a filter update,
+ * which are all destroyed before the arena is reset for the next step.
+ * The chunks are kept and reused after reset(), and returned to the heap
+ * when the arena is destroyed.
+ * It is not thread-safe; use an instance per thread.
+ */
+class Matrix_ArenaAllocator : public Matrix_Allocator {
+  protected:
+    struct chunk_t {
+      chunk_t *next;
+      std::size_t size;
+    };
+    chunk_t *m_head, *m_current;
+    std::size_t m_offset, m_chunk_size;
+    unsigned int m_live;
+    
+    static char *payload(chunk_t *chunk){
+      return reinterpret_cast<char *>(chunk) + MATRIX_ALLOCATION_ALIGNMENT;
+    }
+    
+  private:
+    Matrix_ArenaAllocator(const Matrix_ArenaAllocator &);
+    Matrix_ArenaAllocator &operator=(const Matrix_ArenaAllocator &);
+  
+  public:
+    /**
+     * Constructor
+     * 
+     * @param chunk_size size of the chunks obtained from the heap in bytes;
+     * a larger request is given its own chunk
+     */
+    Matrix_ArenaAllocator(const std::size_t &chunk_size = 0x10000)
+        : m_head(NULL), m_current(NULL), 
+        m_offset(0), m_chunk_size(chunk_size), m_live(0) {}
+    
+    ~Matrix_ArenaAllocator(){
+      assert(m_live == 0);
+      while(m_head){
+        chunk_t *next(m_head->next);
+        ::operator delete(m_head);
+        m_head = next;
+      }
+    }
+    
+    void *allocate(const std::size_t &size){
+      std::size_t aligned((size + MATRIX_ALLOCATION_ALIGNMENT - 1) 
+          / MATRIX_ALLOCATION_ALIGNMENT * MATRIX_ALLOCATION_ALIGNMENT);
+      while(!m_current || (m_offset + aligned > m_current->size)){
+        chunk_t *next(m_current ? m_current->next : m_head);
+        if((!next) || (next->size < aligned)){
+          // insert a new chunk after the current one
+          std::size_t chunk_size((aligned > m_chunk_size) ? aligned : m_chunk_size);
+          chunk_t *chunk(static_cast<chunk_t *>(
+              ::operator new(MATRIX_ALLOCATION_ALIGNMENT + chunk_size)));
+          chunk->size = chunk_size;
+          chunk->next = next;
+          if(m_current){m_current->next = chunk;}else{m_head = chunk;}
+          next = chunk;
+        }
+        m_current = next;
+        m_offset = 0;
+      }
+      void *res(payload(m_current) + m_offset);
+      m_offset += aligned;
+      ++m_live;
+      return res;
+    }
+    
+    void deallocate(void *, const std::size_t &){--m_live;}
+    
+    /**
+     * Release all the allocations at once.
+     * All the matrices allocated from this arena must have been destroyed.
+     */
+    void reset(){
+      assert(m_live == 0);
+      m_current = m_head;
+      m_offset = 0;
+    }
+    
+    /**
+     * @return (unsigned int) number of allocations not released yet
+     */
+    unsigned int live() const {return m_live;}
+};
+
 template<class FloatT>
 class Array2D;
 
@@ -99,6 +778,7 @@ class Array2D{
   protected:
     unsigned int m_rows;
     unsigned int m_columns;
+    bool m_structured; ///< true if some elements are structural zeros
     
     typedef Array2D<FloatT> self_t;
     typedef Array2D_Dense<FloatT> dense_t;
@@ -110,6 +790,35 @@ class Array2D{
      * @return (self_t *) 
      */
     virtual self_t *shallow_copy() const = 0;
+    
+    /**
+     * Storage objects are also allocated by Matrix_Allocator::current().
+     */
+    static void *operator new(std::size_t size){
+      return Matrix_Allocator::allocate_tagged(size);
+    }
+    static void operator delete(void *ptr, std::size_t size){
+      Matrix_Allocator::deallocate_tagged(ptr, size);
+    }
+    
+    /**
+     * Copy for a new matrix, which shares the buffer until either of them is 
+     * written (copy-on-write), 
+     * unless the buffer is aliased by views, in which case it is copied deeply.
+     * Views are shared as they are.
+     * 
+     * @return (self_t *) copy
+     */
+    virtual self_t *share() const {return shallow_copy();}
+    
+    /**
+     * Make the buffer exclusive before writing to it,
+     * if it is shared by copy-on-write.
+     * 
+     * @param for_view if true, the buffer is marked as aliased,
+     * because a view to write to it is about to be created
+     */
+    virtual void detach(const bool & = false) {}
 
     /**
      * Array2D???
@@ -119,7 +828,7 @@ class Array2D{
      * @param columns ?
      */
     Array2D(const unsigned int &rows, const unsigned int &columns)
-        : m_rows(rows), m_columns(columns){
+        : m_rows(rows), m_columns(columns), m_structured(false){
 #ifdef _DEBUG
       canary_bird();
 #endif
@@ -156,11 +865,136 @@ class Array2D{
     virtual dense_t dense() const = 0;
     
     /**
-     * ?
-     * 
-     * @return (int) ?
+     * Memory layout descriptor, with which element (i, j) is 
+     * buffer[i * row_stride + j * column_stride].
      */
-    unsigned int rows() const{return m_rows;}
+    struct view_t {
+      FloatT *buffer;
+      int row_stride, column_stride;
+      unsigned int rows, columns;
+    };
+    
+    /**
+     * Get the memory layout descriptor,
+     * with which elements can be accessed without virtual function calls.
+     * 
+     * @param v descriptor to be filled
+     * @return (bool) true if the elements are laid out with constant strides,
+     * otherwise false, and v is left unchanged
+     */
+    virtual bool view(view_t &) const {return false;}
+    
+    /**
+     * Memory layout descriptor of symmetric packed storage, 
+     * in which the upper triangle is stored row by row, i.e.,
+     * element (i, j) (i <= j) is buffer[mat_packed_offset(size, i) + j].
+     */
+    struct symmetric_view_t {
+      FloatT *buffer;
+      unsigned int size;
+    };
+    
+    /**
+     * Get the descriptor of symmetric packed storage, 
+     * with which the symmetric kernels touch only half of the elements.
+     * 
+     * @param v descriptor to be filled
+     * @return (bool) true if the storage is symmetric packed one,
+     * otherwise false, and v is left unchanged
+     */
+    virtual bool symmetric_view(symmetric_view_t &) const {return false;}
+    
+    /**
+     * Memory layout descriptor of sparse storage compressed by rows (CSR), 
+     * in which the nonzero elements of row i are values[offsets[i]], ..., 
+     * values[offsets[i + 1] - 1] and their column indices are indices[offsets[i]], ...
+     * in ascending order. If column_major is true, the roles of the rows and 
+     * the columns are exchanged (CSC).
+     */
+    struct sparse_view_t {
+      FloatT *values;
+      int *offsets, *indices;
+      unsigned int rows, columns;
+      bool column_major;
+    };
+    
+    /**
+     * Get the descriptor of sparse storage,
+     * with which the sparse kernels touch only the nonzero elements.
+     * 
+     * @param v descriptor to be filled
+     * @return (bool) true if the storage is sparse one,
+     * otherwise false, and v is left unchanged
+     */
+    virtual bool sparse_view(sparse_view_t &) const {return false;}
+    
+    /**
+     * Memory layout descriptor of banded storage (including diagonal and triangular),
+     * with which element (i, j) in the band, i.e., -lower <= j - i <= upper, is 
+     * buffer[i * row_stride + j * column_stride]; the others are structural zeros,
+     * which must not be accessed through the descriptor.
+     */
+    struct band_view_t {
+      FloatT *buffer;
+      int row_stride, column_stride;
+      unsigned int rows, columns;
+      int lower, upper;
+      
+      /**
+       * @return (band_view_t) descriptor of the transpose
+       */
+      band_view_t transpose() const {
+        band_view_t v = {buffer, column_stride, row_stride, columns, rows, upper, lower};
+        return v;
+      }
+    };
+    
+    /**
+     * Get the descriptor of banded storage,
+     * with which the banded kernels skip the structural zeros.
+     * 
+     * @param v descriptor to be filled
+     * @return (bool) true if the storage is banded one,
+     * otherwise false, and v is left unchanged
+     */
+    virtual bool band_view(band_view_t &) const {return false;}
+    
+    /**
+     * Whether an element can hold a nonzero value.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (bool) false if the element is a structural zero
+     */
+    virtual bool holds(const unsigned int &, const unsigned int &) const {
+      return true;
+    }
+    
+    /**
+     * Whether some elements are structural zeros, 
+     * i.e., holds() is required to be checked before writing.
+     * This is not virtual so as to be tested cheaply per element.
+     * 
+     * @return (bool) true if some elements are structural zeros
+     */
+    bool structured() const {return m_structured;}
+    
+    /**
+     * Whether writing may change the structure of this storage,
+     * such as insertion to sparse storage or the switch of banded storage
+     * to dense one, which views sharing only the buffer cannot follow.
+     *
+     * @return (bool) true if views to write through must share
+     * this storage itself (see Array2D_Aliased)
+     */
+    virtual bool restructurable() const {return false;}
+    
+    /**
+     * ?
+     * 
+     * @return (int) ?
+     */
+    unsigned int rows() const{return m_rows;}
     /**
      * ?
      * 
@@ -178,15 +1012,265 @@ class Array2D{
     virtual FloatT &operator()(
         const unsigned int &row, 
         const unsigned int &column) = 0;
+    
+    /**
+     * Read-only element accessor, which never detaches the buffer.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    virtual const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const = 0;
 };
 
+/*
+ * Size of the header of the control block, which precedes the buffer.
+ * It is a multiple of MATRIX_ALLOCATION_ALIGNMENT, 
+ * so that the buffer is aligned as well as the header.
+ */
+#ifndef MATRIX_BUFFER_HEADER_SIZE
+#define MATRIX_BUFFER_HEADER_SIZE 32
+#endif
+
+/*
+ * Alignment and padding of dense buffers
+ * 
+ * A buffer of at least 4 * MATRIX_ALIGNMENT bytes starts at a MATRIX_ALIGNMENT 
+ * (cache line by default) boundary; smaller ones are aligned only 
+ * to MATRIX_ALLOCATION_ALIGNMENT to save memory.
+ * The rows of a dense matrix whose row is at least MATRIX_ROW_PADDING_THRESHOLD bytes 
+ * are padded to a multiple of MATRIX_SIMD_WIDTH bytes, 
+ * so that every row starts at a SIMD boundary. 
+ * Moreover, a row of a multiple of 4 KiB is extended by one SIMD width,
+ * in order to prevent the rows from aliasing each other in the cache (4K aliasing).
+ * Define MATRIX_NO_ROW_PADDING to lay out the rows contiguously.
+ */
+#ifndef MATRIX_ALIGNMENT
+#define MATRIX_ALIGNMENT 64
+#endif
+#ifndef MATRIX_SIMD_WIDTH
+#if defined(__AVX512F__)
+#define MATRIX_SIMD_WIDTH 64
+#elif defined(__AVX__)
+#define MATRIX_SIMD_WIDTH 32
+#else
+#define MATRIX_SIMD_WIDTH 16
+#endif
+#endif
+#ifndef MATRIX_ROW_PADDING_THRESHOLD
+#define MATRIX_ROW_PADDING_THRESHOLD 256
+#endif
+
+/*
+ * Reference counting of shared buffers
+ * 
+ * Define MATRIX_ATOMIC_REFCOUNT to update the reference counters atomically,
+ * so that matrices sharing a buffer, e.g., shallow copies of one read-only matrix,
+ * can be copied and destroyed on different threads concurrently.
+ * A counter is incremented with relaxed ordering, and decremented with 
+ * acquire-release ordering, so that the last owner sees all the writes 
+ * before releasing the buffer.
+ * Without it, the counters are plain integers, which costs nothing 
+ * in single-threaded programs.
+ * std::atomic is used with C++11, otherwise GCC compatible __atomic builtins.
+ */
+#if defined(MATRIX_ATOMIC_REFCOUNT)
+#if __cplusplus >= 201103L
+#include <atomic>
+#define MATRIX_ATOMIC_REFCOUNT_STD
+#elif !defined(__GNUC__)
+#error "MATRIX_ATOMIC_REFCOUNT requires C++11 or GCC compatible __atomic builtins"
+#endif
+#endif
+
 template <class FloatT>
 class Array2D_BufferManager {
   protected:
+    /**
+     * Control block header, which is allocated together with the buffer 
+     * in a single allocation; the buffer starts MATRIX_BUFFER_HEADER_SIZE bytes
+     * after the header, therefore the reference counter and the first elements
+     * are likely to be on the same cache line.
+     */
+    struct control_t {
+      Matrix_Allocator *allocator; // NULL for the heap
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      std::atomic<int> ref;
+#else
+      int ref;
+#endif
+      unsigned int size;
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      std::atomic<bool> aliased;
+#else
+      bool aliased;
+#endif
+      unsigned short offset; // from the beginning of the allocated memory
+    };
+    
+    static int ref_count(const control_t *control){
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      return control->ref.load(std::memory_order_relaxed);
+#elif defined(MATRIX_ATOMIC_REFCOUNT)
+      return __atomic_load_n(&(control->ref), __ATOMIC_RELAXED);
+#else
+      return control->ref;
+#endif
+    }
+    
+    static bool is_aliased(const control_t *control){
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      return control->aliased.load(std::memory_order_relaxed);
+#elif defined(MATRIX_ATOMIC_REFCOUNT)
+      return __atomic_load_n(&(control->aliased), __ATOMIC_RELAXED);
+#else
+      return control->aliased;
+#endif
+    }
+    
+    static void set_aliased(control_t *control, const bool &aliased){
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      control->aliased.store(aliased, std::memory_order_relaxed);
+#elif defined(MATRIX_ATOMIC_REFCOUNT)
+      __atomic_store_n(&(control->aliased), aliased, __ATOMIC_RELAXED);
+#else
+      control->aliased = aliased;
+#endif
+    }
+    
+    static void ref_increment(control_t *control){
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      control->ref.fetch_add(1, std::memory_order_relaxed);
+#elif defined(MATRIX_ATOMIC_REFCOUNT)
+      __atomic_fetch_add(&(control->ref), 1, __ATOMIC_RELAXED);
+#else
+      ++(control->ref);
+#endif
+    }
+    
+    /**
+     * @return (bool) true if the counter reaches zero
+     */
+    static bool ref_decrement(control_t *control){
+#if defined(MATRIX_ATOMIC_REFCOUNT_STD)
+      return control->ref.fetch_sub(1, std::memory_order_acq_rel) <= 1;
+#elif defined(MATRIX_ATOMIC_REFCOUNT)
+      return __atomic_fetch_sub(&(control->ref), 1, __ATOMIC_ACQ_REL) <= 1;
+#else
+      return (--(control->ref)) <= 0;
+#endif
+    }
+    
     FloatT *m_buffer;
-    int *ref; //?
+    control_t *m_control;
+    
+    static FloatT *buffer_of(control_t *control){
+      return reinterpret_cast<FloatT *>(
+          reinterpret_cast<char *>(control) + MATRIX_BUFFER_HEADER_SIZE);
+    }
+    
+    /**
+     * @return (std::size_t) extra bytes to align a buffer of the specified 
+     * number of elements to MATRIX_ALIGNMENT
+     */
+    static std::size_t alignment_slack(const unsigned int &size){
+      return ((MATRIX_ALIGNMENT > MATRIX_ALLOCATION_ALIGNMENT)
+            && (sizeof(FloatT) * size >= 4 * MATRIX_ALIGNMENT))
+          ? (MATRIX_ALIGNMENT - MATRIX_ALLOCATION_ALIGNMENT)
+          : 0;
+    }
+    
+    /**
+     * Allocate a control block with a buffer of the specified number of elements,
+     * whose reference counter is one, from the current allocator.
+     */
+    static control_t *allocate(const unsigned int &size){
+      (void)sizeof(char[(sizeof(control_t) <= MATRIX_BUFFER_HEADER_SIZE) ? 1 : -1]);
+      Matrix_Allocator *allocator;
+      std::size_t slack(alignment_slack(size));
+      char *head(static_cast<char *>(Matrix_Allocator::allocate_current(allocator,
+          MATRIX_BUFFER_HEADER_SIZE + sizeof(FloatT) * size + slack)));
+      std::size_t offset(slack 
+          ? ((std::size_t)0 - reinterpret_cast<std::size_t>(head + MATRIX_BUFFER_HEADER_SIZE))
+            & (MATRIX_ALIGNMENT - 1)
+          : 0);
+      control_t *control(new(head + offset) control_t);
+      control->offset = (unsigned short)offset;
+      control->allocator = allocator;
+      control->ref = 1;
+      control->size = size;
+      control->aliased = false;
+      FloatT *buffer(buffer_of(control));
+      for(unsigned int i(0); i < size; i++){new(buffer + i) FloatT;}
+      return control;
+    }
+    
+    /**
+     * Decrement the reference counter of a control block, 
+     * and release it if it is not referred anymore.
+     */
+    static void release(control_t *control){
+      if((!control) || (!ref_decrement(control))){return;}
+      FloatT *buffer(buffer_of(control));
+      unsigned int size(control->size);
+      for(unsigned int i(0); i < size; i++){buffer[i].~FloatT();}
+      Matrix_Allocator *allocator(control->allocator);
+      char *head(reinterpret_cast<char *>(control) - control->offset);
+      control->~control_t();
+      Matrix_Allocator::deallocate_with(allocator, head, 
+          MATRIX_BUFFER_HEADER_SIZE + sizeof(FloatT) * size + alignment_slack(size));
+    }
     
     typedef Array2D_BufferManager<FloatT> self_t;
+    
+    /**
+     * Whether the buffer must be detached before being written,
+     * i.e., it is shared by value with other matrices.
+     * 
+     * @return (bool) true if shared and not aliased by views
+     */
+    bool shared() const {
+      return m_control 
+          && (ref_count(m_control) > 1) && (!is_aliased(m_control));
+    }
+    
+    /**
+     * Make the buffer exclusive to this manager (copy-on-write).
+     * A shared buffer is replaced with its copy, while an aliased buffer,
+     * which is intentionally shared with views, is kept.
+     * 
+     * @param for_view if true, the buffer is marked as aliased, 
+     * because a view which writes to it is about to be created
+     */
+    void unshare(const bool &for_view = false){
+      if(!m_control){return;}
+      if(shared()){
+        control_t *control(allocate(m_control->size));
+        FloatT *buffer(buffer_of(control));
+        for(unsigned int i(0); i < m_control->size; i++){buffer[i] = m_buffer[i];}
+        release(m_control);
+        m_control = control;
+        m_buffer = buffer;
+      }
+      if(for_view){set_aliased(m_control, true);}
+    }
+    
+    /**
+     * Whether the buffer can be shared by value with a new copy.
+     * An aliased buffer which is no longer referred by any view is 
+     * turned back to an ordinary one.
+     * 
+     * @return (bool) false if the buffer is aliased by views, 
+     * which means a copy needs its own buffer
+     */
+    bool shareable() const {
+      if((!m_control) || (!is_aliased(m_control))){return true;}
+      if(ref_count(m_control) > 1){return false;}
+      set_aliased(m_control, false);
+      return true;
+    }
   
   public:
     /**
@@ -200,13 +1284,11 @@ class Array2D_BufferManager {
      * Array2D_BufferManager???
      * ?
      * 
-     * @param buffer ?
+     * @param size number of elements
      */
-    Array2D_BufferManager(FloatT *buffer) 
-        : m_buffer(buffer), 
-        ref(new int(0)) {
-      assert(m_buffer && ref);
-      (*ref)++;
+    Array2D_BufferManager(const unsigned int &size) 
+        : m_buffer(NULL), m_control(allocate(size)) {
+      m_buffer = buffer_of(m_control);
     }
     
     /**
@@ -215,18 +1297,30 @@ class Array2D_BufferManager {
      * @param orig 
      */
     Array2D_BufferManager(const self_t &orig) 
-        : m_buffer(orig.m_buffer), ref(orig.ref){
-      if(ref){(*ref)++;}
+        : m_buffer(orig.m_buffer), m_control(orig.m_control){
+      if(m_control){ref_increment(m_control);}
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move constructor.
+     * The buffer and its reference counter are taken over as they are,
+     * so the counter is not touched and the origin becomes empty.
+     * 
+     * @param orig origin
+     */
+    Array2D_BufferManager(self_t &&orig) 
+        : m_buffer(orig.m_buffer), m_control(orig.m_control){
+      orig.m_buffer = NULL;
+      orig.m_control = NULL;
     }
+#endif
     
     /**
      * ?
      */
     virtual ~Array2D_BufferManager(){
-      if(ref && ((--(*ref)) <= 0)){
-        delete [] m_buffer;
-        delete ref;
-      }
+      release(m_control);
     }
     
     /**
@@ -236,13 +1330,31 @@ class Array2D_BufferManager {
      */
     self_t &operator=(const self_t &array){
       if(this != &array){
-        if(ref && ((--(*ref)) <= 0)){delete [] m_buffer; delete ref;}
-        if(m_buffer = array.m_buffer){
-          (*(ref = array.ref))++;
-        }
+        if(array.m_control){ref_increment(array.m_control);}
+        release(m_control);
+        m_buffer = array.m_buffer;
+        m_control = array.m_control;
+      }
+      return *this;
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move assignment.
+     * 
+     * @return (self_t) myself
+     */
+    self_t &operator=(self_t &&array){
+      if(this != &array){
+        release(m_control);
+        m_buffer = array.m_buffer;
+        m_control = array.m_control;
+        array.m_buffer = NULL;
+        array.m_control = NULL;
       }
       return *this;
     }
+#endif
 };
 
 /**
@@ -260,10 +1372,44 @@ class Array2D_Dense
     typedef Array2D<FloatT> root_t;
     typedef Array2D_Dense<FloatT> self_t;
     typedef Array2D_BufferManager<FloatT> buffer_manager_t;
+    
+    unsigned int m_ld;
   
   public:
     using buffer_manager_t::m_buffer;
     
+    /**
+     * Leading dimension (row stride in elements) of a dense buffer, 
+     * which is padded to MATRIX_SIMD_WIDTH bytes and avoids 4K aliasing.
+     * Vectors and matrices of short rows are not padded.
+     * 
+     * @param rows number of rows
+     * @param columns number of columns
+     * @return (unsigned int) leading dimension
+     */
+    static unsigned int leading_dimension(
+        const unsigned int &rows, const unsigned int &columns){
+#if defined(MATRIX_NO_ROW_PADDING)
+      return columns;
+#else
+      const unsigned int width(MATRIX_SIMD_WIDTH / sizeof(FloatT));
+      if((rows <= 1) || (width <= 1) || (MATRIX_SIMD_WIDTH % sizeof(FloatT) != 0)
+          || (sizeof(FloatT) * columns < MATRIX_ROW_PADDING_THRESHOLD)){
+        return columns;
+      }
+      unsigned int ld((columns + width - 1) / width * width);
+      if((sizeof(FloatT) * ld) % 4096 == 0){ld += width;}
+      return ld;
+#endif
+    }
+    
+    /**
+     * Row stride of the buffer in elements
+     * 
+     * @return (unsigned int) leading dimension
+     */
+    unsigned int ld() const {return m_ld;}
+    
     /**
      * Array2D_Dense???
      * 2?
@@ -276,7 +1422,8 @@ class Array2D_Dense
         const unsigned int &rows, 
         const unsigned int &columns) 
         : super_t(rows, columns), 
-        buffer_manager_t(new FloatT[rows * columns]) {
+        buffer_manager_t(rows * leading_dimension(rows, columns)),
+        m_ld(leading_dimension(rows, columns)) {
         
     }
     
@@ -294,9 +1441,17 @@ class Array2D_Dense
         const unsigned int &columns,
         const FloatT *serialized)
         : super_t(rows, columns),
-        buffer_manager_t(new FloatT[rows * columns]) {
-      memcpy(m_buffer, serialized, 
-          sizeof(FloatT) * rows * columns);
+        buffer_manager_t(rows * leading_dimension(rows, columns)),
+        m_ld(leading_dimension(rows, columns)) {
+      if(m_ld == columns){
+        memcpy(m_buffer, serialized, 
+            sizeof(FloatT) * rows * columns);
+      }else{
+        for(unsigned int i(0); i < rows; i++){
+          memcpy(m_buffer + i * m_ld, serialized + i * columns, 
+              sizeof(FloatT) * columns);
+        }
+      }
     }
     
     /**
@@ -305,9 +1460,22 @@ class Array2D_Dense
      */
     Array2D_Dense(const self_t &orig) 
         : super_t(orig.m_rows, orig.m_columns),
-        buffer_manager_t(orig) {
+        buffer_manager_t(orig), m_ld(orig.m_ld) {
+      
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move constructor.
+     * The buffer is stolen from the origin without touching its reference counter.
+     * 
+     */
+    Array2D_Dense(self_t &&orig) 
+        : super_t(orig.m_rows, orig.m_columns),
+        buffer_manager_t(std::move(orig)), m_ld(orig.m_ld) {
       
     }
+#endif
     
     /**
      * ?
@@ -325,16 +1493,38 @@ class Array2D_Dense
     root_t *copy() const {
       self_t *array(new self_t(rows(), columns()));
       memcpy(array->buffer(), m_buffer, 
-          sizeof(FloatT) * rows() * columns());
+          sizeof(FloatT) * rows() * m_ld);
       return array;
     }
     
     /**
-     * ?
+     * Dense copy, which shares the buffer in the same way as share().
      *
      * @return (self_t)
      */
-    self_t dense() const {return self_t(*this);}
+    self_t dense() const {
+      if(buffer_manager_t::shareable()){return self_t(*this);}
+      root_t *array(copy());
+      self_t res(*static_cast<self_t *>(array));
+      delete array;
+      return res;
+    }
+    
+    typedef typename super_t::view_t view_t;
+    
+    /**
+     * Memory layout descriptor of the row-major buffer, whose rows may be padded.
+     * 
+     * @return (bool) always true
+     */
+    bool view(view_t &v) const {
+      v.buffer = m_buffer;
+      v.row_stride = (int)m_ld;
+      v.column_stride = 1;
+      v.rows = rows();
+      v.columns = columns();
+      return true;
+    }
     
     /**
      * ??
@@ -344,6 +1534,24 @@ class Array2D_Dense
      */
     root_t *shallow_copy() const{return new self_t(*this);}
     
+    /**
+     * Copy-on-write copy, which shares the buffer unless it is aliased by views.
+     * 
+     * @return (root_t *) copy
+     */
+    root_t *share() const{
+      return buffer_manager_t::shareable() ? shallow_copy() : copy();
+    }
+    
+    /**
+     * Detach the buffer if it is shared by copy-on-write.
+     * 
+     * @param for_view mark the buffer as aliased by views
+     */
+    void detach(const bool &for_view = false){
+      buffer_manager_t::unshare(for_view);
+    }
+    
     /**
      * 
      * 
@@ -355,7 +1563,22 @@ class Array2D_Dense
         const unsigned int &row, 
         const unsigned int &column){
       assert((row < rows()) && (column < columns()));
-      return *(m_buffer + (row * columns()) + column);
+      if(buffer_manager_t::shared()){buffer_manager_t::unshare();}
+      return *(m_buffer + (row * m_ld) + column);
+    }
+    
+    /**
+     * Read-only element accessor
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      assert((row < rows()) && (column < columns()));
+      return *(m_buffer + (row * m_ld) + column);
     }
     
     /**
@@ -363,8 +1586,9 @@ class Array2D_Dense
      * 
      */
     void clear(){
+      buffer_manager_t::unshare();
       for(unsigned int i(0); 
-          i < rows() * columns(); 
+          i < rows() * m_ld; 
           i++){*(m_buffer + i) = FloatT(0);}
     }
     
@@ -377,1176 +1601,6911 @@ class Array2D_Dense
       buffer_manager_t::operator=(another);
       super_t::m_rows = another.m_rows;
       super_t::m_columns = another.m_columns;
+      m_ld = another.m_ld;
+      return *this;
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move assignment.
+     * 
+     * @return (self_t) myself
+     */
+    self_t &operator=(self_t &&another){
+      buffer_manager_t::operator=(std::move(another));
+      super_t::m_rows = another.m_rows;
+      super_t::m_columns = another.m_columns;
+      m_ld = another.m_ld;
       return *this;
     }
+#endif
 };
 
 /**
- * Delegated two-dimension array abstract class.
+ * Offset of the row i of n x n symmetric packed storage, where the upper triangle
+ * is stored row by row; element (i, j) (i <= j) is at mat_packed_offset(n, i) + j.
+ * The offset is shifted by -i so that the column index is added directly.
  * 
- * 2?2??
+ * @return (int) offset
+ */
+inline int mat_packed_offset(const int &n, const int &i){
+  return i * n - ((i * (i + 1)) >> 1);
+}
+
+/**
+ * Symmetric two-dimension array class, whose upper triangle is packed,
+ * therefore it uses about half of the memory of the dense one.
+ * Element (i, j) and (j, i) are the same, 
+ * so writing one of them changes the other.
+ * It is shared by copy-on-write in the same way as Array2D_Dense.
  * 
  */
-template<class FloatT>
-class Array2D_Delegate : public Array2D<FloatT>{
-  private:
+template <class FloatT>
+class Array2D_SymmetricPacked 
+    : public Array2D<FloatT>, public Array2D_BufferManager<FloatT> {
+  protected:
+    
     typedef Array2D<FloatT> super_t;
     typedef Array2D<FloatT> root_t;
-    typedef Array2D_Dense<FloatT> dense_t;
-    typedef Array2D_Delegate<FloatT> self_t;
-    
-    root_t *m_target;
-    
-  protected:
-    /**
-     * 
-     * 
-     */
-    root_t &getTarget() const{return *m_target;}
+    typedef Array2D_SymmetricPacked<FloatT> self_t;
+    typedef Array2D_BufferManager<FloatT> buffer_manager_t;
   
   public:
+    using buffer_manager_t::m_buffer;
     using super_t::rows;
     using super_t::columns;
     
     /**
-     * 
+     * Number of the packed elements
      * 
-     * @return (root_t) 
+     * @param size number of rows (and columns)
+     * @return (unsigned int) size * (size + 1) / 2
      */
-    const root_t *getParent() const{return m_target;}
+    static unsigned int packed_size(const unsigned int &size){
+      return (size * (size + 1)) / 2;
+    }
     
     /**
-     * Array2D_Delegate(2?)???
+     * Constructor, whose elements are not initialized.
      * 
-     * @param rows ?
-     * @param columns ?
-     * @param array 
+     * @param size number of rows (and columns)
      */
-    Array2D_Delegate(const unsigned int &rows,
-        const unsigned int &columns,
-        const root_t &array)
-        : super_t(rows, columns), m_target(array.shallow_copy()){}
+    Array2D_SymmetricPacked(const unsigned int &size) 
+        : super_t(size, size), buffer_manager_t(packed_size(size)) {}
     
     /**
-     * ??
+     * Copy constructor, which shares the buffer.
      * 
      */
-    Array2D_Delegate(const Array2D_Delegate &array)
-        : super_t(array.rows(), array.columns()), 
-        m_target(array.m_target->shallow_copy()){}
-        
-    /**
-     * ?
-     */
-    ~Array2D_Delegate(){delete m_target;}
-        
+    Array2D_SymmetricPacked(const self_t &orig) 
+        : super_t(orig.m_rows, orig.m_columns), buffer_manager_t(orig) {}
+    
+    ~Array2D_SymmetricPacked(){}
+    
     /**
-     * 
+     * Deep copy
      * 
-     * @param row ?(?0)
-     * @param column ?(?0)
-     * @return (FloatT) 
+     * @return (root_t *) copy
      */
-    inline FloatT &operator()(
-        const unsigned int &row, 
-        const unsigned int &column){
-      return m_target->operator()(row, column);
+    root_t *copy() const {
+      self_t *array(new self_t(rows()));
+      memcpy(array->buffer(), m_buffer, sizeof(FloatT) * packed_size(rows()));
+      return array;
     }
     
     /**
-     * ?
+     * Dense copy, in which both triangles are expanded
      *
-     * @return (dense_t)
+     * @return (Array2D_Dense<FloatT>)
      */
-    dense_t dense() const {
-      dense_t array(rows(), columns());
-      for(unsigned int i(0); i < array.rows(); i++){
-        for(unsigned int j(0); j < array.columns(); j++){
-          array(i, j) 
-            = (const_cast<Array2D_Delegate *>(this))->operator()(i, j);
+    Array2D_Dense<FloatT> dense() const {
+      const int n((int)rows());
+      Array2D_Dense<FloatT> array(n, n);
+      FloatT *buffer(array.buffer());
+      const int ld((int)array.ld());
+      for(int i(0); i < n; i++){
+        const FloatT *src(m_buffer + mat_packed_offset(n, i));
+        for(int j(i); j < n; j++){buffer[i * ld + j] = src[j];}
+      }
+      // lower part is transposed from the upper part blockwise
+      const int nb(MATRIX_TRANSPOSE_TILE);
+      for(int i0(0); i0 < n; i0 += nb){
+        const int i1((n - i0 < nb) ? n : (i0 + nb));
+        mat_copy(i1 - i0, i0, buffer + i0, 1, ld, buffer + i0 * ld, ld, 1);
+        for(int i(i0 + 1); i < i1; i++){
+          for(int j(i0); j < i; j++){buffer[i * ld + j] = buffer[j * ld + i];}
         }
       }
       return array;
     }
     
+    typedef typename super_t::symmetric_view_t symmetric_view_t;
+    
     /**
-     * ?2?()
-     * ?2?
+     * Descriptor of the packed buffer
      * 
-     * @return (Array2D<FloatT>) 
+     * @return (bool) always true
      */
-    root_t *copy() const{
-      return dense().shallow_copy();
+    bool symmetric_view(symmetric_view_t &v) const {
+      v.buffer = m_buffer;
+      v.size = rows();
+      return true;
+    }
+    
+    root_t *shallow_copy() const {return new self_t(*this);}
+    
+    /**
+     * Copy-on-write copy, which shares the buffer unless it is aliased by views.
+     * 
+     * @return (root_t *) copy
+     */
+    root_t *share() const {
+      return buffer_manager_t::shareable() ? shallow_copy() : copy();
     }
     
     /**
-     * ??
+     * Detach the buffer if it is shared by copy-on-write.
+     * 
+     * @param for_view mark the buffer as aliased by views
+     */
+    void detach(const bool &for_view = false){
+      buffer_manager_t::unshare(for_view);
+    }
+    
+    /**
+     * Element accessor; (row, column) and (column, row) refer the same element.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (FloatT) element
+     */
+    inline FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column){
+      assert((row < rows()) && (column < columns()));
+      if(buffer_manager_t::shared()){buffer_manager_t::unshare();}
+      return (row <= column)
+          ? m_buffer[mat_packed_offset((int)rows(), (int)row) + column]
+          : m_buffer[mat_packed_offset((int)rows(), (int)column) + row];
+    }
+    
+    /**
+     * Read-only element accessor
      * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
      */
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      assert((row < rows()) && (column < columns()));
+      return (row <= column)
+          ? m_buffer[mat_packed_offset((int)rows(), (int)row) + column]
+          : m_buffer[mat_packed_offset((int)rows(), (int)column) + row];
+    }
+    
     void clear(){
-      for(unsigned int i(0); i < this->rows(); i++){
-        for(unsigned int j(0); j < this->columns(); j++){
-          this->operator()(i, j) = FloatT(0);
-        }
-      } 
+      buffer_manager_t::unshare();
+      const unsigned int size(packed_size(rows()));
+      for(unsigned int i(0); i < size; i++){m_buffer[i] = FloatT(0);}
     }
 };
 
 /**
- * Transposed two-dimension array class.
- * 
- * 2???
+ * Sparse two-dimension array class, which holds only the nonzero elements
+ * compressed by rows (CSR), or by columns (CSC) if column_major is specified
+ * (see Array2D::sparse_view_t).
+ * The values and the index arrays are held in separate buffers;
+ * the values are shared by copy-on-write in the same way as Array2D_Dense,
+ * while the index arrays are shared until the structure is changed.
+ * Reading an element which is not stored gives zero; writing to it
+ * inserts the element, which moves the following elements, 
+ * therefore a matrix should be built from a dense one or by lines in order.
+ * The views to write through share this array via Array2D_Aliased,
+ * so that an element inserted from either side is seen by the others.
  * 
  */
-template<class FloatT>
-class Array2D_Transpose : public Array2D_Delegate<FloatT>{
+template <class FloatT>
+class Array2D_Sparse 
+    : public Array2D<FloatT>, public Array2D_BufferManager<FloatT> {
+  protected:
+    
+    typedef Array2D<FloatT> super_t;
+    typedef Array2D<FloatT> root_t;
+    typedef Array2D_Sparse<FloatT> self_t;
+    typedef Array2D_BufferManager<FloatT> buffer_manager_t;
+    
+    /**
+     * Buffer of the offsets (major + 1) followed by the indices (capacity).
+     */
+    struct index_manager_t : public Array2D_BufferManager<int> {
+      typedef Array2D_BufferManager<int> manager_t;
+      using manager_t::shared;
+      using manager_t::unshare;
+      using manager_t::shareable;
+      index_manager_t(const unsigned int &size) : manager_t(size) {}
+    };
+    
+    index_manager_t m_index;
+    unsigned int m_capacity;
+    bool m_column_major;
+    
+    unsigned int major() const {return m_column_major ? columns() : rows();}
+    
+    /**
+     * Search the element in the line major, which is compressed.
+     * 
+     * @param position index of the element in the values if found,
+     * otherwise the one where it should be inserted
+     * @return (bool) true if found
+     */
+    bool find(
+        const unsigned int &major, const unsigned int &minor, 
+        int &position) const {
+      const int *offsets(m_index.buffer()), *idx(indices());
+      int lo(offsets[major]), hi(offsets[major + 1]);
+      while(lo < hi){
+        int mid((lo + hi) >> 1);
+        if(idx[mid] < (int)minor){lo = mid + 1;}else{hi = mid;}
+      }
+      position = lo;
+      return (lo < offsets[major + 1]) && (idx[lo] == (int)minor);
+    }
+    
+    /**
+     * Insert a zero element at the position, and return it.
+     * The buffers are reallocated if they are full, or the index arrays are shared.
+     */
+    FloatT &insert(
+        const unsigned int &major, const unsigned int &minor, 
+        const int &position){
+      assert(buffer_manager_t::shareable() && m_index.shareable());
+      const unsigned int lines(this->major());
+      int *offsets(m_index.buffer());
+      const int nnz(offsets[lines]);
+      if(m_index.shared() || (nnz >= (int)m_capacity)){
+        unsigned int capacity((nnz >= (int)m_capacity) ? (m_capacity * 2) : m_capacity);
+        if(capacity < 4){capacity = 4;}
+        buffer_manager_t values(capacity);
+        index_manager_t index(lines + 1 + capacity);
+        int *offsets2(index.buffer()), *indices2(offsets2 + lines + 1);
+        const int *indices1(indices());
+        for(unsigned int i(0); i <= lines; i++){
+          offsets2[i] = offsets[i] + ((i > major) ? 1 : 0);
+        }
+        for(int i(0); i < position; i++){
+          indices2[i] = indices1[i];
+          values.buffer()[i] = m_buffer[i];
+        }
+        for(int i(position); i < nnz; i++){
+          indices2[i + 1] = indices1[i];
+          values.buffer()[i + 1] = m_buffer[i];
+        }
+        buffer_manager_t::operator=(values);
+        m_index = index;
+        m_capacity = capacity;
+      }else{
+        int *idx(offsets + lines + 1);
+        for(int i(nnz); i > position; i--){
+          idx[i] = idx[i - 1];
+          m_buffer[i] = m_buffer[i - 1];
+        }
+        for(unsigned int i(major + 1); i <= lines; i++){offsets[i]++;}
+      }
+      indices()[position] = (int)minor;
+      return (m_buffer[position] = FloatT(0));
+    }
   
   public:
+    using buffer_manager_t::m_buffer;
+    using super_t::rows;
+    using super_t::columns;
+    
     /**
-     * Array2D_Transpose(?2?)???N
+     * Constructor of an empty (zero) array.
      * 
-     * @param array 
+     * @param rows number of rows
+     * @param columns number of columns
+     * @param column_major true for compression by columns (CSC)
+     * @param capacity number of elements which can be held without reallocation
      */
-    Array2D_Transpose(const Array2D<FloatT> &array)
-        : Array2D_Delegate<FloatT>(array.columns(), array.rows(), array){}
+    Array2D_Sparse(
+        const unsigned int &rows, const unsigned int &columns,
+        const bool &column_major = false, const unsigned int &capacity = 0) 
+        : super_t(rows, columns), buffer_manager_t(capacity), 
+        m_index((column_major ? columns : rows) + 1 + capacity),
+        m_capacity(capacity), m_column_major(column_major) {
+      for(unsigned int i(0); i <= major(); i++){m_index.buffer()[i] = 0;}
+    }
     
     /**
-     * ??
+     * Copy constructor, which shares the buffers.
      * 
      */
-    Array2D_Transpose(const Array2D_Transpose &array)
-        : Array2D_Delegate<FloatT>(array.rows(), array.columns(), array){}
+    Array2D_Sparse(const self_t &orig) 
+        : super_t(orig.m_rows, orig.m_columns), buffer_manager_t(orig),
+        m_index(orig.m_index), m_capacity(orig.m_capacity), 
+        m_column_major(orig.m_column_major) {}
+    
+    ~Array2D_Sparse(){}
     
     /**
-     * ??
-     * 
-     * @return (Array2D *)
+     * @return (int *) offsets of the lines, which has major + 1 elements
      */
-    Array2D<FloatT> *shallow_copy() const{return new Array2D_Transpose(*this);}
-        
+    int *offsets() const {return m_index.buffer();}
+    
     /**
-     * 
+     * @return (int *) indices of the elements in their lines
+     */
+    int *indices() const {return m_index.buffer() + major() + 1;}
+    
+    /**
+     * @return (unsigned int) number of the elements stored
+     */
+    unsigned int nonzeros() const {return (unsigned int)offsets()[major()];}
+    
+    /**
+     * Deep copy, whose capacity fits to the elements
      * 
-     * @param row ?(?0)
-     * @param column ?(?0)
-     * @return (FloatT) 
+     * @return (root_t *) copy
      */
-    inline FloatT &operator()(
-        const unsigned int &row, 
-        const unsigned int &column){
-      return Array2D_Delegate<FloatT>::operator()(column, row);
+    root_t *copy() const {
+      const unsigned int nnz(nonzeros());
+      self_t *array(new self_t(rows(), columns(), m_column_major, nnz));
+      memcpy(array->offsets(), offsets(), sizeof(int) * (major() + 1 + nnz));
+      memcpy(array->indices(), indices(), sizeof(int) * nnz);
+      memcpy(array->buffer(), m_buffer, sizeof(FloatT) * nnz);
+      return array;
     }
     
     /**
-     * ?
+     * Dense copy, in which the elements not stored are zero
      *
      * @return (Array2D_Dense<FloatT>)
      */
     Array2D_Dense<FloatT> dense() const {
-      return Array2D_Delegate<FloatT>::dense();
+      Array2D_Dense<FloatT> array(rows(), columns());
+      array.clear();
+      FloatT *buffer(array.buffer());
+      const int ld((int)array.ld()), 
+          major_s(m_column_major ? 1 : ld), minor_s(m_column_major ? ld : 1);
+      const int *offsets(this->offsets()), *idx(indices());
+      for(unsigned int i(0); i < major(); i++){
+        for(int k(offsets[i]); k < offsets[i + 1]; k++){
+          buffer[(int)i * major_s + idx[k] * minor_s] = m_buffer[k];
+        }
+      }
+      return array;
+    }
+    
+    typedef typename super_t::sparse_view_t sparse_view_t;
+    
+    /**
+     * Descriptor of the compressed arrays
+     * 
+     * @return (bool) always true
+     */
+    bool sparse_view(sparse_view_t &v) const {
+      v.values = m_buffer;
+      v.offsets = offsets();
+      v.indices = indices();
+      v.rows = rows();
+      v.columns = columns();
+      v.column_major = m_column_major;
+      return true;
+    }
+    
+    root_t *shallow_copy() const {return new self_t(*this);}
+    
+    bool restructurable() const {return true;}
+    
+    /**
+     * Copy-on-write copy, which shares the buffers unless they are aliased by views.
+     * 
+     * @return (root_t *) copy
+     */
+    root_t *share() const {
+      return (buffer_manager_t::shareable() && m_index.shareable()) 
+          ? shallow_copy() : copy();
+    }
+    
+    /**
+     * Detach the values if they are shared by copy-on-write.
+     * The index arrays are also detached for views, 
+     * because their structure is not changed while the views exist.
+     * 
+     * @param for_view mark the buffers as aliased by views
+     */
+    void detach(const bool &for_view = false){
+      buffer_manager_t::unshare(for_view);
+      if(for_view){m_index.unshare(true);}
+    }
+    
+    /**
+     * Element accessor, which inserts the element if it is not stored.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (FloatT) element
+     */
+    FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column){
+      assert((row < rows()) && (column < columns()));
+      if(buffer_manager_t::shared()){buffer_manager_t::unshare();}
+      const unsigned int i(m_column_major ? column : row), j(m_column_major ? row : column);
+      int position;
+      if(find(i, j, position)){return m_buffer[position];}
+      return insert(i, j, position);
+    }
+    
+    /**
+     * Read-only element accessor, which gives zero for the elements not stored.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      assert((row < rows()) && (column < columns()));
+      static const FloatT zero(0);
+      int position;
+      return find(
+            (m_column_major ? column : row), (m_column_major ? row : column), position)
+          ? m_buffer[position] : zero;
+    }
+    
+    /**
+     * Remove all the elements, which keeps the capacity.
+     */
+    void clear(){
+      buffer_manager_t::unshare();
+      if(m_index.shared()){m_index = index_manager_t(major() + 1 + m_capacity);}
+      for(unsigned int i(0); i <= major(); i++){m_index.buffer()[i] = 0;}
     }
 };
 
-
 /**
- * Partial two-dimension array class.
- * 
- * ?2???
+ * Banded two-dimension array class, which holds the elements in the band
+ * -lower <= column - row <= upper, and the others are structural zeros.
+ * Row i is stored in lower + upper + 1 consecutive elements from column i - lower,
+ * therefore the band is accessed with constant strides (see Array2D::band_view_t).
+ * Reading a structural zero gives zero, while writing to it is not allowed
+ * (Matrix::operator() replaces the storage with dense one in that case,
+ * and Array2D_Aliased does the same for the views to write through).
+ * It is shared by copy-on-write in the same way as Array2D_Dense.
  * 
  */
-template<class FloatT>
-class Array2D_Partial : public Array2D_Delegate<FloatT>{
+template <class FloatT>
+class Array2D_Banded 
+    : public Array2D<FloatT>, public Array2D_BufferManager<FloatT> {
+  protected:
+    
+    typedef Array2D<FloatT> super_t;
+    typedef Array2D<FloatT> root_t;
+    typedef Array2D_Banded<FloatT> self_t;
+    typedef Array2D_BufferManager<FloatT> buffer_manager_t;
+    
+    int m_lower, m_upper;
+    FloatT m_zero;
+    
+    int width() const {return m_lower + m_upper + 1;}
+    
+    static int clamp(const int &bandwidth, const unsigned int &size){
+      return (bandwidth < (int)size) ? bandwidth : ((size > 0) ? ((int)size - 1) : 0);
+    }
   
   public:
+    using buffer_manager_t::m_buffer;
+    using super_t::rows;
+    using super_t::columns;
+    
     /**
-     * ?
-     *
-     * @return (Array2D_Dense<FloatT>)
+     * Constructor, whose elements are zero.
+     * 
+     * @param rows number of rows
+     * @param columns number of columns
+     * @param lower number of the subdiagonals
+     * @param upper number of the superdiagonals
      */
-    Array2D_Dense<FloatT> dense() const {
-      return Array2D_Delegate<FloatT>::dense();
+    Array2D_Banded(
+        const unsigned int &rows, const unsigned int &columns,
+        const int &lower, const int &upper) 
+        : super_t(rows, columns), 
+        buffer_manager_t(rows * (clamp(lower, rows) + clamp(upper, columns) + 1)),
+        m_lower(clamp(lower, rows)), m_upper(clamp(upper, columns)), m_zero(0) {
+      super_t::m_structured = true;
+      clear();
     }
     
     /**
-     * ?2?()
-     * ?2?
+     * Copy constructor, which shares the buffer.
      * 
-     * @return (Array2D<FloatT>) 
      */
-    Array2D<FloatT> *copy() const{
-      return Array2D_Delegate<FloatT>::copy();
-    } 
-  
-  private:
-    unsigned int m_RowOffset;
-    unsigned int m_ColumnOffset;
+    Array2D_Banded(const self_t &orig) 
+        : super_t(orig.m_rows, orig.m_columns), buffer_manager_t(orig),
+        m_lower(orig.m_lower), m_upper(orig.m_upper), m_zero(0) {
+      super_t::m_structured = true;
+    }
+    
+    ~Array2D_Banded(){}
     
-  protected:
     /**
-     * 
+     * Deep copy
      * 
-     * @return (int) ?
+     * @return (root_t *) copy
      */
-    unsigned int row_offset() const{return m_RowOffset;}
+    root_t *copy() const {
+      self_t *array(static_cast<self_t *>(shallow_copy())); // of the derived type
+      const unsigned int size(rows() * width());
+      static_cast<buffer_manager_t &>(*array) = buffer_manager_t(size);
+      memcpy(array->buffer(), m_buffer, sizeof(FloatT) * size);
+      return array;
+    }
+    
     /**
-     * 
-     * 
-     * @return (int) ?
+     * Dense copy, in which the structural zeros are zero
+     *
+     * @return (Array2D_Dense<FloatT>)
      */
-    unsigned int column_offset() const{return m_ColumnOffset;}
-  
-  public:
+    Array2D_Dense<FloatT> dense() const {
+      Array2D_Dense<FloatT> array(rows(), columns());
+      array.clear();
+      typename super_t::band_view_t v;
+      band_view(v);
+      FloatT *buffer(array.buffer());
+      const int ld((int)array.ld());
+      for(int i(0); i < (int)rows(); i++){
+        int j0(i - m_lower), j1(i + m_upper + 1);
+        if(j0 < 0){j0 = 0;}
+        if(j1 > (int)columns()){j1 = (int)columns();}
+        for(int j(j0); j < j1; j++){
+          buffer[i * ld + j] = v.buffer[i * v.row_stride + j];
+        }
+      }
+      return array;
+    }
+    
+    typedef typename super_t::band_view_t band_view_t;
+    
     /**
-     * Array2D_Partial(?2?)???
+     * Descriptor of the band
      * 
-     * @param array 
-     * @param offsetRow ?2?(0,0)2??
-     * @param offsetColumn ?
-     * @param rows ?
-     * @param columns ?
+     * @return (bool) always true
      */
-    Array2D_Partial(const unsigned int &rows,
-        const unsigned int &columns,
-        const Array2D<FloatT> &array,
-        const unsigned int &rowOffset,
-        const unsigned int &columnOffset)
-        : Array2D_Delegate<FloatT>(rows, columns, array),
-        m_RowOffset(rowOffset), m_ColumnOffset(columnOffset){}
+    bool band_view(band_view_t &v) const {
+      v.buffer = m_buffer + m_lower;
+      v.row_stride = width() - 1;
+      v.column_stride = 1;
+      v.rows = rows();
+      v.columns = columns();
+      v.lower = m_lower;
+      v.upper = m_upper;
+      return true;
+    }
+    
+    bool holds(const unsigned int &row, const unsigned int &column) const {
+      const int d((int)column - (int)row);
+      return (d >= -m_lower) && (d <= m_upper);
+    }
+    
+    root_t *shallow_copy() const {return new self_t(*this);}
+    
+    bool restructurable() const {return true;}
     
     /**
-     * ??
+     * Copy-on-write copy, which shares the buffer unless it is aliased by views.
      * 
+     * @return (root_t *) copy
      */
-    Array2D_Partial(const Array2D_Partial &array)
-        : Array2D_Delegate<FloatT>(array),
-        m_RowOffset(array.row_offset()), m_ColumnOffset(array.column_offset()){}
+    root_t *share() const {
+      return buffer_manager_t::shareable() ? shallow_copy() : copy();
+    }
     
     /**
-     * ??
+     * Detach the buffer if it is shared by copy-on-write.
      * 
-     * @return (Array2D *)
+     * @param for_view mark the buffer as aliased by views
      */
-    Array2D<FloatT> *shallow_copy() const{return new Array2D_Partial(*this);}
-        
+    void detach(const bool &for_view = false){
+      buffer_manager_t::unshare(for_view);
+    }
+    
     /**
-     * 
+     * Element accessor. A structural zero must not be written;
+     * the returned reference to it is a placeholder which is reset to zero.
+     * Matrix::operator() and Array2D_Aliased avoid this
+     * by switching to dense storage beforehand.
      * 
-     * @param row ?(?0)
-     * @param column ?(?0)
-     * @return (FloatT) 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (FloatT) element
      */
     inline FloatT &operator()(
         const unsigned int &row, 
         const unsigned int &column){
-      return Array2D_Delegate<FloatT>::operator()(
-          row + row_offset(), column + column_offset());
+      assert((row < rows()) && (column < columns()));
+      if(!holds(row, column)){return (m_zero = FloatT(0));}
+      if(buffer_manager_t::shared()){buffer_manager_t::unshare();}
+      return m_buffer[(int)row * (width() - 1) + (int)column + m_lower];
+    }
+    
+    /**
+     * Read-only element accessor, which gives zero for the structural zeros.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      assert((row < rows()) && (column < columns()));
+      static const FloatT zero(0);
+      if(!holds(row, column)){return zero;}
+      return m_buffer[(int)row * (width() - 1) + (int)column + m_lower];
+    }
+    
+    void clear(){
+      buffer_manager_t::unshare();
+      const unsigned int size(rows() * width());
+      for(unsigned int i(0); i < size; i++){m_buffer[i] = FloatT(0);}
     }
 };
 
-template <class FloatT>
-class Matrix;
-
 /**
- * @brief 
- *
- * (?)?
- * ???(????)?
- * ?
- * ????
+ * Diagonal two-dimension array class, which is banded one without
+ * subdiagonals and superdiagonals, i.e., only n elements are held.
+ * 
  */
-template <class T>
-class DelegatedMatrix : public Matrix<T>{
+template <class FloatT>
+class Array2D_Diagonal : public Array2D_Banded<FloatT> {
   protected:
-    typedef Matrix<T> super_t;
-    typedef DelegatedMatrix<T> self_t;
-
-    super_t &substitute(const super_t &matrix){
-      if((this != &matrix) && (super_t::m_Storage)){
-#define __MIN_MACRO(x, y) ((x) < (y) ? (x) : (y))
-        for(unsigned int i(0); i < __MIN_MACRO(super_t::rows(), matrix.rows()); i++){
-          for(unsigned int j(0); j < __MIN_MACRO(super_t::columns(), matrix.columns()); j++){
-            (*this)(i, j) = (const_cast<super_t &>(matrix))(i, j);
-          }
-        }
-#undef __MIN_MACRO
-      }
-      return *this;
-    }
-
-    DelegatedMatrix(const typename super_t::storage_t *storage)
-        : super_t(storage){}
-    virtual ~DelegatedMatrix(){}
-
+    typedef Array2D_Banded<FloatT> super_t;
+    typedef Array2D_Diagonal<FloatT> self_t;
+  
+  public:
     /**
-     * ?
-     * ?Storage?
-     *
-     * @param matrix 
+     * Constructor, whose elements are zero.
+     * 
+     * @param size number of rows (and columns)
      */
-    self_t &operator=(const super_t &matrix){
-      return static_cast<self_t &>(self_t::substitute(matrix));
-    }
-
-    self_t &operator=(const self_t &matrix){
-      return static_cast<self_t &>(self_t::substitute(matrix));
-    }
+    Array2D_Diagonal(const unsigned int &size) : super_t(size, size, 0, 0) {}
+    
+    Array2D_Diagonal(const self_t &orig) : super_t(orig) {}
+    
+    Array2D<FloatT> *shallow_copy() const {return new self_t(*this);}
+};
 
+/**
+ * Triangular two-dimension array class, which is banded one whose band
+ * covers the lower (or upper) triangle.
+ * 
+ */
+template <class FloatT>
+class Array2D_Triangular : public Array2D_Banded<FloatT> {
+  protected:
+    typedef Array2D_Banded<FloatT> super_t;
+    typedef Array2D_Triangular<FloatT> self_t;
+  
   public:
-    Matrix<T> original() const{
-      return super_t::make_instance(
-          static_cast<Array2D_Delegate<T> *>(Matrix<T>::m_Storage)
-            ->getParent()->shallow_copy());
-    }
+    /**
+     * Constructor, whose elements are zero.
+     * 
+     * @param size number of rows (and columns)
+     * @param lower true for lower triangular, otherwise upper
+     */
+    Array2D_Triangular(const unsigned int &size, const bool &lower) 
+        : super_t(size, size, (lower ? (int)size : 0), (lower ? 0 : (int)size)) {}
+    
+    Array2D_Triangular(const self_t &orig) : super_t(orig) {}
+    
+    Array2D<FloatT> *shallow_copy() const {return new self_t(*this);}
 };
 
 /**
- * @brief 
- *
- * ??
- * ??
- * 2?Array2D_Transpose
+ * Two-dimension array class shared by a matrix and its views to write through,
+ * which forwards to the actual storage held in a common slot.
+ * The actual storage can change its structure, such as insertion to sparse storage,
+ * or be replaced, such as banded storage with dense one when a structural zero
+ * is written, and the change is seen by the matrix and all the views.
+ * Storage which is restructurable() is wrapped with this
+ * when such a view is created (see Matrix::alias()).
  *
- * @see Array2D_Transpose 2?
  */
-template <class T>
-class TransposedMatrix : public DelegatedMatrix<T>{
+template <class FloatT>
+class Array2D_Aliased : public Array2D<FloatT> {
   protected:
-    typedef Matrix<T> root_t;
-    typedef DelegatedMatrix<T> super_t;
-    typedef TransposedMatrix<T> self_t;
+    typedef Array2D<FloatT> super_t;
+    typedef Array2D<FloatT> root_t;
+    typedef Array2D_Dense<FloatT> dense_t;
+    typedef Array2D_Aliased<FloatT> self_t;
+    
+    struct slot_t {
+      root_t *target;
+      int ref;
+    };
+    
+    slot_t *m_slot;
 
   public:
-    using root_t::rows;
-    using root_t::columns;
+    using super_t::rows;
+    using super_t::columns;
     
     /**
-     * TransposedMatrix()???
+     * Constructor, which takes the ownership of the actual storage.
      *
-     * @param matrix 
-     */
-    TransposedMatrix(const root_t &matrix)
-        : super_t(new Array2D_Transpose<T>(*(matrix.storage()))){}
-
-    /**
-     * ?
+     * @param target actual storage, which is detached if shared by copy-on-write
      */
-    ~TransposedMatrix(){}
-
+    Array2D_Aliased(root_t *target)
+        : super_t(target->rows(), target->columns()), m_slot(new slot_t) {
+      target->detach();
+      m_slot->target = target;
+      m_slot->ref = 1;
+    }
+    
     /**
-     * 
-     * ??
-     * transpose().copy()
+     * Copy constructor, which shares the slot.
      *
-     * @return (root_t) 
      */
-    inline root_t untranspose() const{
-      return super_t::original();
+    Array2D_Aliased(const self_t &orig)
+        : super_t(orig.m_rows, orig.m_columns), m_slot(orig.m_slot) {
+      ++(m_slot->ref);
     }
-
-    self_t &operator=(const root_t &matrix){
-      return static_cast<self_t &>(super_t::substitute(matrix));
+    
+    ~Array2D_Aliased(){
+      if(--(m_slot->ref) > 0){return;}
+      delete m_slot->target;
+      delete m_slot;
     }
     
+    root_t *shallow_copy() const {return new self_t(*this);}
+    
     /**
-     * ( * )
+     * Copy for a new matrix, which is made of the actual storage;
+     * it is a deep copy while the slot is shared by views.
      *
-     * @param matrix 
-     * @return (root_t) ?
+     * @return (root_t *) copy
      */
-    root_t operator*(const root_t &matrix) const{
-      return super_t::operator*(matrix);
+    root_t *share() const {
+      return (m_slot->ref > 1) ? m_slot->target->copy() : m_slot->target->share();
     }
     
     /**
-     * ( * )
-     *
-     * @param matrix 
-     * @return (root_t) ?
-     * @throw MatrixException ?(??????)
+     * Detach the actual storage if it is shared by copy-on-write.
+     * It is never marked as aliased, because the views share the slot instead.
      */
-    root_t operator*(const self_t &matrix) const{
-      return operator*((const root_t &)matrix);
+    void detach(const bool & = false){m_slot->target->detach();}
+    
+    root_t *copy() const {return m_slot->target->copy();}
+    
+    dense_t dense() const {return m_slot->target->dense();}
+    
+    void clear(){m_slot->target->clear();}
+    
+    bool view(typename super_t::view_t &v) const {
+      return m_slot->target->view(v);
     }
-};
-
-/**
- * @brief ?
- *
- * ???
- * ??
- * ?2?Array2D_Partial?
- *
- * @see Array2D_Partial ?2?
- */
-template <class T>
-class PartialMatrix : public DelegatedMatrix<T>{
-  protected:
-    typedef Matrix<T> root_t;
-    typedef DelegatedMatrix<T> super_t;
-    typedef PartialMatrix<T> self_t;
-
-  public:
+    bool symmetric_view(typename super_t::symmetric_view_t &v) const {
+      return m_slot->target->symmetric_view(v);
+    }
+    bool sparse_view(typename super_t::sparse_view_t &v) const {
+      return m_slot->target->sparse_view(v);
+    }
+    bool band_view(typename super_t::band_view_t &v) const {
+      return m_slot->target->band_view(v);
+    }
+    
     /**
-     * PartialMatrix(?)???
+     * Element accessor, which replaces the actual storage with dense one
+     * before a structural zero is written.
      *
-     * @param matrix 
-     * @param rows ?
-     * @param columns ?
-     * @param rowOffset ?(0,0)?
-     * @param columnOffset ?
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (FloatT) element
      */
-    PartialMatrix(
-        const root_t &matrix,
-        const unsigned int &rows,
-        const unsigned int &columns,
-        const unsigned int &rowOffset,
-        const unsigned int &columnOffset)
-            : super_t(new Array2D_Partial<T>(
-                rows, columns,
-                *(matrix.storage()),
-                rowOffset, columnOffset)){}
-
+    FloatT &operator()(
+        const unsigned int &row,
+        const unsigned int &column){
+      root_t *&target(m_slot->target);
+      if(target->structured() && !target->holds(row, column)){
+        root_t *dense(new dense_t(target->dense()));
+        delete target;
+        target = dense;
+      }
+      return target->operator()(row, column);
+    }
+    
     /**
-     * ?
+     * Read-only element accessor
+     *
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
      */
-    ~PartialMatrix(){}
-
-    self_t &operator=(const root_t &matrix){
-      return static_cast<self_t &>(super_t::substitute(matrix));
+    const FloatT &operator()(
+        const unsigned int &row,
+        const unsigned int &column) const {
+      return static_cast<const root_t *>(m_slot->target)->operator()(row, column);
     }
 };
 
 /**
- * Matrix class.
+ * Delegated two-dimension array abstract class.
  * 
- * ?
+ * 2?2??
  * 
  */
-template <class FloatT = double>
-class Matrix{
-  public:
-    typedef Matrix<FloatT> self_t;
-    typedef Array2D<FloatT> storage_t;
-      
-  protected:
-    storage_t *m_Storage;
-    
-    /**
-     * Matrix???
-     * ?
-     * 
-     * @param array ?
-     */
-    Matrix(const storage_t *storage) : m_Storage(const_cast<storage_t *>(storage)){}
+template<class FloatT>
+class Array2D_Delegate : public Array2D<FloatT>{
+  private:
+    typedef Array2D<FloatT> super_t;
+    typedef Array2D<FloatT> root_t;
+    typedef Array2D_Dense<FloatT> dense_t;
+    typedef Array2D_Delegate<FloatT> self_t;
     
-    static self_t make_instance(const storage_t *storage){
-      return self_t(storage);
-    }
+    root_t *m_target;
     
+  protected:
     /**
-     * Matrix???
-     * ??
-     * ?
-     *
-     * @param rows ?
-     * @param columns ?
+     * 
+     * 
      */
-    static self_t naked(
-        const unsigned int &rows,
-        const unsigned int &columns){
-      return Matrix(new Array2D_Dense<FloatT>(rows, columns));
-    }
+    root_t &getTarget() const{return *m_target;}
   
   public:
+    using super_t::rows;
+    using super_t::columns;
+    
     /**
-     * ?
-     * 
-     * @return (const storage_t *) ?
-     */
-    const storage_t *storage() const{return m_Storage;}
-
-    /**
-     * Matrix???
+     * 
      * 
+     * @return (root_t) 
      */
-    Matrix() : m_Storage(NULL){}
+    const root_t *getParent() const{return m_target;}
     
     /**
-     * Matrix???
-     * ??
-     * FloatT(0)?
+     * Array2D_Delegate(2?)???
      * 
-     *     
      * @param rows ?
      * @param columns ?
+     * @param array 
      */
-    Matrix(const unsigned int &rows, const unsigned int &columns)
-        : m_Storage(new Array2D_Dense<FloatT>(rows, columns)){m_Storage->clear();}
+    Array2D_Delegate(const unsigned int &rows,
+        const unsigned int &columns,
+        const root_t &array)
+        : super_t(rows, columns), m_target(array.shallow_copy()){}
     
     /**
-     * Matrix???
-     * ??
-     * seialized?
-     *
-     * @param rows ?
-     * @param columns ?
-     * @param serialized 
+     * ??
+     * 
      */
-    Matrix(
-        const unsigned int &rows, const unsigned int &columns,
-        const FloatT *serialized)
-        : m_Storage(new Array2D_Dense<FloatT>(rows, columns, serialized)){}
-    
+    Array2D_Delegate(const Array2D_Delegate &array)
+        : super_t(array.rows(), array.columns()), 
+        m_target(array.m_target->shallow_copy()){}
+        
     /**
-     * ??
-     * ??
+     * ?
+     */
+    ~Array2D_Delegate(){delete m_target;}
+        
+    /**
+     * 
      * 
-     * @param matrix 
+     * @param row ?(?0)
+     * @param column ?(?0)
+     * @return (FloatT) 
      */
-    Matrix(const Matrix &matrix) : m_Storage(matrix.m_Storage->shallow_copy()){}
+    inline FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column){
+      if(m_target->structured() && !m_target->holds(row, column)){
+        // the target is a snapshot of a const matrix, which is made dense by itself
+        m_target = new Array2D_Aliased<FloatT>(m_target);
+      }
+      return m_target->operator()(row, column);
+    }
+    
     /**
-     * ?
+     * Read-only element accessor
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
      */
-    virtual ~Matrix(){delete m_Storage;}
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      return static_cast<const root_t *>(m_target)->operator()(row, column);
+    }
     
-  protected:
     /**
-     * ??
-     * ???
+     * Detach the buffer of the target.
+     * The buffer of a view created from a non-const matrix is aliased,
+     * and is kept, so that writing to the view changes the original matrix.
+     * A restructurable target is shared with the views instead.
      *
-     * @return (self_t) 
+     * @param for_view mark the buffer as aliased by views
      */
-    virtual self_t &substitute(const self_t &matrix){
-      if(this != &matrix){
-        delete m_Storage;
-        if(matrix.m_Storage){
-          m_Storage = matrix.m_Storage->shallow_copy();
-        }
+    void detach(const bool &for_view = false){
+      if(for_view && m_target->restructurable()){
+        m_target = new Array2D_Aliased<FloatT>(m_target);
       }
-      return *this;
+      m_target->detach(for_view);
     }
-
-  public:
+    
     /**
-     * ?
+     * ?
      *
-     * @return (self_t) 
+     * @return (dense_t)
      */
-    self_t &operator=(const self_t &matrix){
-      return substitute(matrix);
+    dense_t dense() const {
+      dense_t array(rows(), columns());
+      typename super_t::view_t v;
+      if(this->view(v)){
+        mat_copy((int)rows(), (int)columns(), 
+            (const FloatT *)v.buffer, v.row_stride, v.column_stride,
+            array.buffer(), (int)array.ld(), 1);
+        return array;
+      }
+      for(unsigned int i(0); i < array.rows(); i++){
+        for(unsigned int j(0); j < array.columns(); j++){
+          array(i, j) = this->operator()(i, j);
+        }
+      }
+      return array;
     }
     
     /**
-     * ()
+     * ?2?()
+     * ?2?
      * 
-     * @return (self_t) 
+     * @return (Array2D<FloatT>) 
      */
-    self_t copy() const{
-      return self_t(m_Storage->copy());
+    root_t *copy() const{
+      return dense().shallow_copy();
     }
     
     /**
-     * ?
+     * ??
      * 
-     * @return (int) ?
      */
-    unsigned int rows() const{return m_Storage->rows();}
+    void clear(){
+      typename super_t::view_t v;
+      if(this->view(v)){
+        mat_scale((int)rows(), (int)columns(), FloatT(0), 
+            v.buffer, v.row_stride, v.column_stride);
+        return;
+      }
+      for(unsigned int i(0); i < this->rows(); i++){
+        for(unsigned int j(0); j < this->columns(); j++){
+          this->operator()(i, j) = FloatT(0);
+        }
+      } 
+    }
+};
+
+/**
+ * Transposed two-dimension array class.
+ * 
+ * 2???
+ * 
+ */
+template<class FloatT>
+class Array2D_Transpose : public Array2D_Delegate<FloatT>{
+  
+  public:
     /**
-     * ?
+     * Array2D_Transpose(?2?)???N
      * 
-     * @return (int) ?
+     * @param array 
      */
-    unsigned int columns() const{return m_Storage->columns();}
+    Array2D_Transpose(const Array2D<FloatT> &array)
+        : Array2D_Delegate<FloatT>(array.columns(), array.rows(), array){}
     
     /**
-     * 
+     * ??
      * 
-     * @param row ?(?0)
-     * @param column ?(?0)
-     * @return (FloatT) 
      */
-    inline FloatT &operator()(const unsigned int &row, const unsigned int &column){
-      return m_Storage->operator()(row, column);
-    }
+    Array2D_Transpose(const Array2D_Transpose &array)
+        : Array2D_Delegate<FloatT>(array){}
+    
     /**
-     * (Matlab?)
+     * ??
      * 
-     * @param row ?(?1)
-     * @param column ?(?1)
+     * @return (Array2D *)
+     */
+    Array2D<FloatT> *shallow_copy() const{return new Array2D_Transpose(*this);}
+        
+    /**
+     * 
+     * 
+     * @param row ?(?0)
+     * @param column ?(?0)
      * @return (FloatT) 
      */
-    FloatT &matlab(const int &row, const int &column){
-      return (*this)(row - 1, column - 1);
+    inline FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column){
+      return Array2D_Delegate<FloatT>::operator()(column, row);
     }
     
     /**
-     * ??
+     * Read-only element accessor
      * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
      */
-    self_t clear(){
-      m_Storage->clear();
-      return *this;
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      return Array2D_Delegate<FloatT>::operator()(column, row);
     }
     
     /**
-     * ?
+     * ?
      *
-     * @param size ?(?)
-     * @param scalar 
+     * @return (Array2D_Dense<FloatT>)
      */
-    static self_t getScalar(const unsigned int &size, const FloatT &scalar){
-      self_t result(size, size);
-      for(unsigned int i = 0; i < size; i++){result(i, i) = scalar;}
-      return result;
+    Array2D_Dense<FloatT> dense() const {
+      return Array2D_Delegate<FloatT>::dense();
     }
     
     /**
-     * 
+     * Memory layout descriptor, which is the one of the target
+     * with the row and column strides exchanged.
      * 
-     * @parma size ?(?)
+     * @return (bool) true if the target has the descriptor
      */
-    static self_t getI(const int &size){
-      return getScalar(size, FloatT(1));
+    bool view(typename Array2D<FloatT>::view_t &v) const {
+      if(!Array2D_Delegate<FloatT>::getTarget().view(v)){return false;}
+      int temp(v.row_stride);
+      v.row_stride = v.column_stride;
+      v.column_stride = temp;
+      v.rows = this->rows();
+      v.columns = this->columns();
+      return true;
     }
     
-    typedef TransposedMatrix<FloatT> transposed_t;
-    
     /**
-     * 
-     * ??
-     * transpose().copy()
+     * Descriptor of symmetric packed storage, which is the one of the target
+     * because a symmetric matrix is the same as its transpose.
      * 
-     * @return (transposed_t) 
+     * @return (bool) true if the target is symmetric packed storage
      */
-    transposed_t transpose() const{
-      return transposed_t(*this);
+    bool symmetric_view(typename Array2D<FloatT>::symmetric_view_t &v) const {
+      return Array2D_Delegate<FloatT>::getTarget().symmetric_view(v);
     }
     
-    typedef PartialMatrix<FloatT> partial_t;
-    
     /**
-     * ?
-     *
-     * @param rowSize 
-     * @param columnSize 
-     * @param rowOffset ?
-     * @param columnOffset ?
-     * @return (PartialMatrix<T>) ?
+     * Descriptor of sparse storage, which is the one of the target 
+     * with the compression exchanged, i.e., the transpose of CSR is CSC.
+     * 
+     * @return (bool) true if the target is sparse storage
      */
-    partial_t partial(
-        const unsigned int &rowSize,
-        const unsigned int &columnSize,
-        const unsigned int &rowOffset,
-        const unsigned int &columnOffset) const {
-      assert((rowSize + rowOffset > rows()) 
-          || (columnSize + columnOffset > columns()));
-      return partial_t(*this, rowSize, columnSize, rowOffset, columnOffset);
+    bool sparse_view(typename Array2D<FloatT>::sparse_view_t &v) const {
+      if(!Array2D_Delegate<FloatT>::getTarget().sparse_view(v)){return false;}
+      v.column_major = !v.column_major;
+      v.rows = this->rows();
+      v.columns = this->columns();
+      return true;
     }
     
     /**
-     * ?
+     * Descriptor of banded storage, which is the one of the target
+     * with the strides and the bandwidths exchanged.
      * 
-     * @param row ?
-     * @return (self_t) ?
+     * @return (bool) true if the target is banded storage
      */
-    partial_t rowVector(const unsigned int &row) const{
-      assert(row < rows());
-      return partial_t(*this, 1, columns(), row, 0);
+    bool band_view(typename Array2D<FloatT>::band_view_t &v) const {
+      if(!Array2D_Delegate<FloatT>::getTarget().band_view(v)){return false;}
+      v = v.transpose();
+      return true;
     }
+};
+
+
+/**
+ * Partial two-dimension array class.
+ * 
+ * ?2???
+ * 
+ */
+template<class FloatT>
+class Array2D_Partial : public Array2D_Delegate<FloatT>{
+  
+  public:
     /**
-     * ?
-     * 
-     * @param column ?
-     * @return (partial_t) ?
+     * ?
+     *
+     * @return (Array2D_Dense<FloatT>)
      */
-    partial_t columnVector(const unsigned int &column) const{
-      assert(column < columns());
-      return partial_t(*this, rows(), 1, 0, column);
+    Array2D_Dense<FloatT> dense() const {
+      return Array2D_Delegate<FloatT>::dense();
     }
     
     /**
-     * ?
+     * ?2?()
+     * ?2?
      * 
-     * @param row1 ?1
-     * @param row2 ?2
-     * @return (self_t) 
+     * @return (Array2D<FloatT>) 
      */
-    self_t &exchangeRows(const unsigned int &row1, const unsigned int &row2){
-      assert(row1 < rows() && row2 < rows());
-      FloatT temp;
-      for(unsigned int j = 0; j < columns(); j++){
-        temp = (*this)(row1, j);
-        (*this)(row1, j) = (*this)(row2, j);
-        (*this)(row2, j) = temp;
-      }
-      return *this;
-    }
+    Array2D<FloatT> *copy() const{
+      return Array2D_Delegate<FloatT>::copy();
+    } 
+  
+  private:
+    unsigned int m_RowOffset;
+    unsigned int m_ColumnOffset;
+    
+  protected:
     /**
-     * ?
+     * 
      * 
-     * @param column1 ?1
-     * @param column2 ?2
-     * @return (self_t) 
+     * @return (int) ?
      */
-    self_t &exchangeColumns(const unsigned int &column1, const unsigned int &column2){
-      assert(column1 < columns() && column2 < columns());
-      FloatT temp;
-      for(unsigned int i = 0; i < rows(); i++){
-        temp = (*this)(i, column1);
-        (*this)(i, column1) = (*this)(i, column2);
-        (*this)(i, column2) = temp;
-      }
-      return *this;
-    }
-    
+    unsigned int row_offset() const{return m_RowOffset;}
     /**
-     * 
+     * 
      * 
-     * @return (bool) ??true?false
+     * @return (int) ?
      */
-    bool isSquare() const{return rows() == columns();}
-    
-    /**
-     * 
-     *
-     * @return (bool) ??true?false
-     */
-    bool isDiagonal() const{
-      if(isSquare()){
-        for(unsigned int i = 0; i < rows(); i++){
-          for(unsigned int j = i + 1; j < columns(); j++){
-            if((const_cast<Matrix &>(*this)(i, j) != FloatT(0))
-                || (const_cast<Matrix &>(*this)(j, i) != FloatT(0))){
-              return false;
-            }
-          }
-        }
-        return true;
-      }else{return false;}
-    }
-    
+    unsigned int column_offset() const{return m_ColumnOffset;}
+  
+  public:
     /**
-     * 
+     * Array2D_Partial(?2?)???
      * 
-     * @return (bool) ??true?false
+     * @param array 
+     * @param offsetRow ?2?(0,0)2??
+     * @param offsetColumn ?
+     * @param rows ?
+     * @param columns ?
      */
-    bool isSymmetric() const{
-      if(isSquare()){
-        for(unsigned int i = 0; i < rows(); i++){
-          for(unsigned int j = i + 1; j < columns(); j++){
-            if(const_cast<Matrix &>(*this)(i, j) != const_cast<Matrix &>(*this)(j, i)){
-              return false;
-            }
-          } 
-        }
-        return true;
-      }else{return false;}
-    }
+    Array2D_Partial(const unsigned int &rows,
+        const unsigned int &columns,
+        const Array2D<FloatT> &array,
+        const unsigned int &rowOffset,
+        const unsigned int &columnOffset)
+        : Array2D_Delegate<FloatT>(rows, columns, array),
+        m_RowOffset(rowOffset), m_ColumnOffset(columnOffset){}
     
     /**
-     * 
-     *
-     * @param matrix 
-     * @return (bool) ?true
+     * ??
+     * 
      */
-    bool isDifferentSize(const self_t &matrix) const{
-      return (rows() != matrix.rows()) || (columns() != matrix.columns());
-    }
+    Array2D_Partial(const Array2D_Partial &array)
+        : Array2D_Delegate<FloatT>(array),
+        m_RowOffset(array.row_offset()), m_ColumnOffset(array.column_offset()){}
     
     /**
-     * ?
-     *
-     * @param do_check ?true
-     * @return (T) ?
+     * ??
+     * 
+     * @return (Array2D *)
      */
-    FloatT trace(bool do_check = true) const {
-      assert(do_check && !isSquare());
-      FloatT tr(0);
-      for(unsigned i(0); i < rows(); i++){
-        tr += (*const_cast<self_t *>(this))(i, i);
-      }
-      return tr;
-    }
+    Array2D<FloatT> *shallow_copy() const{return new Array2D_Partial(*this);}
     
     /**
-     * ?
+     * Memory layout descriptor, which is the one of the target
+     * with its origin moved by the offsets.
      * 
-     * @param scalar ?
-     * @return (self_t) 
+     * @return (bool) true if the target has the descriptor
      */
-    self_t &operator*=(const FloatT &scalar){
-      for(unsigned int i = 0; i < rows(); i++){
-        for(unsigned int j = 0; j < columns(); j++){
-          (*this)(i, j) *= scalar;
-        }
-      }
-      return *this;
+    bool view(typename Array2D<FloatT>::view_t &v) const {
+      if(!Array2D_Delegate<FloatT>::getTarget().view(v)){return false;}
+      v.buffer += (int)row_offset() * v.row_stride + (int)column_offset() * v.column_stride;
+      v.rows = this->rows();
+      v.columns = this->columns();
+      return true;
     }
+        
     /**
-     * 
-     * 
-     * @param scalar ?
-     * @return (self_t) ?
-     */
-    self_t operator*(const FloatT &scalar) const{return (copy() *= scalar);}
-    /**
-     * 
-     * 
-     * @param scalar ?
-     * @return (self_t) ?
-     */
-    friend self_t operator*(const FloatT &scalar, const self_t &matrix){return matrix * scalar;}
-    /**
-     * ??
-     * 
-     * @param scalar ?
-     * @return (self_t) 
-     */
-    self_t &operator/=(const FloatT &scalar){return (*this) *= (1 / scalar);}
-    /**
-     * ?
-     * 
-     * @param scalar ?
-     * @return (self_t) ?
-     */
-    self_t operator/(const FloatT &scalar) const{return (copy() /= scalar);}
-    /**
-     * ?
+     * 
      * 
-     * @param scalar ?
-     * @return (self_t) ?
+     * @param row ?(?0)
+     * @param column ?(?0)
+     * @return (FloatT) 
      */
-    friend self_t operator/(const FloatT &scalar, const self_t &matrix){return matrix / scalar;}
+    inline FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column){
+      return Array2D_Delegate<FloatT>::operator()(
+          row + row_offset(), column + column_offset());
+    }
     
     /**
-     * ?
+     * Read-only element accessor
      * 
-     * @param matrix 
-     * @return (self_t) 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
      */
-    self_t &operator+=(const self_t &matrix){
-      assert(rows() == matrix.rows() && columns() == matrix.columns());
-      for(unsigned int i = 0; i < rows(); i++){
-        for(unsigned int j = 0; j < columns(); j++){
-          (*this)(i, j) += const_cast<self_t &>(matrix)(i, j);
-        }
-      }
-      return *this;
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      return Array2D_Delegate<FloatT>::operator()(
+          row + row_offset(), column + column_offset());
     }
+};
 
-    /**
-     * 
-     * 
-     * @param matrix 
-     * @return (self_t) ?
-     */
-    self_t operator+(const self_t &matrix) const{return (copy() += matrix);}
+/*
+ * Thread pool for parallel matrix operations
+ * 
+ * Worker threads are created once and reused, so that a parallel operation
+ * does not pay the cost of thread creation.
+ * The number of threads is std::thread::hardware_concurrency() by default,
+ * which can be overridden by defining MATRIX_THREADS or by calling
+ * Matrix_ThreadPool::get().resize() at runtime.
+ * This feature requires C++11 (and -pthread for GCC);
+ * define MATRIX_NO_THREADS to disable it.
+ */
+#if (__cplusplus >= 201103L) && !defined(MATRIX_NO_THREADS)
+
+#define MATRIX_THREADING
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class Matrix_ThreadPool {
+  public:
+    typedef void (*task_t)(void *context, const unsigned int &index);
     
-    /**
-     * 
-     * 
-     * @param matrix 
-     * @return (self_t) 
-     */
-    self_t &operator-=(const self_t &matrix){
-      assert(rows() == matrix.rows() && columns() == matrix.columns());
-      for(unsigned int i = 0; i < rows(); i++){
-        for(unsigned int j = 0; j < columns(); j++){
-          (*this)(i, j) -= const_cast<self_t &>(matrix)(i, j);
-        }
+  protected:
+    std::vector<std::thread> m_workers; ///< guarded by m_run_mutex after construction
+    std::atomic<unsigned int> m_size; ///< number of threads including the caller thread
+    std::mutex m_run_mutex; ///< one job at a time
+    std::mutex m_mutex; ///< protects the job description below
+    std::condition_variable m_cv_start, m_cv_finish;
+    task_t m_task;
+    void *m_context;
+    unsigned int m_tasks;
+    std::atomic<unsigned int> m_next;
+    unsigned int m_active;
+    unsigned long m_generation;
+    bool m_quit;
+    
+    static bool &in_worker(){
+      static thread_local bool flag(false);
+      return flag;
+    }
+    
+    void work(){
+      for(unsigned int i; (i = m_next.fetch_add(1)) < m_tasks; ){
+        m_task(m_context, i);
       }
-      return *this;
     }
     
     /**
-     * 
-     * 
-     * @param matrix 
-     * @return (self_t) ?
+     * @param generation generation of the last job before this worker started,
+     * which must not be run
      */
-    self_t operator-(const self_t &matrix) const{return (copy() -= matrix);}
+    void worker_loop(unsigned long generation){
+      in_worker() = true;
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while(true){
+        m_cv_start.wait(lock, [&]{return m_quit || (m_generation != generation);});
+        if(m_quit){break;}
+        generation = m_generation;
+        lock.unlock();
+        work();
+        lock.lock();
+        if(--m_active == 0){m_cv_finish.notify_one();}
+      }
+    }
     
-    /**
-     * 
-     * 
-     * @param matrix 
-     * @return (self_t) ?
-     */
-    self_t operator*(const self_t &matrix) const{
-      assert(columns() == matrix.rows());
-      self_t result(self_t::naked(rows(), matrix.columns())); 
-      for(unsigned int i = 0; i < result.rows(); i++){
-        for(unsigned int j = 0; j < result.columns(); j++){
-          for(unsigned int k = 0; k < columns(); k++){
-            result(i, j) += (*const_cast<self_t *>(this))(i, k) * (*const_cast<self_t *>(&matrix))(k, j);
-          }
-        }
+    void stop(){
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
       }
-      return result;
+      m_cv_start.notify_all();
+      for(unsigned int i(0); i < m_workers.size(); i++){m_workers[i].join();}
+      m_workers.clear();
+      m_quit = false;
     }
     
-    /**
-     * (??)
-     *
-     * @param matrix 
-     * @return (self_t) ?
-     */
-    self_t operator*(const transposed_t &matrix) const{
-      return operator*((const self_t &)matrix);
+    void start(const unsigned int &threads){
+      unsigned long generation;
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        generation = m_generation;
+      }
+      for(unsigned int i(1); i < threads; i++){
+        m_workers.push_back(std::thread(&Matrix_ThreadPool::worker_loop, this, generation));
+      }
+      m_size = (unsigned int)m_workers.size() + 1;
     }
     
+  public:
     /**
-     * ?
-     *
-     * @param matrix 
-     * @return (self_t) 
+     * Constructor
+     * 
+     * @param threads number of threads including the caller thread
      */
-    template <class RhsMatrix>
-    self_t &operator*=(const RhsMatrix &matrix){
-      return (*this = (*this * matrix));
+    Matrix_ThreadPool(const unsigned int &threads)
+        : m_size(1), m_task(NULL), m_context(NULL), m_tasks(0), m_next(0),
+        m_active(0), m_generation(0), m_quit(false) {
+      start(threads);
     }
     
+    ~Matrix_ThreadPool(){stop();}
+    
     /**
-     * ??-
-     *  matrix * -1
+     * Return the number of threads including the caller thread.
      * 
-     * @return (self_t) -matrix
+     * @return (unsigned int) number of threads
      */
-    self_t operator-() const{return (copy() *= -1);}
+    unsigned int size() const {return m_size;}
     
     /**
-     * ()?
+     * Change the number of threads.
      * 
-     * @param row ?
-     * @param column ?
-     * @return (self_t) 
+     * @param threads number of threads including the caller thread; 
+     * 1 makes all operations serial, 0 means the hardware concurrency.
      */
-    self_t coMatrix(const unsigned int &row, const unsigned int &column) const{
-      assert(row < rows() && column < columns());
-      self_t result(rows() - 1, columns() - 1);
-      for(int i = 0; i < rows() - 1; i++){
-        for(int j = 0; j < columns() - 1; j++){
-          result(i, j) = (*const_cast<self_t *>(this))((i < row ? i : i + 1), (j < column ? j : j + 1));
-        }  
-      }
-      return result;
+    void resize(unsigned int threads){
+      if(threads == 0){threads = std::thread::hardware_concurrency();}
+      std::lock_guard<std::mutex> lock(m_run_mutex);
+      stop();
+      start(threads);
     }
     
     /**
-     * 
+     * Run task(context, i) for i = 0, 1, ..., tasks - 1 in parallel,
+     * and wait for all of them.
+     * The caller thread also processes tasks.
+     * When the pool is occupied by another caller, or this function is called
+     * from a task, the tasks are processed serially by the caller thread.
      * 
-     * @return (FloatT) ?
+     * @param task task function
+     * @param context argument passed to the task function
+     * @param tasks number of tasks
      */
-    FloatT determinant(bool do_check = false) const{
-      assert((!do_check) || isSquare());
-      if(rows() == 1){
-        return (*const_cast<self_t *>(this))(0, 0);
-      }else{
-        FloatT sum(0);
-        for(int i = 0; i < rows(); i++){
-          if((*const_cast<self_t *>(this))(i, 0) != 0){
-            sum += (*const_cast<self_t *>(this))(i, 0) * (coMatrix(i, 0).determinant()) * (i % 2 == 0 ? 1 : -1);
-          }
-        }
-        return sum;
+    void run(task_t task, void *context, const unsigned int &tasks){
+      bool parallel((tasks > 1) && (!in_worker()) && m_run_mutex.try_lock());
+      if(parallel && m_workers.empty()){ // checked after locking, because resize() modifies it
+        m_run_mutex.unlock();
+        parallel = false;
+      }
+      if(!parallel){
+        for(unsigned int i(0); i < tasks; i++){task(context, i);}
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = task;
+        m_context = context;
+        m_tasks = tasks;
+        m_next = 0;
+        m_active = (unsigned int)m_workers.size();
+        ++m_generation;
+      }
+      m_cv_start.notify_all();
+      in_worker() = true;
+      work();
+      in_worker() = false;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv_finish.wait(lock, [&]{return m_active == 0;});
       }
+      m_run_mutex.unlock();
     }
     
     /**
-     * LU
-     * (0, 0)(n-1, n-1):  L
-     * (0, n)(n-1, 2n-1): U
+     * Return the shared pool.
      * 
-     * @return (self_t) LU
      */
-    self_t decomposeLU(bool do_check = false) const{
-      assert((!do_check) || isSquare());
-      unsigned int size(rows());
-      self_t LU(self_t::naked(size, size * 2));
-#define L(i, j) LU(i, j)
-#define U(i, j) LU(i, j + size)
-      for(int i = 0; i < size; i++){
-        for(int j = 0; j < size; j++){
-          if(i >= j){
-            L(i, j) = (*const_cast<Matrix *>(this))(i, j);
-            for(int k = 0; k < j; k++){
-              L(i, j) -= (L(i, k) * U(k, j));
-            }
-          }else{
-            U(i, j) = (*const_cast<Matrix *>(this))(i, j);
-            for(int k = 0; k < i; k++){
-              U(i, j) -= (L(i, k) * U(k, j));
-            }
-            U(i, j) /= L(i, i);
-          }
-        }
-        U(i, i) = 1;
-      }
-#undef L
-#undef U
-      return LU;
+    static Matrix_ThreadPool &get(){
+#if defined(MATRIX_THREADS)
+      static Matrix_ThreadPool instance(MATRIX_THREADS);
+#else
+      static Matrix_ThreadPool instance(std::thread::hardware_concurrency());
+#endif
+      return instance;
+    }
+};
+
+#endif /* MATRIX_THREADING */
+
+/*
+ * Blocked matrix multiplication engine
+ * 
+ * r = alpha * x * y + beta * r is calculated with the GotoBLAS style
+ * algorithm; panels of x and y are packed into contiguous buffers which fit 
+ * L2 and L3 (or L1 for a micro panel of y) caches respectively, 
+ * and then a micro kernel updates a register block of r.
+ * Each matrix is specified with its row and column strides, therefore
+ * transposed operands are handled natively without materialization.
+ * 
+ * The cache sizes can be tuned by defining MATRIX_GEMM_L1_SIZE, 
+ * MATRIX_GEMM_L2_SIZE and MATRIX_GEMM_L3_SIZE in bytes.
+ */
+#ifndef MATRIX_GEMM_L1_SIZE
+#define MATRIX_GEMM_L1_SIZE (32 * 1024)
+#endif
+#ifndef MATRIX_GEMM_L2_SIZE
+#define MATRIX_GEMM_L2_SIZE (256 * 1024)
+#endif
+#ifndef MATRIX_GEMM_L3_SIZE
+#define MATRIX_GEMM_L3_SIZE (4 * 1024 * 1024)
+#endif
+
+/**
+ * Generic micro kernel, which accumulates 4 x 4 block of C += A * B.
+ * a[i * a_rs + k * a_ks] is A(i, k), b[k * b_ks + j] is B(k, j),
+ * and c[i * c_rs + j] is C(i, j).
+ * 
+ */
+template <class FloatT>
+void mat_mul_kernel_generic(
+    const int kc,
+    const FloatT *a, const int a_rs, const int a_ks,
+    const FloatT *b, const int b_ks,
+    FloatT *c, const int c_rs){
+  FloatT acc[4][4];
+  for(int i(0); i < 4; ++i){
+    for(int j(0); j < 4; ++j){acc[i][j] = FloatT(0);}
+  }
+  for(int k(kc); k > 0; --k, a += a_ks, b += b_ks){
+    for(int i(0); i < 4; ++i){
+      for(int j(0); j < 4; ++j){acc[i][j] += a[i * a_rs] * b[j];}
+    }
+  }
+  for(int i(0); i < 4; ++i){
+    for(int j(0); j < 4; ++j){c[i * c_rs + j] += acc[i][j];}
+  }
+}
+
+/**
+ * Micro kernel and block sizes of the multiplication engine.
+ * The generic kernel is used unless a faster one is specialized
+ * for the type and the running CPU.
+ * 
+ */
+template <class FloatT>
+struct mat_mul_kernel_t {
+  typedef void (*kernel_t)(
+      const int, 
+      const FloatT *, const int, const int,
+      const FloatT *, const int,
+      FloatT *, const int);
+  kernel_t kernel;
+  int mr, nr; ///< register block
+  int mc, kc, nc; ///< cache block
+  
+  void set(kernel_t kernel_, const int mr_, const int nr_){
+    kernel = kernel_;
+    mr = mr_;
+    nr = nr_;
+    
+    // a micro panel of y (kc x nr) stays in L1
+    kc = (int)(MATRIX_GEMM_L1_SIZE / (sizeof(FloatT) * nr)) & ~7;
+    if(kc < 64){kc = 64;}else if(kc > 512){kc = 512;}
+    // a packed panel of x (mc x kc) occupies half of L2
+    mc = (int)(MATRIX_GEMM_L2_SIZE / 2 / (sizeof(FloatT) * kc));
+    mc -= (mc % mr);
+    if(mc < mr){mc = mr;}
+    // a packed panel of y (kc x nc) occupies half of L3
+    nc = (int)(MATRIX_GEMM_L3_SIZE / 2 / (sizeof(FloatT) * kc));
+    nc -= (nc % nr);
+    if(nc < nr){nc = nr;}
+  }
+  
+  mat_mul_kernel_t(){
+    set(mat_mul_kernel_generic<FloatT>, 4, 4);
+  }
+  
+  /**
+   * Return the kernel for the type and the running CPU, 
+   * which is selected only once.
+   * 
+   */
+  static const mat_mul_kernel_t &get(){
+    static const mat_mul_kernel_t instance;
+    return instance;
+  }
+};
+
+/**
+ * Pack mc x kc panel of A (a[i * a_rs + k * a_cs]) into the buffer,
+ * in which each mr rows are interleaved, i.e., packed[(i / mr) * mr * kc + k * mr + i % mr].
+ * Rows beyond mc are padded with zeros.
+ * 
+ */
+template <class FloatT>
+void mat_mul_pack_a(
+    const int mc, const int kc, 
+    const FloatT *a, const int a_rs, const int a_cs,
+    const int mr, const FloatT &alpha,
+    FloatT *packed){
+  for(int ir(0); ir < mc; ir += mr){
+    int rows((mc - ir) < mr ? (mc - ir) : mr);
+    const FloatT *a_k(a + ir * a_rs);
+    for(int k(0); k < kc; k++, a_k += a_cs){
+      int i(0);
+      if(alpha == FloatT(1)){
+        for(; i < rows; i++){*(packed++) = a_k[i * a_rs];}
+      }else{
+        for(; i < rows; i++){*(packed++) = alpha * a_k[i * a_rs];}
+      }
+      for(; i < mr; i++){*(packed++) = FloatT(0);}
+    }
+  }
+}
+
+/**
+ * Pack kc x nc panel of B (b[k * b_rs + j * b_cs]) into the buffer,
+ * in which each nr columns are interleaved, i.e., packed[(j / nr) * nr * kc + k * nr + j % nr].
+ * Columns beyond nc are padded with zeros.
+ * 
+ */
+template <class FloatT>
+void mat_mul_pack_b(
+    const int kc, const int nc, 
+    const FloatT *b, const int b_rs, const int b_cs,
+    const int nr,
+    FloatT *packed){
+  for(int jr(0); jr < nc; jr += nr){
+    int columns((nc - jr) < nr ? (nc - jr) : nr);
+    const FloatT *b_k(b + jr * b_cs);
+    for(int k(0); k < kc; k++, b_k += b_rs){
+      int j(0);
+      if(b_cs == 1){
+        for(; j < columns; j++){*(packed++) = b_k[j];}
+      }else{
+        for(; j < columns; j++){*(packed++) = b_k[j * b_cs];}
+      }
+      for(; j < nr; j++){*(packed++) = FloatT(0);}
+    }
+  }
+}
+
+/**
+ * Multiplication of packed panels, r(mc x nc) += A * B,
+ * where r[i * r_rs + j * r_cs] is r(i, j).
+ * Register blocks lying on the boundary, or on a storage whose columns are
+ * not contiguous, are calculated in a temporary block and then added.
+ * 
+ */
+template <class FloatT>
+void mat_mul_macro_kernel(
+    const mat_mul_kernel_t<FloatT> &k_info,
+    const int mc, const int nc, const int kc,
+    const FloatT *a_packed, const FloatT *b_packed,
+    FloatT *r, const int r_rs, const int r_cs,
+    FloatT *temp){
+  const int &mr(k_info.mr), &nr(k_info.nr);
+  for(int jr(0); jr < nc; jr += nr){
+    int columns((nc - jr) < nr ? (nc - jr) : nr);
+    const FloatT *b_panel(b_packed + jr * kc);
+    for(int ir(0); ir < mc; ir += mr){
+      int rows((mc - ir) < mr ? (mc - ir) : mr);
+      const FloatT *a_panel(a_packed + ir * kc);
+      FloatT *r_block(r + ir * r_rs + jr * r_cs);
+      if((rows == mr) && (columns == nr) && (r_cs == 1)){
+        k_info.kernel(kc, a_panel, 1, mr, b_panel, nr, r_block, r_rs);
+        continue;
+      }
+      for(int i(0); i < mr * nr; i++){temp[i] = FloatT(0);}
+      k_info.kernel(kc, a_panel, 1, mr, b_panel, nr, temp, nr);
+      for(int i(0); i < rows; i++){
+        for(int j(0); j < columns; j++){
+          r_block[i * r_rs + j * r_cs] += temp[i * nr + j];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Workspace for the packed panels, which grows on demand and is reused.
+ * It is kept per thread with C++11, therefore repeated multiplications
+ * do not allocate heap memory after the first one of the largest size.
+ */
+template <class FloatT>
+struct mat_mul_workspace_t {
+  FloatT *buffer;
+  int size;
+  mat_mul_workspace_t() : buffer(NULL), size(0) {}
+  ~mat_mul_workspace_t(){delete [] buffer;}
+  FloatT *get(const int &required){
+    if(required > size){
+      delete [] buffer;
+      buffer = new FloatT[required];
+      size = required;
+    }
+    return buffer;
+  }
+};
+
+/**
+ * Blocked multiplication r = alpha * x * y + beta * r, 
+ * where x is r1 x c1, y is c1 x c2, and r is r1 x c2.
+ * Each element is accessed as x[i * x_rs + k * x_cs], y[k * y_rs + j * y_cs],
+ * and r[i * r_rs + j * r_cs], therefore a transposed operand can be passed
+ * by exchanging its strides.
+ * If beta is zero, r is not read (it can be uninitialized).
+ * This function runs on the caller thread; see mat_mul_blocked() for parallel one.
+ * 
+ */
+template <class FloatT>
+void mat_mul_blocked_serial(
+    const int r1, const int c1, const int c2,
+    const FloatT &alpha,
+    const FloatT *x, const int x_rs, const int x_cs,
+    const FloatT *y, const int y_rs, const int y_cs,
+    const FloatT &beta,
+    FloatT *r, const int r_rs, const int r_cs){
+  
+  if((r1 <= 0) || (c2 <= 0)){return;}
+  
+  // Small matrices are calculated directly, packing costs more.
+  if((c1 <= 0) || (((double)r1 * c2 * c1) <= (8 * 8 * 8))){
+    for(int i(0); i < r1; i++){
+      for(int j(0); j < c2; j++){
+        FloatT sum(0);
+        for(int k(0); k < c1; k++){
+          sum += x[i * x_rs + k * x_cs] * y[k * y_rs + j * y_cs];
+        }
+        FloatT &r_ij(r[i * r_rs + j * r_cs]);
+        r_ij = ((beta == FloatT(0)) ? (alpha * sum) : (alpha * sum + beta * r_ij));
+      }
+    }
+    return;
+  }
+  
+  // r = beta * r
+  for(int i(0); i < r1; i++){
+    FloatT *r_i(r + i * r_rs);
+    if(beta == FloatT(0)){
+      for(int j(0); j < c2; j++){r_i[j * r_cs] = FloatT(0);}
+    }else if(beta != FloatT(1)){
+      for(int j(0); j < c2; j++){r_i[j * r_cs] *= beta;}
+    }
+  }
+  
+  const mat_mul_kernel_t<FloatT> &k_info(mat_mul_kernel_t<FloatT>::get());
+  const int &mr(k_info.mr), &nr(k_info.nr);
+  int mc(k_info.mc < r1 ? k_info.mc : r1), 
+      kc(k_info.kc < c1 ? k_info.kc : c1), 
+      nc(k_info.nc < c2 ? k_info.nc : c2);
+  int mc_ceil(((mc + mr - 1) / mr) * mr), nc_ceil(((nc + nr - 1) / nr) * nr);
+  
+#if __cplusplus >= 201103L
+  static thread_local mat_mul_workspace_t<FloatT> workspace;
+#else
+  mat_mul_workspace_t<FloatT> workspace;
+#endif
+  FloatT *a_packed(workspace.get(mc_ceil * kc + kc * nc_ceil + mr * nr));
+  FloatT *b_packed(a_packed + mc_ceil * kc);
+  FloatT *temp(b_packed + kc * nc_ceil);
+  
+  for(int jc(0); jc < c2; jc += nc){
+    int nc_(((c2 - jc) < nc) ? (c2 - jc) : nc);
+    for(int pc(0); pc < c1; pc += kc){
+      int kc_(((c1 - pc) < kc) ? (c1 - pc) : kc);
+      mat_mul_pack_b(kc_, nc_, 
+          y + pc * y_rs + jc * y_cs, y_rs, y_cs, 
+          nr, b_packed);
+      for(int ic(0); ic < r1; ic += mc){
+        int mc_(((r1 - ic) < mc) ? (r1 - ic) : mc);
+        mat_mul_pack_a(mc_, kc_, 
+            x + ic * x_rs + pc * x_cs, x_rs, x_cs, 
+            mr, alpha, a_packed);
+        mat_mul_macro_kernel(k_info,
+            mc_, nc_, kc_,
+            a_packed, b_packed,
+            r + ic * r_rs + jc * r_cs, r_rs, r_cs,
+            temp);
+      }
+    }
+  }
+}
+
+/*
+ * Matrix-vector multiplication (GEMV)
+ * 
+ * y = alpha * A * x + beta * y is memory bound, therefore A is streamed only once
+ * without packing. Two kernels are prepared for the layout of A;
+ * the dot form for row-major A, in which each element of y is 
+ * an inner product of a row and x, and the axpy form for column-major A, 
+ * in which y is accumulated with the columns scaled by the elements of x.
+ * Both of them process four rows or columns at a time, so that x or y
+ * is loaded once for the four.
+ * A vector-matrix product (GEVM) is handled as the transposed GEMV.
+ * Tall products are split into row blocks, which are processed in parallel.
+ */
+#ifndef MATRIX_GEMV_PARALLEL_THRESHOLD
+#define MATRIX_GEMV_PARALLEL_THRESHOLD (512 * 1024)
+#endif
+
+/**
+ * Generic dot form kernel, y[i * y_s] += alpha * sum_j a[i * a_rs + j] * x[j]
+ * (0 <= i < m, 0 <= j < n).
+ * 
+ */
+template <class FloatT>
+void mat_gemv_dot_generic(
+    const int m, const int n, const FloatT &alpha,
+    const FloatT *a, const int a_rs,
+    const FloatT *x,
+    FloatT *y, const int y_s){
+  int i(0);
+  for(; i + 4 <= m; i += 4, a += a_rs * 4, y += y_s * 4){
+    FloatT sum0(0), sum1(0), sum2(0), sum3(0);
+    const FloatT *a1(a + a_rs), *a2(a1 + a_rs), *a3(a2 + a_rs);
+    for(int j(0); j < n; j++){
+      sum0 += a[j] * x[j];
+      sum1 += a1[j] * x[j];
+      sum2 += a2[j] * x[j];
+      sum3 += a3[j] * x[j];
+    }
+    y[0] += alpha * sum0;
+    y[y_s] += alpha * sum1;
+    y[y_s * 2] += alpha * sum2;
+    y[y_s * 3] += alpha * sum3;
+  }
+  for(; i < m; i++, a += a_rs, y += y_s){
+    FloatT sum(0);
+    for(int j(0); j < n; j++){sum += a[j] * x[j];}
+    *y += alpha * sum;
+  }
+}
+
+/**
+ * Generic axpy form kernel, y[i] += alpha * sum_j a[i + j * a_cs] * x[j * x_s]
+ * (0 <= i < m, 0 <= j < n).
+ * 
+ */
+template <class FloatT>
+void mat_gemv_axpy_generic(
+    const int m, const int n, const FloatT &alpha,
+    const FloatT *a, const int a_cs,
+    const FloatT *x, const int x_s,
+    FloatT *y){
+  int j(0);
+  for(; j + 4 <= n; j += 4, a += a_cs * 4, x += x_s * 4){
+    const FloatT c0(alpha * x[0]), c1(alpha * x[x_s]), 
+        c2(alpha * x[x_s * 2]), c3(alpha * x[x_s * 3]);
+    const FloatT *a1(a + a_cs), *a2(a1 + a_cs), *a3(a2 + a_cs);
+    for(int i(0); i < m; i++){
+      y[i] += c0 * a[i] + c1 * a1[i] + c2 * a2[i] + c3 * a3[i];
+    }
+  }
+  for(; j < n; j++, a += a_cs, x += x_s){
+    const FloatT c0(alpha * *x);
+    for(int i(0); i < m; i++){y[i] += c0 * a[i];}
+  }
+}
+
+/**
+ * Kernels of the matrix-vector multiplication.
+ * The generic kernels are used unless faster ones are specialized
+ * for the type and the running CPU.
+ * 
+ */
+template <class FloatT>
+struct mat_gemv_kernel_t {
+  typedef void (*dot_t)(
+      const int, const int, const FloatT &,
+      const FloatT *, const int,
+      const FloatT *,
+      FloatT *, const int);
+  typedef void (*axpy_t)(
+      const int, const int, const FloatT &,
+      const FloatT *, const int,
+      const FloatT *, const int,
+      FloatT *);
+  dot_t dot;
+  axpy_t axpy;
+  
+  mat_gemv_kernel_t() 
+      : dot(mat_gemv_dot_generic<FloatT>), axpy(mat_gemv_axpy_generic<FloatT>) {}
+  
+  /**
+   * Return the kernels for the type and the running CPU, 
+   * which are selected only once.
+   * 
+   */
+  static const mat_gemv_kernel_t &get(){
+    static const mat_gemv_kernel_t instance;
+    return instance;
+  }
+};
+
+/**
+ * Matrix-vector multiplication y = alpha * A * x + beta * y,
+ * where A is m x n (a[i * a_rs + j * a_cs] is A(i, j)), 
+ * x is n (x[j * x_s]), and y is m (y[i * y_s]).
+ * If beta is zero, y is not read (it can be uninitialized).
+ * x is required to be unit stride when A is row-major (a_cs == 1).
+ * This function runs on the caller thread; see mat_gemv() for parallel one.
+ * 
+ */
+template <class FloatT>
+void mat_gemv_serial(
+    const int m, const int n,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT *x, const int x_s,
+    const FloatT &beta,
+    FloatT *y, const int y_s){
+  
+  if(m <= 0){return;}
+  
+  // y = beta * y
+  if(beta == FloatT(0)){
+    for(int i(0); i < m; i++){y[i * y_s] = FloatT(0);}
+  }else if(beta != FloatT(1)){
+    for(int i(0); i < m; i++){y[i * y_s] *= beta;}
+  }
+  if(n <= 0){return;}
+  
+  const mat_gemv_kernel_t<FloatT> &k_info(mat_gemv_kernel_t<FloatT>::get());
+  if((a_cs == 1) && (x_s == 1)){
+    k_info.dot(m, n, alpha, a, a_rs, x, y, y_s);
+    return;
+  }else if(a_rs != 1){
+    for(int i(0); i < m; i++){
+      FloatT sum(0);
+      for(int j(0); j < n; j++){sum += a[i * a_rs + j * a_cs] * x[j * x_s];}
+      y[i * y_s] += alpha * sum;
+    }
+    return;
+  }
+  
+  // Rows are blocked so that the block of y stays in L1 during the sweep of columns.
+  const int mb((int)(MATRIX_GEMM_L1_SIZE / 2 / sizeof(FloatT)));
+#if __cplusplus >= 201103L
+  static thread_local mat_mul_workspace_t<FloatT> workspace;
+#else
+  mat_mul_workspace_t<FloatT> workspace; // must outlive temp
+#endif
+  FloatT *temp((y_s != 1) ? workspace.get(mb) : NULL);
+  for(int i(0); i < m; i += mb){
+    const int mb_(((m - i) < mb) ? (m - i) : mb);
+    if(temp){
+      for(int i2(0); i2 < mb_; i2++){temp[i2] = FloatT(0);}
+      k_info.axpy(mb_, n, alpha, a + i, a_cs, x, x_s, temp);
+      for(int i2(0); i2 < mb_; i2++){y[(i + i2) * y_s] += temp[i2];}
+    }else{
+      k_info.axpy(mb_, n, alpha, a + i, a_cs, x, x_s, y + i);
+    }
+  }
+}
+
+#if defined(MATRIX_THREADING)
+/**
+ * Task of the parallel matrix-vector multiplication, which processes a row block.
+ * 
+ */
+template <class FloatT>
+struct mat_gemv_parallel_task_t {
+  int m, n;
+  FloatT alpha;
+  const FloatT *a; int a_rs, a_cs;
+  const FloatT *x; int x_s;
+  FloatT beta;
+  FloatT *y; int y_s;
+  int block;
+  
+  static void run(void *context, const unsigned int &index){
+    const mat_gemv_parallel_task_t &t(*static_cast<mat_gemv_parallel_task_t *>(context));
+    int i((int)index * t.block);
+    mat_gemv_serial(
+        ((t.m - i) < t.block) ? (t.m - i) : t.block, t.n,
+        t.alpha,
+        t.a + i * t.a_rs, t.a_rs, t.a_cs,
+        t.x, t.x_s,
+        t.beta,
+        t.y + i * t.y_s, t.y_s);
+  }
+};
+#endif
+
+/**
+ * Matrix-vector multiplication y = alpha * A * x + beta * y 
+ * (see mat_gemv_serial() for the arguments), where x can have any stride.
+ * A tall product is split into row blocks, which are multiplied
+ * by the threads of Matrix_ThreadPool in parallel.
+ * 
+ */
+template <class FloatT>
+void mat_gemv(
+    const int m, const int n,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT *x, const int x_s,
+    const FloatT &beta,
+    FloatT *y, const int y_s){
+  // x is gathered for the dot form, whose kernel reads it by vectors.
+#if __cplusplus >= 201103L
+  static thread_local mat_mul_workspace_t<FloatT> workspace;
+#else
+  mat_mul_workspace_t<FloatT> workspace;
+#endif
+  int x_s_(x_s);
+  if((a_cs == 1) && (x_s != 1) && (m > 1) && (n > 0)){
+    FloatT *x_unit(workspace.get(n));
+    for(int j(0); j < n; j++){x_unit[j] = x[j * x_s];}
+    x = x_unit;
+    x_s_ = 1;
+  }
+#if defined(MATRIX_THREADING)
+  Matrix_ThreadPool &pool(Matrix_ThreadPool::get());
+  if((pool.size() > 1) && (m > 1) && (n > 0)
+      && (((double)m * n) >= MATRIX_GEMV_PARALLEL_THRESHOLD)){
+    // Each thread gets at least two row blocks, whose size is a multiple of 64.
+    int block((m + pool.size() * 2 - 1) / (pool.size() * 2));
+    block = ((block + 63) / 64) * 64;
+    mat_gemv_parallel_task_t<FloatT> task = {
+        m, n, alpha, a, a_rs, a_cs, x, x_s_, beta, y, y_s, block};
+    pool.run(mat_gemv_parallel_task_t<FloatT>::run, &task,
+        (unsigned int)((m + block - 1) / block));
+    return;
+  }
+#endif
+  mat_gemv_serial(m, n, alpha, a, a_rs, a_cs, x, x_s_, beta, y, y_s);
+}
+
+/*
+ * Minimum number of multiply-adds (r1 * c1 * c2) for the parallel multiplication,
+ * and the size of output tiles assigned to each task.
+ */
+#ifndef MATRIX_GEMM_PARALLEL_THRESHOLD
+#define MATRIX_GEMM_PARALLEL_THRESHOLD (128 * 128 * 128)
+#endif
+#ifndef MATRIX_GEMM_PARALLEL_TILE
+#define MATRIX_GEMM_PARALLEL_TILE 256
+#endif
+
+#if defined(MATRIX_THREADING)
+/**
+ * Task of the parallel multiplication, which multiplies an output tile.
+ * 
+ */
+template <class FloatT>
+struct mat_mul_parallel_task_t {
+  int r1, c1, c2;
+  FloatT alpha;
+  const FloatT *x; int x_rs, x_cs;
+  const FloatT *y; int y_rs, y_cs;
+  FloatT beta;
+  FloatT *r; int r_rs, r_cs;
+  int tile_rows, tile_columns, tiles_n;
+  
+  static void run(void *context, const unsigned int &index){
+    const mat_mul_parallel_task_t &t(*static_cast<mat_mul_parallel_task_t *>(context));
+    int i((index / t.tiles_n) * t.tile_rows), j((index % t.tiles_n) * t.tile_columns);
+    mat_mul_blocked_serial(
+        ((t.r1 - i) < t.tile_rows) ? (t.r1 - i) : t.tile_rows,
+        t.c1,
+        ((t.c2 - j) < t.tile_columns) ? (t.c2 - j) : t.tile_columns,
+        t.alpha,
+        t.x + i * t.x_rs, t.x_rs, t.x_cs,
+        t.y + j * t.y_cs, t.y_rs, t.y_cs,
+        t.beta,
+        t.r + i * t.r_rs + j * t.r_cs, t.r_rs, t.r_cs);
+  }
+};
+#endif
+
+/**
+ * Blocked multiplication r = alpha * x * y + beta * r 
+ * (see mat_mul_blocked_serial() for the arguments).
+ * A large multiplication is split into output tiles, which are multiplied
+ * by the threads of Matrix_ThreadPool in parallel.
+ * When r is a row or column vector, mat_gemv() is used instead.
+ * 
+ */
+template <class FloatT>
+void mat_mul_blocked(
+    const int r1, const int c1, const int c2,
+    const FloatT &alpha,
+    const FloatT *x, const int x_rs, const int x_cs,
+    const FloatT *y, const int y_rs, const int y_cs,
+    const FloatT &beta,
+    FloatT *r, const int r_rs, const int r_cs){
+  if((c2 == 1) && (r1 > 1)){ // r(:, 0) = alpha * x * y(:, 0) + beta * r(:, 0)
+    mat_gemv(r1, c1, alpha, x, x_rs, x_cs, y, y_rs, beta, r, r_rs);
+    return;
+  }else if((r1 == 1) && (c2 > 1)){ // r(0, :)^{T} = alpha * y^{T} * x(0, :)^{T} + beta * r(0, :)^{T}
+    mat_gemv(c2, c1, alpha, y, y_cs, y_rs, x, x_cs, beta, r, r_cs);
+    return;
+  }
+#if defined(MATRIX_THREADING)
+  Matrix_ThreadPool &pool(Matrix_ThreadPool::get());
+  if((pool.size() > 1) && (r1 > 0) && (c2 > 0)
+      && (((double)r1 * c1 * c2) >= MATRIX_GEMM_PARALLEL_THRESHOLD)){
+    const mat_mul_kernel_t<FloatT> &k_info(mat_mul_kernel_t<FloatT>::get());
+    // Tiles are shrunk until each thread gets at least two tiles.
+    int tile_rows(MATRIX_GEMM_PARALLEL_TILE), tile_columns(MATRIX_GEMM_PARALLEL_TILE);
+    while(true){
+      int tiles(((r1 + tile_rows - 1) / tile_rows) * ((c2 + tile_columns - 1) / tile_columns));
+      if(tiles >= (int)pool.size() * 2){break;}
+      if((tile_rows >= tile_columns) && (tile_rows > k_info.mr * 4)){
+        tile_rows /= 2;
+      }else if(tile_columns > k_info.nr * 4){
+        tile_columns /= 2;
+      }else{break;}
+    }
+    tile_rows -= (tile_rows % k_info.mr);
+    tile_columns -= (tile_columns % k_info.nr);
+    mat_mul_parallel_task_t<FloatT> task = {
+        r1, c1, c2, alpha, x, x_rs, x_cs, y, y_rs, y_cs, beta, r, r_rs, r_cs,
+        tile_rows, tile_columns, (c2 + tile_columns - 1) / tile_columns};
+    pool.run(mat_mul_parallel_task_t<FloatT>::run, &task,
+        (unsigned int)(((r1 + tile_rows - 1) / tile_rows) * task.tiles_n));
+    return;
+  }
+#endif
+  mat_mul_blocked_serial(r1, c1, c2, alpha, x, x_rs, x_cs, y, y_rs, y_cs, beta, r, r_rs, r_cs);
+}
+
+/**
+ * Blocked multiplication r = x * y, with the same arguments as mat_mul().
+ * x is r1 x c1 (or c1 x r1 if x_trans), and y is c1 x c2 (or c2 x c1 if y_trans),
+ * both of which are dense and row-major; r is dense r1 x c2.
+ * 
+ */
+template <class FloatT>
+void mat_mul_blocked(const FloatT *x, const int r1, const int c1, 
+    const FloatT *y, const int c2, 
+    FloatT *r,
+    bool x_trans = false, bool y_trans = false){
+  mat_mul_blocked(r1, c1, c2,
+      FloatT(1),
+      x, (x_trans ? 1 : c1), (x_trans ? r1 : 1),
+      y, (y_trans ? 1 : c2), (y_trans ? c1 : 1),
+      FloatT(0),
+      r, c2, 1);
+}
+
+/*
+ * SIMD micro kernels of the multiplication engine for x86(-64).
+ * The instruction set (SSE2, AVX2 + FMA, AVX-512F) is selected at runtime
+ * by checking the running CPU, therefore a binary built for generic x86-64
+ * can run at the peak speed of each server.
+ * Define MATRIX_NO_SIMD to disable this feature, or define MATRIX_SIMD_MAX_ISA
+ * to one of mat_mul_simd_isa_t to limit the selection, for example, 
+ * in order to test the SSE2 kernels on a CPU supporting AVX-512.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)) || defined(__clang__)) \
+    && !defined(MATRIX_NO_SIMD)
+
+#define MATRIX_SIMD_X86
+#include <immintrin.h>
+
+#define MATRIX_SIMD_TARGET(spec) __attribute__((target(spec)))
+
+/**
+ * Instruction sets for SIMD kernels
+ */
+enum mat_mul_simd_isa_t {
+  MAT_MUL_SIMD_NONE = 0,
+  MAT_MUL_SIMD_SSE2,
+  MAT_MUL_SIMD_AVX2,
+  MAT_MUL_SIMD_AVX512
+};
+
+#ifndef MATRIX_SIMD_MAX_ISA
+#define MATRIX_SIMD_MAX_ISA MAT_MUL_SIMD_AVX512
+#endif
+
+/**
+ * Primitive vector operations for the micro kernels.
+ * mr and nv * width determine the size of the register block.
+ */
+template <class FloatT, int isa>
+struct mat_mul_simd_traits_t;
+
+#define MAKE_TRAITS(type, isa, spec, vec, w, mr_, nv_, \
+    setzero, loadu, storeu, set1, add, mul, fmadd) \
+template <> \
+struct mat_mul_simd_traits_t<type, isa> { \
+  typedef type float_t; \
+  typedef vec vec_t; \
+  static const int width = w; \
+  static const int mr = mr_; \
+  static const int nv = nv_; \
+  static const int nr = w * nv_; \
+  MATRIX_SIMD_TARGET(spec) static inline vec_t zero(){return setzero();} \
+  MATRIX_SIMD_TARGET(spec) static inline vec_t load(const type *p){return loadu(p);} \
+  MATRIX_SIMD_TARGET(spec) static inline void store(type *p, const vec_t &v){storeu(p, v);} \
+  MATRIX_SIMD_TARGET(spec) static inline vec_t broadcast(const type *p){return set1(*p);} \
+  MATRIX_SIMD_TARGET(spec) static inline vec_t plus(const vec_t &a, const vec_t &b){return add(a, b);} \
+  MATRIX_SIMD_TARGET(spec) static inline vec_t mul_add( \
+      const vec_t &a, const vec_t &b, const vec_t &c){return fmadd;} \
+};
+
+MAKE_TRAITS(double, MAT_MUL_SIMD_SSE2, "sse2", __m128d, 2, 4, 2,
+    _mm_setzero_pd, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, _mm_add_pd, _mm_mul_pd,
+    _mm_add_pd(_mm_mul_pd(a, b), c))
+MAKE_TRAITS(float, MAT_MUL_SIMD_SSE2, "sse2", __m128, 4, 4, 2,
+    _mm_setzero_ps, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, _mm_add_ps, _mm_mul_ps,
+    _mm_add_ps(_mm_mul_ps(a, b), c))
+MAKE_TRAITS(double, MAT_MUL_SIMD_AVX2, "avx2,fma", __m256d, 4, 6, 2,
+    _mm256_setzero_pd, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, _mm256_add_pd, _mm256_mul_pd,
+    _mm256_fmadd_pd(a, b, c))
+MAKE_TRAITS(float, MAT_MUL_SIMD_AVX2, "avx2,fma", __m256, 8, 6, 2,
+    _mm256_setzero_ps, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, _mm256_add_ps, _mm256_mul_ps,
+    _mm256_fmadd_ps(a, b, c))
+MAKE_TRAITS(double, MAT_MUL_SIMD_AVX512, "avx512f", __m512d, 8, 8, 2,
+    _mm512_setzero_pd, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, _mm512_add_pd, _mm512_mul_pd,
+    _mm512_fmadd_pd(a, b, c))
+MAKE_TRAITS(float, MAT_MUL_SIMD_AVX512, "avx512f", __m512, 16, 8, 2,
+    _mm512_setzero_ps, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, _mm512_add_ps, _mm512_mul_ps,
+    _mm512_fmadd_ps(a, b, c))
+
+#undef MAKE_TRAITS
+
+/*
+ * Micro kernel, which accumulates mr x nr block of C += A * B
+ * (see mat_mul_kernel_generic for the arguments).
+ * The accumulators stay in registers during the loop on k.
+ */
+#define MAKE_KERNEL(isa, spec) \
+template <class traits_t> \
+MATRIX_SIMD_TARGET(spec) \
+void mat_mul_simd_kernel_ ## isa( \
+    const int kc, \
+    const typename traits_t::float_t *a, const int a_rs, const int a_ks, \
+    const typename traits_t::float_t *b, const int b_ks, \
+    typename traits_t::float_t *c, const int c_rs){ \
+  typedef typename traits_t::vec_t vec_t; \
+  vec_t acc[traits_t::mr][traits_t::nv]; \
+  _Pragma("GCC unroll 16") \
+  for(int i(0); i < traits_t::mr; ++i){ \
+    _Pragma("GCC unroll 4") \
+    for(int j(0); j < traits_t::nv; ++j){acc[i][j] = traits_t::zero();} \
+  } \
+  for(int k(kc); k > 0; --k, a += a_ks, b += b_ks){ \
+    vec_t b_k[traits_t::nv]; \
+    _Pragma("GCC unroll 4") \
+    for(int j(0); j < traits_t::nv; ++j){b_k[j] = traits_t::load(b + j * traits_t::width);} \
+    _Pragma("GCC unroll 16") \
+    for(int i(0); i < traits_t::mr; ++i){ \
+      vec_t a_ik(traits_t::broadcast(a + i * a_rs)); \
+      _Pragma("GCC unroll 4") \
+      for(int j(0); j < traits_t::nv; ++j){ \
+        acc[i][j] = traits_t::mul_add(a_ik, b_k[j], acc[i][j]); \
+      } \
+    } \
+  } \
+  _Pragma("GCC unroll 16") \
+  for(int i(0); i < traits_t::mr; ++i){ \
+    _Pragma("GCC unroll 4") \
+    for(int j(0); j < traits_t::nv; ++j){ \
+      typename traits_t::float_t *c_ij(c + i * c_rs + j * traits_t::width); \
+      traits_t::store(c_ij, traits_t::plus(traits_t::load(c_ij), acc[i][j])); \
+    } \
+  } \
+}
+
+MAKE_KERNEL(sse2, "sse2")
+MAKE_KERNEL(avx2, "avx2,fma")
+MAKE_KERNEL(avx512, "avx512f")
+
+#undef MAKE_KERNEL
+
+/*
+ * Kernels for the running CPU, selected by checking its instruction set
+ */
+#define MAKE_SPECIALIZED(type) \
+template <> \
+inline mat_mul_kernel_t<type >::mat_mul_kernel_t(){ \
+  __builtin_cpu_init(); \
+  if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_AVX512) && __builtin_cpu_supports("avx512f")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_AVX512> traits_t; \
+    set(mat_mul_simd_kernel_avx512<traits_t>, traits_t::mr, traits_t::nr); \
+  }else if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_AVX2) \
+      && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_AVX2> traits_t; \
+    set(mat_mul_simd_kernel_avx2<traits_t>, traits_t::mr, traits_t::nr); \
+  }else if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_SSE2) && __builtin_cpu_supports("sse2")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_SSE2> traits_t; \
+    set(mat_mul_simd_kernel_sse2<traits_t>, traits_t::mr, traits_t::nr); \
+  }else{ \
+    set(mat_mul_kernel_generic<type >, 4, 4); \
+  } \
+}
+
+MAKE_SPECIALIZED(double)
+MAKE_SPECIALIZED(float)
+
+#undef MAKE_SPECIALIZED
+
+/*
+ * Kernels of the matrix-vector multiplication
+ * (see mat_gemv_dot_generic and mat_gemv_axpy_generic for the arguments).
+ * The dot form keeps four vector accumulators, which are reduced horizontally
+ * at the end of each row; the axpy form updates a vector of y 
+ * with four columns at once.
+ */
+#define MAKE_KERNEL(isa, spec) \
+template <class traits_t> \
+MATRIX_SIMD_TARGET(spec) \
+void mat_gemv_simd_dot_ ## isa( \
+    const int m, const int n, const typename traits_t::float_t &alpha, \
+    const typename traits_t::float_t *a, const int a_rs, \
+    const typename traits_t::float_t *x, \
+    typename traits_t::float_t *y, const int y_s){ \
+  typedef typename traits_t::float_t float_t; \
+  typedef typename traits_t::vec_t vec_t; \
+  static const int w(traits_t::width); \
+  const int n_w(n - (n % w)); \
+  float_t lanes[w]; \
+  int i(0); \
+  for(; i + 4 <= m; i += 4, a += a_rs * 4, y += y_s * 4){ \
+    vec_t acc[4]; \
+    _Pragma("GCC unroll 4") \
+    for(int k(0); k < 4; ++k){acc[k] = traits_t::zero();} \
+    for(int j(0); j < n_w; j += w){ \
+      vec_t x_j(traits_t::load(x + j)); \
+      _Pragma("GCC unroll 4") \
+      for(int k(0); k < 4; ++k){ \
+        acc[k] = traits_t::mul_add(traits_t::load(a + k * a_rs + j), x_j, acc[k]); \
+      } \
+    } \
+    for(int k(0); k < 4; ++k){ \
+      traits_t::store(lanes, acc[k]); \
+      float_t sum(0); \
+      for(int l(0); l < w; ++l){sum += lanes[l];} \
+      for(int j(n_w); j < n; ++j){sum += a[k * a_rs + j] * x[j];} \
+      y[k * y_s] += alpha * sum; \
+    } \
+  } \
+  for(; i < m; i++, a += a_rs, y += y_s){ \
+    vec_t acc(traits_t::zero()); \
+    for(int j(0); j < n_w; j += w){ \
+      acc = traits_t::mul_add(traits_t::load(a + j), traits_t::load(x + j), acc); \
+    } \
+    traits_t::store(lanes, acc); \
+    float_t sum(0); \
+    for(int l(0); l < w; ++l){sum += lanes[l];} \
+    for(int j(n_w); j < n; ++j){sum += a[j] * x[j];} \
+    *y += alpha * sum; \
+  } \
+} \
+template <class traits_t> \
+MATRIX_SIMD_TARGET(spec) \
+void mat_gemv_simd_axpy_ ## isa( \
+    const int m, const int n, const typename traits_t::float_t &alpha, \
+    const typename traits_t::float_t *a, const int a_cs, \
+    const typename traits_t::float_t *x, const int x_s, \
+    typename traits_t::float_t *y){ \
+  typedef typename traits_t::float_t float_t; \
+  typedef typename traits_t::vec_t vec_t; \
+  static const int w(traits_t::width); \
+  const int m_w(m - (m % w)); \
+  int j(0); \
+  for(; j + 4 <= n; j += 4, a += a_cs * 4, x += x_s * 4){ \
+    float_t c[4]; \
+    vec_t c_v[4]; \
+    _Pragma("GCC unroll 4") \
+    for(int k(0); k < 4; ++k){ \
+      c[k] = alpha * x[k * x_s]; \
+      c_v[k] = traits_t::broadcast(&c[k]); \
+    } \
+    for(int i(0); i < m_w; i += w){ \
+      vec_t y_i(traits_t::load(y + i)); \
+      _Pragma("GCC unroll 4") \
+      for(int k(0); k < 4; ++k){ \
+        y_i = traits_t::mul_add(c_v[k], traits_t::load(a + k * a_cs + i), y_i); \
+      } \
+      traits_t::store(y + i, y_i); \
+    } \
+    for(int i(m_w); i < m; ++i){ \
+      y[i] += c[0] * a[i] + c[1] * a[a_cs + i] + c[2] * a[a_cs * 2 + i] + c[3] * a[a_cs * 3 + i]; \
+    } \
+  } \
+  for(; j < n; j++, a += a_cs, x += x_s){ \
+    const float_t c(alpha * *x); \
+    const vec_t c_v(traits_t::broadcast(&c)); \
+    for(int i(0); i < m_w; i += w){ \
+      traits_t::store(y + i, traits_t::mul_add(c_v, traits_t::load(a + i), traits_t::load(y + i))); \
+    } \
+    for(int i(m_w); i < m; ++i){y[i] += c * a[i];} \
+  } \
+}
+
+MAKE_KERNEL(sse2, "sse2")
+MAKE_KERNEL(avx2, "avx2,fma")
+MAKE_KERNEL(avx512, "avx512f")
+
+#undef MAKE_KERNEL
+
+#define MAKE_SPECIALIZED(type) \
+template <> \
+inline mat_gemv_kernel_t<type >::mat_gemv_kernel_t() \
+    : dot(mat_gemv_dot_generic<type >), axpy(mat_gemv_axpy_generic<type >) { \
+  __builtin_cpu_init(); \
+  if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_AVX512) && __builtin_cpu_supports("avx512f")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_AVX512> traits_t; \
+    dot = mat_gemv_simd_dot_avx512<traits_t>; \
+    axpy = mat_gemv_simd_axpy_avx512<traits_t>; \
+  }else if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_AVX2) \
+      && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_AVX2> traits_t; \
+    dot = mat_gemv_simd_dot_avx2<traits_t>; \
+    axpy = mat_gemv_simd_axpy_avx2<traits_t>; \
+  }else if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_SSE2) && __builtin_cpu_supports("sse2")){ \
+    typedef mat_mul_simd_traits_t<type, MAT_MUL_SIMD_SSE2> traits_t; \
+    dot = mat_gemv_simd_dot_sse2<traits_t>; \
+    axpy = mat_gemv_simd_axpy_sse2<traits_t>; \
+  } \
+}
+
+MAKE_SPECIALIZED(double)
+MAKE_SPECIALIZED(float)
+
+#undef MAKE_SPECIALIZED
+
+/*
+ * Transposition of w x w block in registers, y[i * y_ld + j] = x[i + j * x_ld],
+ * in which each row of x is loaded to a register, and 
+ * the registers are exchanged with the unpack and the permutation instructions.
+ */
+MATRIX_SIMD_TARGET("sse2")
+inline void mat_transpose_simd_block_sse2(
+    const double *x, const int x_ld, double *y, const int y_ld){
+  __m128d r0(_mm_loadu_pd(x)), r1(_mm_loadu_pd(x + x_ld));
+  _mm_storeu_pd(y, _mm_unpacklo_pd(r0, r1));
+  _mm_storeu_pd(y + y_ld, _mm_unpackhi_pd(r0, r1));
+}
+MATRIX_SIMD_TARGET("sse2")
+inline void mat_transpose_simd_block_sse2(
+    const float *x, const int x_ld, float *y, const int y_ld){
+  __m128 r0(_mm_loadu_ps(x)), r1(_mm_loadu_ps(x + x_ld)),
+      r2(_mm_loadu_ps(x + x_ld * 2)), r3(_mm_loadu_ps(x + x_ld * 3));
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+  _mm_storeu_ps(y, r0);
+  _mm_storeu_ps(y + y_ld, r1);
+  _mm_storeu_ps(y + y_ld * 2, r2);
+  _mm_storeu_ps(y + y_ld * 3, r3);
+}
+MATRIX_SIMD_TARGET("avx")
+inline void mat_transpose_simd_block_avx(
+    const double *x, const int x_ld, double *y, const int y_ld){
+  __m256d r0(_mm256_loadu_pd(x)), r1(_mm256_loadu_pd(x + x_ld)),
+      r2(_mm256_loadu_pd(x + x_ld * 2)), r3(_mm256_loadu_pd(x + x_ld * 3));
+  __m256d t0(_mm256_unpacklo_pd(r0, r1)), t1(_mm256_unpackhi_pd(r0, r1)),
+      t2(_mm256_unpacklo_pd(r2, r3)), t3(_mm256_unpackhi_pd(r2, r3));
+  _mm256_storeu_pd(y, _mm256_permute2f128_pd(t0, t2, 0x20));
+  _mm256_storeu_pd(y + y_ld, _mm256_permute2f128_pd(t1, t3, 0x20));
+  _mm256_storeu_pd(y + y_ld * 2, _mm256_permute2f128_pd(t0, t2, 0x31));
+  _mm256_storeu_pd(y + y_ld * 3, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+MATRIX_SIMD_TARGET("avx")
+inline void mat_transpose_simd_block_avx(
+    const float *x, const int x_ld, float *y, const int y_ld){
+  __m256 r[8], t[8];
+  for(int j(0); j < 8; ++j){r[j] = _mm256_loadu_ps(x + x_ld * j);}
+  for(int j(0); j < 8; j += 2){
+    t[j] = _mm256_unpacklo_ps(r[j], r[j + 1]);
+    t[j + 1] = _mm256_unpackhi_ps(r[j], r[j + 1]);
+  }
+  for(int j(0); j < 8; j += 4){
+    r[j] = _mm256_shuffle_ps(t[j], t[j + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    r[j + 1] = _mm256_shuffle_ps(t[j], t[j + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    r[j + 2] = _mm256_shuffle_ps(t[j + 1], t[j + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    r[j + 3] = _mm256_shuffle_ps(t[j + 1], t[j + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  for(int i(0); i < 4; ++i){
+    _mm256_storeu_ps(y + y_ld * i, _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+    _mm256_storeu_ps(y + y_ld * (i + 4), _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+  }
+}
+
+/*
+ * Tile kernel for transposition (see mat_transpose_kernel_generic for the arguments),
+ * which covers the tile with w x w blocks, and the remainder is copied element-wise.
+ */
+#define MAKE_KERNEL(isa, spec) \
+template <class FloatT, int w> \
+MATRIX_SIMD_TARGET(spec) \
+void mat_transpose_simd_kernel_ ## isa( \
+    const int r, const int c, \
+    const FloatT *x, const int x_cs, \
+    FloatT *y, const int y_rs){ \
+  const int r_w(r - (r % w)), c_w(c - (c % w)); \
+  for(int i(0); i < r_w; i += w){ \
+    for(int j(0); j < c_w; j += w){ \
+      mat_transpose_simd_block_ ## isa(x + i + j * x_cs, x_cs, y + i * y_rs + j, y_rs); \
+    } \
+    for(int i2(i); i2 < i + w; ++i2){ \
+      for(int j(c_w); j < c; ++j){y[i2 * y_rs + j] = x[i2 + j * x_cs];} \
+    } \
+  } \
+  for(int i(r_w); i < r; ++i){ \
+    for(int j(0); j < c; ++j){y[i * y_rs + j] = x[i + j * x_cs];} \
+  } \
+}
+
+MAKE_KERNEL(sse2, "sse2")
+MAKE_KERNEL(avx, "avx")
+
+#undef MAKE_KERNEL
+
+#define MAKE_SPECIALIZED(type, w_sse2, w_avx) \
+template <> \
+inline mat_transpose_kernel_t<type >::mat_transpose_kernel_t() \
+    : kernel(mat_transpose_kernel_generic<type >), width(1) { \
+  __builtin_cpu_init(); \
+  if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_AVX2) && __builtin_cpu_supports("avx")){ \
+    kernel = mat_transpose_simd_kernel_avx<type, w_avx>; \
+    width = w_avx; \
+  }else if((MATRIX_SIMD_MAX_ISA >= MAT_MUL_SIMD_SSE2) && __builtin_cpu_supports("sse2")){ \
+    kernel = mat_transpose_simd_kernel_sse2<type, w_sse2>; \
+    width = w_sse2; \
+  } \
+}
+
+MAKE_SPECIALIZED(double, 2, 4)
+MAKE_SPECIALIZED(float, 4, 8)
+
+#undef MAKE_SPECIALIZED
+
+#endif /* MATRIX_SIMD_X86 */
+
+/*
+ * Kernels for factorizations
+ * 
+ * They work on dense storage specified with its row and column strides,
+ * and the level-3 parts are delegated to mat_mul_blocked().
+ * The block size can be tuned by defining MATRIX_FACTORIZATION_BLOCK.
+ */
+#ifndef MATRIX_FACTORIZATION_BLOCK
+#define MATRIX_FACTORIZATION_BLOCK 64
+#endif
+
+/**
+ * Triangular solve in place, X = T^{-1} * X, 
+ * where T is n x n triangular (t[i * t_rs + j * t_cs] is T(i, j)),
+ * and X is n x m (x[i * x_rs + j * x_cs] is X(i, j)).
+ * The other triangle of T is not referred, 
+ * therefore T can share storage with another triangular matrix;
+ * T^{T} is solved by exchanging t_rs and t_cs together with lower.
+ * 
+ * @param lower true when T is lower triangular, otherwise upper
+ * @param unit true when the diagonal elements of T are assumed to be one (and not referred)
+ */
+template <class FloatT>
+void mat_trsm_left(
+    const int n, const int m,
+    const FloatT *t, const int t_rs, const int t_cs,
+    const bool lower, const bool unit,
+    FloatT *x, const int x_rs, const int x_cs){
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  for(int b(0); b < n; b += nb){
+    int ib(((n - b) < nb) ? (n - b) : nb);
+    int i0(lower ? b : (n - b - ib)); // diagonal block [i0, i0 + ib)
+    for(int ii(0); ii < ib; ii++){
+      int i(lower ? (i0 + ii) : (i0 + ib - 1 - ii));
+      FloatT *x_i(x + i * x_rs);
+      int k_begin(lower ? i0 : (i + 1)), k_end(lower ? i : (i0 + ib));
+      for(int k(k_begin); k < k_end; k++){
+        const FloatT t_ik(t[i * t_rs + k * t_cs]);
+        if(t_ik == FloatT(0)){continue;}
+        const FloatT *x_k(x + k * x_rs);
+        for(int j(0); j < m; j++){x_i[j * x_cs] -= t_ik * x_k[j * x_cs];}
+      }
+      if(!unit){
+        const FloatT t_ii(t[i * (t_rs + t_cs)]);
+        for(int j(0); j < m; j++){x_i[j * x_cs] /= t_ii;}
+      }
+    }
+    // update of the remaining rows with the solved block
+    if(lower && (i0 + ib < n)){
+      mat_mul_blocked(n - i0 - ib, ib, m, 
+          FloatT(-1),
+          t + (i0 + ib) * t_rs + i0 * t_cs, t_rs, t_cs,
+          x + i0 * x_rs, x_rs, x_cs,
+          FloatT(1),
+          x + (i0 + ib) * x_rs, x_rs, x_cs);
+    }else if((!lower) && (i0 > 0)){
+      mat_mul_blocked(i0, ib, m, 
+          FloatT(-1),
+          t + i0 * t_cs, t_rs, t_cs,
+          x + i0 * x_rs, x_rs, x_cs,
+          FloatT(1),
+          x, x_rs, x_cs);
+    }
+  }
+}
+
+/**
+ * Row interchanges of X (n x m) recorded by mat_lu_blocked(), 
+ * i.e., rows i and pivot[i] are exchanged for i = 0, 1, ..., n - 1 in order
+ * (in reverse order if reverse is true).
+ * 
+ */
+template <class FloatT>
+void mat_swap_rows(
+    const int n, const int m,
+    FloatT *x, const int x_rs, const int x_cs,
+    const unsigned int *pivot, const bool reverse = false){
+  for(int ii(0); ii < n; ii++){
+    int i(reverse ? (n - 1 - ii) : ii);
+    if((int)pivot[i] == i){continue;}
+    FloatT *x_i(x + i * x_rs), *x_p(x + pivot[i] * x_rs);
+    for(int j(0); j < m; j++){
+      FloatT temp(x_i[j * x_cs]);
+      x_i[j * x_cs] = x_p[j * x_cs];
+      x_p[j * x_cs] = temp;
+    }
+  }
+}
+
+/**
+ * Blocked LU decomposition with partial pivoting in place, P * A = L * U,
+ * where A is n x n (a[i * a_rs + j * a_cs] is A(i, j)).
+ * The strictly lower part of A is overwritten by L whose diagonal elements are one,
+ * and the upper part by U. 
+ * P is recorded as the row interchanges in pivot, 
+ * i.e., rows i and pivot[i] are exchanged at step i (same as LAPACK getrf).
+ * The panel of each block column is factorized by the rank-1 updates,
+ * and the trailing matrix is updated with mat_mul_blocked().
+ * 
+ * @return (bool) false if A is singular, 
+ * in which case the factorization is completed but U has a zero diagonal element.
+ */
+template <class FloatT>
+bool mat_lu_blocked(
+    const int n,
+    FloatT *a, const int a_rs, const int a_cs,
+    unsigned int *pivot){
+  bool regular(true);
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  for(int j0(0); j0 < n; j0 += nb){
+    int jb(((n - j0) < nb) ? (n - j0) : nb);
+    
+    // panel factorization, A[j0:n, j0:j0+jb]
+    for(int j(j0); j < j0 + jb; j++){
+      int p(j);
+      FloatT p_abs(0);
+      for(int i(j); i < n; i++){
+        FloatT v(a[i * a_rs + j * a_cs]);
+        if(v < FloatT(0)){v = -v;}
+        if(v > p_abs){p = i; p_abs = v;}
+      }
+      pivot[j] = p;
+      if(p_abs == FloatT(0)){
+        regular = false;
+        continue;
+      }
+      if(p != j){ // whole rows are exchanged
+        FloatT *a_j(a + j * a_rs), *a_p(a + p * a_rs);
+        for(int k(0); k < n; k++){
+          FloatT temp(a_j[k * a_cs]);
+          a_j[k * a_cs] = a_p[k * a_cs];
+          a_p[k * a_cs] = temp;
+        }
+      }
+      const FloatT *a_j(a + j * a_rs);
+      const FloatT a_jj(a_j[j * a_cs]);
+      for(int i(j + 1); i < n; i++){
+        FloatT *a_i(a + i * a_rs);
+        FloatT l_ij(a_i[j * a_cs] /= a_jj);
+        if(l_ij == FloatT(0)){continue;}
+        for(int k(j + 1); k < j0 + jb; k++){a_i[k * a_cs] -= l_ij * a_j[k * a_cs];}
+      }
+    }
+    
+    if(j0 + jb >= n){break;}
+    
+    // U12 = L11^{-1} * A12
+    mat_trsm_left(jb, n - j0 - jb,
+        a + j0 * (a_rs + a_cs), a_rs, a_cs,
+        true, true,
+        a + j0 * a_rs + (j0 + jb) * a_cs, a_rs, a_cs);
+    
+    // A22 -= L21 * U12
+    mat_mul_blocked(n - j0 - jb, jb, n - j0 - jb,
+        FloatT(-1),
+        a + (j0 + jb) * a_rs + j0 * a_cs, a_rs, a_cs,
+        a + j0 * a_rs + (j0 + jb) * a_cs, a_rs, a_cs,
+        FloatT(1),
+        a + (j0 + jb) * (a_rs + a_cs), a_rs, a_cs);
+  }
+  return regular;
+}
+
+/**
+ * Blocked Cholesky decomposition in place, A = L * L^{T},
+ * where A is n x n symmetric positive definite (a[i * a_rs + j * a_cs] is A(i, j)).
+ * Only the lower part of A is referred, and it is overwritten by L;
+ * the strictly upper part is left untouched.
+ * The left-looking algorithm is used, i.e., each block column is updated
+ * with the already factorized columns by mat_mul_blocked(), then its diagonal block
+ * is factorized directly, and finally the rest is solved by mat_trsm_left().
+ * 
+ * @return (bool) false if A is not positive definite
+ */
+template <class FloatT>
+bool mat_cholesky_blocked(
+    const int n,
+    FloatT *a, const int a_rs, const int a_cs){
+  using std::sqrt;
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  FloatT *temp(new FloatT[nb * nb]);
+  bool positive(true);
+  for(int j0(0); j0 < n; j0 += nb){
+    int jb(((n - j0) < nb) ? (n - j0) : nb);
+    FloatT *a11(a + j0 * (a_rs + a_cs)), *a21(a11 + jb * a_rs);
+    const FloatT *l10(a + j0 * a_rs), *l20(l10 + jb * a_rs);
+    if(j0 > 0){
+      // A11 -= L10 * L10^{T} (lower part only, via temporary)
+      mat_mul_blocked(jb, j0, jb,
+          FloatT(1),
+          l10, a_rs, a_cs,
+          l10, a_cs, a_rs,
+          FloatT(0),
+          temp, jb, 1);
+      for(int i(0); i < jb; i++){
+        for(int j(0); j <= i; j++){a11[i * a_rs + j * a_cs] -= temp[i * jb + j];}
+      }
+      // A21 -= L20 * L10^{T}
+      mat_mul_blocked(n - j0 - jb, j0, jb,
+          FloatT(-1),
+          l20, a_rs, a_cs,
+          l10, a_cs, a_rs,
+          FloatT(1),
+          a21, a_rs, a_cs);
+    }
+    // A11 = L11 * L11^{T}
+    for(int j(0); j < jb; j++){
+      FloatT *l_j(a11 + j * a_rs);
+      FloatT d(l_j[j * a_cs]);
+      for(int k(0); k < j; k++){d -= l_j[k * a_cs] * l_j[k * a_cs];}
+      if(!(d > FloatT(0))){
+        positive = false;
+        break;
+      }
+      d = (l_j[j * a_cs] = sqrt(d));
+      for(int i(j + 1); i < jb; i++){
+        FloatT *l_i(a11 + i * a_rs);
+        FloatT v(l_i[j * a_cs]);
+        for(int k(0); k < j; k++){v -= l_i[k * a_cs] * l_j[k * a_cs];}
+        l_i[j * a_cs] = v / d;
+      }
+    }
+    if(!positive){break;}
+    // L21 = A21 * L11^{-T}, i.e., L11 * L21^{T} = A21^{T}
+    mat_trsm_left(jb, n - j0 - jb,
+        a11, a_rs, a_cs,
+        true, false,
+        a21, a_cs, a_rs);
+  }
+  delete [] temp;
+  return positive;
+}
+
+/**
+ * Blocked LDL^{T} decomposition in place, A = L * D * L^{T} (without pivoting),
+ * where A is n x n symmetric (a[i * a_rs + j * a_cs] is A(i, j)),
+ * L is unit lower triangular, and D is diagonal.
+ * Only the lower part of A is referred; its strictly lower part is overwritten by L,
+ * and its diagonal by D. The strictly upper part is left untouched.
+ * The algorithm is the same as mat_cholesky_blocked() except for the scaling by D,
+ * and requires no square root, therefore works for positive semi-definite
+ * or quasi-definite matrices as long as no zero pivot appears.
+ * 
+ * @return (bool) false if a zero pivot appears
+ */
+template <class FloatT>
+bool mat_ldl_blocked(
+    const int n,
+    FloatT *a, const int a_rs, const int a_cs){
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  FloatT *temp(new FloatT[nb * nb + nb * n]);
+  FloatT *w(temp + nb * nb); // D * L10^{T}
+  bool regular(true);
+  for(int j0(0); j0 < n; j0 += nb){
+    int jb(((n - j0) < nb) ? (n - j0) : nb);
+    FloatT *a11(a + j0 * (a_rs + a_cs)), *a21(a11 + jb * a_rs);
+    const FloatT *l10(a + j0 * a_rs), *l20(l10 + jb * a_rs);
+    if(j0 > 0){
+      // W = D0 * L10^{T} (j0 x jb)
+      for(int k(0); k < j0; k++){
+        const FloatT d_k(a[k * (a_rs + a_cs)]);
+        for(int j(0); j < jb; j++){w[k * jb + j] = d_k * l10[j * a_rs + k * a_cs];}
+      }
+      // A11 -= L10 * W (lower part only, via temporary)
+      mat_mul_blocked(jb, j0, jb,
+          FloatT(1),
+          l10, a_rs, a_cs,
+          w, jb, 1,
+          FloatT(0),
+          temp, jb, 1);
+      for(int i(0); i < jb; i++){
+        for(int j(0); j <= i; j++){a11[i * a_rs + j * a_cs] -= temp[i * jb + j];}
+      }
+      // A21 -= L20 * W
+      mat_mul_blocked(n - j0 - jb, j0, jb,
+          FloatT(-1),
+          l20, a_rs, a_cs,
+          w, jb, 1,
+          FloatT(1),
+          a21, a_rs, a_cs);
+    }
+    // A11 = L11 * D1 * L11^{T}
+    for(int j(0); j < jb; j++){
+      FloatT *l_j(a11 + j * a_rs);
+      FloatT d(l_j[j * a_cs]);
+      for(int k(0); k < j; k++){
+        d -= l_j[k * a_cs] * l_j[k * a_cs] * a11[k * (a_rs + a_cs)];
+      }
+      if(d == FloatT(0)){
+        regular = false;
+        break;
+      }
+      l_j[j * a_cs] = d;
+      for(int i(j + 1); i < jb; i++){
+        FloatT *l_i(a11 + i * a_rs);
+        FloatT v(l_i[j * a_cs]);
+        for(int k(0); k < j; k++){
+          v -= l_i[k * a_cs] * l_j[k * a_cs] * a11[k * (a_rs + a_cs)];
+        }
+        l_i[j * a_cs] = v / d;
+      }
+    }
+    if(!regular){break;}
+    // L21 * D1 = A21 * L11^{-T}, then L21 = (L21 * D1) * D1^{-1}
+    mat_trsm_left(jb, n - j0 - jb,
+        a11, a_rs, a_cs,
+        true, true,
+        a21, a_cs, a_rs);
+    for(int j(0); j < jb; j++){
+      const FloatT d_j(a11[j * (a_rs + a_cs)]);
+      for(int i(0); i < n - j0 - jb; i++){a21[i * a_rs + j * a_cs] /= d_j;}
+    }
+  }
+  delete [] temp;
+  return regular;
+}
+
+/*
+ * Kernels for orthogonal factorizations
+ * 
+ * Householder QR decomposition uses the compact WY representation 
+ * (Schreiber and Van Loan), i.e., the product of the reflectors of a block,
+ * H_0 * H_1 * ... * H_{k-1}, is expressed as I - V * T * V^{T}, 
+ * where V is unit lower trapezoidal and T is upper triangular, 
+ * so that the trailing matrix is updated with mat_mul_blocked().
+ */
+
+/**
+ * Householder reflector H = I - tau * v * v^{T}, which maps x (n elements, x[i * x_s]) 
+ * to (beta, 0, ..., 0)^{T}. x[0] is overwritten by beta, and x[1:n] by v[1:n], 
+ * whose first element v[0] = 1 is omitted (same as LAPACK larfg).
+ * 
+ * @return (FloatT) tau, which is zero if x[1:n] is already zero (H = I)
+ */
+template <class FloatT>
+FloatT mat_householder(const int n, FloatT *x, const int x_s){
+  using std::sqrt;
+  if(n <= 1){return FloatT(0);}
+  FloatT norm2(0);
+  for(int i(1); i < n; i++){norm2 += x[i * x_s] * x[i * x_s];}
+  if(norm2 == FloatT(0)){return FloatT(0);}
+  const FloatT alpha(x[0]);
+  FloatT beta(sqrt(alpha * alpha + norm2));
+  if(alpha >= FloatT(0)){beta = -beta;}
+  const FloatT scale(FloatT(1) / (alpha - beta));
+  for(int i(1); i < n; i++){x[i * x_s] *= scale;}
+  x[0] = beta;
+  return (beta - alpha) / beta;
+}
+
+/**
+ * Householder reflector application C = H * C = C - tau * v * (v^{T} * C),
+ * where v (m elements, v[i * v_s]) is given by mat_householder() 
+ * with its first element one omitted, and C is m x n (c[i * c_rs + j * c_cs]).
+ * 
+ * @param w workspace of n elements
+ */
+template <class FloatT>
+void mat_householder_apply(
+    const int m, const int n,
+    const FloatT *v, const int v_s, const FloatT &tau,
+    FloatT *c, const int c_rs, const int c_cs,
+    FloatT *w){
+  if((tau == FloatT(0)) || (n <= 0)){return;}
+  if(n < 4){ // column by column
+    for(int j(0); j < n; j++){
+      FloatT *c_j(c + j * c_cs);
+      FloatT sum(c_j[0]);
+      for(int i(1); i < m; i++){sum += v[i * v_s] * c_j[i * c_rs];}
+      sum *= tau;
+      c_j[0] -= sum;
+      for(int i(1); i < m; i++){c_j[i * c_rs] -= sum * v[i * v_s];}
+    }
+    return;
+  }
+  for(int j(0); j < n; j++){w[j] = c[j * c_cs];}
+  for(int i(1); i < m; i++){
+    const FloatT v_i(v[i * v_s]);
+    if(v_i == FloatT(0)){continue;}
+    const FloatT *c_i(c + i * c_rs);
+    for(int j(0); j < n; j++){w[j] += v_i * c_i[j * c_cs];}
+  }
+  for(int j(0); j < n; j++){c[j * c_cs] -= (w[j] *= tau);}
+  for(int i(1); i < m; i++){
+    const FloatT v_i(v[i * v_s]);
+    if(v_i == FloatT(0)){continue;}
+    FloatT *c_i(c + i * c_rs);
+    for(int j(0); j < n; j++){c_i[j * c_cs] -= v_i * w[j];}
+  }
+}
+
+/**
+ * Compact WY representation of the k reflectors stored by mat_qr_blocked() 
+ * in A (m x k, a[i * a_rs + j * a_cs]) and tau. 
+ * V (m x k, v[i * k + j]) is expanded with its unit diagonal and zeros, 
+ * and T (k x k, t[i * k + j]) is formed (same as LAPACK larft).
+ */
+template <class FloatT>
+void mat_qr_wy(
+    const int m, const int k,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT *tau, FloatT *v, FloatT *t){
+  for(int i(0); i < m; i++){
+    for(int j(0); j < k; j++){
+      v[i * k + j] = (i > j) 
+          ? a[i * a_rs + j * a_cs] 
+          : ((i == j) ? FloatT(1) : FloatT(0));
+    }
+  }
+  for(int j(0); j < k; j++){
+    // T[0:j, j] = -tau[j] * T[0:j, 0:j] * V[:, 0:j]^{T} * v_j
+    for(int i(0); i < j; i++){
+      FloatT sum(0);
+      for(int l(j); l < m; l++){sum += v[l * k + i] * v[l * k + j];}
+      t[i * k + j] = -tau[j] * sum;
+    }
+    for(int i(0); i < j; i++){
+      FloatT sum(0);
+      for(int l(i); l < j; l++){sum += t[i * k + l] * t[l * k + j];}
+      t[i * k + j] = sum;
+    }
+    t[j * k + j] = tau[j];
+    for(int i(j + 1); i < k; i++){t[i * k + j] = FloatT(0);}
+  }
+}
+
+/**
+ * Block reflector application C = (I - V * op(T) * V^{T}) * C, 
+ * where V and T are given by mat_qr_wy(), op(T) is T^{T} if trans is true 
+ * (i.e., the transposed block of Q is applied), otherwise T,
+ * and C is m x n (c[i * c_rs + j * c_cs]).
+ * 
+ * @param w workspace of k * n elements
+ */
+template <class FloatT>
+void mat_qr_apply_wy(
+    const int m, const int n, const int k,
+    const FloatT *v, const FloatT *t, const bool trans,
+    FloatT *c, const int c_rs, const int c_cs,
+    FloatT *w){
+  if((m <= 0) || (n <= 0) || (k <= 0)){return;}
+  // W = V^{T} * C
+  mat_mul_blocked(k, m, n,
+      FloatT(1),
+      v, 1, k,
+      c, c_rs, c_cs,
+      FloatT(0),
+      w, n, 1);
+  // W = op(T) * W, whose rows are updated in the order not to overwrite the referred ones
+  for(int ii(0); ii < k; ii++){
+    const int i(trans ? (k - 1 - ii) : ii);
+    FloatT *w_i(w + i * n);
+    const FloatT t_ii(t[i * k + i]);
+    for(int j(0); j < n; j++){w_i[j] *= t_ii;}
+    for(int l(trans ? 0 : (i + 1)); l < (trans ? i : k); l++){
+      const FloatT t_il(trans ? t[l * k + i] : t[i * k + l]);
+      if(t_il == FloatT(0)){continue;}
+      const FloatT *w_l(w + l * n);
+      for(int j(0); j < n; j++){w_i[j] += t_il * w_l[j];}
+    }
+  }
+  // C -= V * W
+  mat_mul_blocked(m, k, n,
+      FloatT(-1),
+      v, k, 1,
+      w, n, 1,
+      FloatT(1),
+      c, c_rs, c_cs);
+}
+
+/**
+ * Blocked Householder QR decomposition in place, A = Q * R,
+ * where A is m x n (a[i * a_rs + j * a_cs] is A(i, j)).
+ * The upper trapezoid of A is overwritten by R, and the part below the diagonal 
+ * by the Householder vectors v_j, i.e., Q = H_0 * H_1 * ... * H_{k-1},
+ * H_j = I - tau[j] * v_j * v_j^{T}, k = min(m, n) (same as LAPACK geqrf).
+ * The panel of each block column is factorized by the reflectors one by one,
+ * and the trailing matrix is updated with the block reflector (see mat_qr_apply_wy()).
+ * 
+ * @param tau scalar factors of the reflectors, whose length must be min(m, n)
+ */
+template <class FloatT>
+void mat_qr_blocked(
+    const int m, const int n,
+    FloatT *a, const int a_rs, const int a_cs,
+    FloatT *tau){
+  const int k((m < n) ? m : n), nb(MATRIX_FACTORIZATION_BLOCK);
+  if(k <= 0){return;}
+  FloatT *v(NULL), *t(NULL), *w(new FloatT[nb * n]);
+  for(int j0(0); j0 < k; j0 += nb){
+    const int jb(((k - j0) < nb) ? (k - j0) : nb);
+    
+    // panel factorization, A[j0:m, j0:j0+jb]
+    for(int j(j0); j < j0 + jb; j++){
+      FloatT *v_j(a + j * (a_rs + a_cs));
+      tau[j] = mat_householder(m - j, v_j, a_rs);
+      mat_householder_apply(m - j, j0 + jb - j - 1, 
+          v_j, a_rs, tau[j], 
+          v_j + a_cs, a_rs, a_cs, w);
+    }
+    
+    if(j0 + jb >= n){break;}
+    
+    // A[j0:m, j0+jb:n] = (I - V * T^{T} * V^{T}) * A[j0:m, j0+jb:n]
+    if(!v){
+      v = new FloatT[m * nb];
+      t = new FloatT[nb * nb];
+    }
+    mat_qr_wy(m - j0, jb, a + j0 * (a_rs + a_cs), a_rs, a_cs, tau + j0, v, t);
+    mat_qr_apply_wy(m - j0, n - j0 - jb, jb, v, t, true, 
+        a + j0 * a_rs + (j0 + jb) * a_cs, a_rs, a_cs, w);
+  }
+  delete [] v;
+  delete [] t;
+  delete [] w;
+}
+
+/**
+ * Multiplication by Q of mat_qr_blocked() in place, C = Q^{T} * C if trans is true,
+ * otherwise C = Q * C, where the k reflectors of Q are stored 
+ * in A (m x k, a[i * a_rs + j * a_cs]) and tau, and C is m x n (c[i * c_rs + j * c_cs]).
+ * The blocks of the reflectors are applied in the compact WY representation,
+ * unless they fit in a single block, which is applied by the reflectors one by one.
+ */
+template <class FloatT>
+void mat_qr_multiply(
+    const int m, const int k, const int n,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT *tau, const bool trans,
+    FloatT *c, const int c_rs, const int c_cs){
+  if((k <= 0) || (n <= 0)){return;}
+  const int nb(MATRIX_FACTORIZATION_BLOCK), blocks((k + nb - 1) / nb);
+  if(blocks == 1){ // by the reflectors one by one
+    FloatT *w(new FloatT[n]);
+    for(int jj(0); jj < k; jj++){
+      const int j(trans ? jj : (k - 1 - jj));
+      mat_householder_apply(m - j, n, 
+          a + j * (a_rs + a_cs), a_rs, tau[j], 
+          c + j * c_rs, c_rs, c_cs, w);
+    }
+    delete [] w;
+    return;
+  }
+  FloatT *v(new FloatT[m * nb]), *t(new FloatT[nb * nb]), *w(new FloatT[nb * n]);
+  for(int b(0); b < blocks; b++){
+    // Q^{T} = H_{k-1} * ... * H_0, therefore the first block is applied first
+    const int j0((trans ? b : (blocks - 1 - b)) * nb);
+    const int jb(((k - j0) < nb) ? (k - j0) : nb);
+    mat_qr_wy(m - j0, jb, a + j0 * (a_rs + a_cs), a_rs, a_cs, tau + j0, v, t);
+    mat_qr_apply_wy(m - j0, n, jb, v, t, trans, c + j0 * c_rs, c_rs, c_cs, w);
+  }
+  delete [] v;
+  delete [] t;
+  delete [] w;
+}
+
+/*
+ * Kernels for symmetric eigenproblems
+ * 
+ * A symmetric matrix is reduced to tridiagonal form by Householder reflectors,
+ * whose product is formed with mat_qr_multiply(), and then the eigenvalues 
+ * of the tridiagonal matrix are found by the implicit QL method with shifts, 
+ * whose rotations are accumulated only when the eigenvectors are required.
+ */
+
+/**
+ * Householder tridiagonalization in place, Q^{T} * A * Q = T,
+ * where A is n x n symmetric (a[i * a_rs + j * a_cs] is A(i, j)) 
+ * whose both triangles are stored.
+ * The diagonal of T is stored in d (n elements), and the subdiagonal in e 
+ * (n - 1 elements). The reflectors H_j (0 <= j < n - 1), Q = H_0 * H_1 * ... * H_{n-2},
+ * are stored below the subdiagonal of A and in tau (n - 1 elements), in the same form 
+ * as mat_qr_blocked() of A[1:n, 0:n-1] (same as LAPACK sytrd with lower).
+ * The trailing matrix is updated with the symmetric rank-2 updates, 
+ * whose matrix-vector products are calculated by mat_gemv_serial().
+ */
+template <class FloatT>
+void mat_tridiagonalize(
+    const int n,
+    FloatT *a, const int a_rs, const int a_cs,
+    FloatT *d, FloatT *e, FloatT *tau){
+  if(n <= 0){return;}
+  FloatT *u(new FloatT[n * 2]), *w(u + n);
+  for(int j(0); j < n - 1; j++){
+    const int m(n - j - 1);
+    FloatT *v(a + (j + 1) * a_rs + j * a_cs);
+    d[j] = a[j * (a_rs + a_cs)];
+    const FloatT tau_j(tau[j] = mat_householder(m, v, a_rs));
+    e[j] = v[0];
+    if(tau_j == FloatT(0)){continue;}
+    u[0] = FloatT(1);
+    for(int i(1); i < m; i++){u[i] = v[i * a_rs];}
+    FloatT *a22(a + (j + 1) * (a_rs + a_cs));
+    // w = tau * A22 * u, then w -= (tau / 2) * (w^{T} * u) * u
+    mat_gemv_serial(m, m, tau_j, (const FloatT *)a22, a_rs, a_cs, (const FloatT *)u, 1, FloatT(0), w, 1);
+    FloatT alpha(0);
+    for(int i(0); i < m; i++){alpha += w[i] * u[i];}
+    alpha *= -tau_j / 2;
+    for(int i(0); i < m; i++){w[i] += alpha * u[i];}
+    // A22 -= u * w^{T} + w * u^{T}
+    for(int i(0); i < m; i++){
+      FloatT *a_i(a22 + i * a_rs);
+      const FloatT u_i(u[i]), w_i(w[i]);
+      if(a_cs == 1){
+        for(int k(0); k < m; k++){a_i[k] -= u_i * w[k] + w_i * u[k];}
+      }else{
+        for(int k(0); k < m; k++){a_i[k * a_cs] -= u_i * w[k] + w_i * u[k];}
+      }
+    }
+  }
+  d[n - 1] = a[(n - 1) * (a_rs + a_cs)];
+  delete [] u;
+}
+
+/**
+ * sqrt(a^2 + b^2) without destructive overflow or underflow.
+ */
+template <class FloatT>
+FloatT mat_pythag(const FloatT &a, const FloatT &b){
+  using std::sqrt;
+  const FloatT a_abs((a < FloatT(0)) ? -a : a), b_abs((b < FloatT(0)) ? -b : b);
+  if(a_abs > b_abs){
+    const FloatT r(b_abs / a_abs);
+    return a_abs * sqrt(FloatT(1) + r * r);
+  }else if(b_abs == FloatT(0)){
+    return FloatT(0);
+  }else{
+    const FloatT r(a_abs / b_abs);
+    return b_abs * sqrt(FloatT(1) + r * r);
+  }
+}
+
+/**
+ * Eigenvalues of symmetric tridiagonal matrix by the implicit QL method 
+ * with Wilkinson's shifts (same as EISPACK tql2), 
+ * where the diagonal is d (n elements), and the subdiagonal is e (n elements, 
+ * whose last one is workspace). The eigenvalues overwrite d in ascending order,
+ * and e is destroyed.
+ * If z is not NULL, the rotations are accumulated to the columns of 
+ * Z (n x n, z[i * z_rs + j * z_cs]), which is the identity 
+ * or Q of the tridiagonalization, so that its column j becomes the eigenvector 
+ * corresponding to d[j]; otherwise the eigenvalues are found in O(n^2).
+ * 
+ * @return (bool) false if an eigenvalue does not converge in 30 iterations
+ */
+template <class FloatT>
+bool mat_tridiagonal_ql(
+    const int n, FloatT *d, FloatT *e,
+    FloatT *z, const int z_rs, const int z_cs){
+  if(n <= 0){return true;}
+  e[n - 1] = FloatT(0);
+  for(int l(0); l < n; l++){
+    for(int iter(0); ; iter++){
+      // small subdiagonal element, which splits the matrix
+      int m(l);
+      for(; m < n - 1; m++){
+        const FloatT dd(((d[m] < FloatT(0)) ? -d[m] : d[m]) 
+            + ((d[m + 1] < FloatT(0)) ? -d[m + 1] : d[m + 1]));
+        const FloatT e_abs((e[m] < FloatT(0)) ? -e[m] : e[m]);
+        if(e_abs + dd == dd){break;}
+      }
+      if(m == l){break;}
+      if(iter == 30){return false;}
+      FloatT g((d[l + 1] - d[l]) / (e[l] * 2)), r(mat_pythag(g, FloatT(1)));
+      g = d[m] - d[l] + e[l] / (g + ((g < FloatT(0)) ? -r : r));
+      FloatT s(1), c(1), p(0);
+      int i(m - 1);
+      for(; i >= l; i--){
+        FloatT f(s * e[i]);
+        const FloatT b(c * e[i]);
+        e[i + 1] = (r = mat_pythag(f, g));
+        if(r == FloatT(0)){ // underflow
+          d[i + 1] -= p;
+          e[m] = FloatT(0);
+          break;
+        }
+        s = f / r;
+        c = g / r;
+        g = d[i + 1] - p;
+        r = (d[i] - g) * s + c * b * 2;
+        d[i + 1] = g + (p = s * r);
+        g = c * r - b;
+        if(z){
+          FloatT *z_i(z + i * z_cs), *z_i1(z_i + z_cs);
+          if(z_rs == 1){
+            for(int k(0); k < n; k++){
+              const FloatT z_ki(z_i[k]), z_ki1(z_i1[k]);
+              z_i1[k] = s * z_ki + c * z_ki1;
+              z_i[k] = c * z_ki - s * z_ki1;
+            }
+          }else{
+            for(int k(0); k < n; k++){
+              f = z_i1[k * z_rs];
+              z_i1[k * z_rs] = s * z_i[k * z_rs] + c * f;
+              z_i[k * z_rs] = c * z_i[k * z_rs] - s * f;
+            }
+          }
+        }
+      }
+      if((r == FloatT(0)) && (i >= l)){continue;}
+      d[l] -= p;
+      e[l] = g;
+      e[m] = FloatT(0);
+    }
+  }
+  // ascending order
+  for(int i(0); i < n - 1; i++){
+    int k(i);
+    for(int j(i + 1); j < n; j++){
+      if(d[j] < d[k]){k = j;}
+    }
+    if(k == i){continue;}
+    FloatT temp(d[i]);
+    d[i] = d[k];
+    d[k] = temp;
+    if(z){
+      FloatT *z_i(z + i * z_cs), *z_k(z + k * z_cs);
+      for(int j(0); j < n; j++){
+        temp = z_i[j * z_rs];
+        z_i[j * z_rs] = z_k[j * z_rs];
+        z_k[j * z_rs] = temp;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Kernels for symmetric packed storage
+ * 
+ * A symmetric matrix is specified by its packed buffer (see mat_packed_offset()).
+ * The matrix-vector product reads each packed element only once,
+ * while the level-3 operations unpack (or produce) a panel of rows at a time 
+ * and delegate it to mat_mul_blocked(), so that they run at the speed of
+ * the multiplication engine; SYRK calculates only the upper triangle, 
+ * which halves its multiply-adds.
+ */
+
+/**
+ * Symmetric matrix-vector multiplication y = alpha * A * x + beta * y (SPMV),
+ * where A is n x n symmetric packed, x is n (x[i * x_s]), and y is n (y[i * y_s]).
+ * Each packed row i is used twice, as the row i for y[i] by the dot form kernel,
+ * and as the column i for the following elements of y by the axpy form kernel.
+ * If beta is zero, y is not read.
+ */
+template <class FloatT>
+void mat_spmv(
+    const int n, const FloatT &alpha, const FloatT *ap,
+    const FloatT *x, const int x_s,
+    const FloatT &beta,
+    FloatT *y, const int y_s){
+  if(n <= 0){return;}
+#if __cplusplus >= 201103L
+  static thread_local mat_mul_workspace_t<FloatT> workspace;
+#else
+  mat_mul_workspace_t<FloatT> workspace;
+#endif
+  FloatT *x_unit(workspace.get(n * 2)), *y_unit(x_unit + n);
+  for(int i(0); i < n; i++){
+    x_unit[i] = x[i * x_s];
+    y_unit[i] = FloatT(0);
+  }
+  const mat_gemv_kernel_t<FloatT> &k_info(mat_gemv_kernel_t<FloatT>::get());
+  for(int i(0); i < n; i++){
+    const FloatT *a_i(ap + mat_packed_offset(n, i));
+    k_info.dot(1, n - i, alpha, a_i + i, 0, x_unit + i, y_unit + i, 1);
+    if(i + 1 < n){
+      k_info.axpy(n - i - 1, 1, alpha, a_i + i + 1, 0, x_unit + i, 1, y_unit + i + 1);
+    }
+  }
+  for(int i(0); i < n; i++){
+    y[i * y_s] = (beta == FloatT(0)) ? y_unit[i] : (y_unit[i] + beta * y[i * y_s]);
+  }
+}
+
+/**
+ * Symmetric matrix multiplication C = alpha * A * B + beta * C (SYMM),
+ * where A is n x n symmetric packed, B is n x m (b[i * b_rs + j * b_cs]),
+ * and C is n x m (c[i * c_rs + j * c_cs]).
+ * If beta is zero, C is not read.
+ */
+template <class FloatT>
+void mat_symm_packed(
+    const int n, const int m,
+    const FloatT &alpha, const FloatT *ap,
+    const FloatT *b, const int b_rs, const int b_cs,
+    const FloatT &beta,
+    FloatT *c, const int c_rs, const int c_cs){
+  if((n <= 0) || (m <= 0)){return;}
+  if(m == 1){
+    mat_spmv(n, alpha, ap, b, b_rs, beta, c, c_rs);
+    return;
+  }
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  FloatT *panel(new FloatT[nb * n]);
+  for(int i0(0); i0 < n; i0 += nb){
+    const int ib((n - i0 < nb) ? (n - i0) : nb);
+    // A(i, j) (j < i) from the packed row j, whose elements are contiguous on i
+    for(int j(0); j < i0 + ib - 1; j++){
+      const FloatT *a_j(ap + mat_packed_offset(n, j));
+      for(int i((j < i0) ? i0 : (j + 1)); i < i0 + ib; i++){
+        panel[(i - i0) * n + j] = a_j[i];
+      }
+    }
+    // A(i, j) (j >= i) from the packed row i
+    for(int i(i0); i < i0 + ib; i++){
+      const FloatT *a_i(ap + mat_packed_offset(n, i));
+      FloatT *p_i(panel + (i - i0) * n);
+      for(int j(i); j < n; j++){p_i[j] = a_i[j];}
+    }
+    mat_mul_blocked(ib, n, m, 
+        alpha, 
+        panel, n, 1, 
+        b, b_rs, b_cs, 
+        beta, 
+        c + i0 * c_rs, c_rs, c_cs);
+  }
+  delete [] panel;
+}
+
+/**
+ * Symmetric rank-k update C = alpha * A * A^{T} + beta * C (SYRK),
+ * where A is n x k (a[i * a_rs + j * a_cs]), and C is n x n symmetric packed.
+ * Each panel of rows of C is multiplied from its diagonal block.
+ * If beta is zero, C is not read.
+ */
+template <class FloatT>
+void mat_syrk_packed(
+    const int n, const int k,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT &beta, FloatT *cp){
+  if(n <= 0){return;}
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  FloatT *temp(new FloatT[nb * n]);
+  for(int i0(0); i0 < n; i0 += nb){
+    const int ib((n - i0 < nb) ? (n - i0) : nb), w(n - i0);
+    mat_mul_blocked(ib, k, w, 
+        alpha, 
+        a + i0 * a_rs, a_rs, a_cs, 
+        a + i0 * a_rs, a_cs, a_rs, 
+        FloatT(0), 
+        temp, w, 1);
+    for(int i(i0); i < i0 + ib; i++){
+      FloatT *c_i(cp + mat_packed_offset(n, i));
+      const FloatT *t_i(temp + (i - i0) * w - i0);
+      if(beta == FloatT(0)){
+        for(int j(i); j < n; j++){c_i[j] = t_i[j];}
+      }else{
+        for(int j(i); j < n; j++){c_i[j] = t_i[j] + beta * c_i[j];}
+      }
+    }
+  }
+  delete [] temp;
+}
+
+/**
+ * Symmetric rank-k update C = alpha * A * A^{T} + beta * C (SYRK)
+ * into n x n dense C (c[i * c_rs + j * c_cs]), see mat_syrk_packed() for the others.
+ * The upper triangle is calculated, and then is transposed to the lower one.
+ */
+template <class FloatT>
+void mat_syrk(
+    const int n, const int k,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs,
+    const FloatT &beta, 
+    FloatT *c, const int c_rs, const int c_cs){
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  for(int i0(0); i0 < n; i0 += nb){
+    const int ib((n - i0 < nb) ? (n - i0) : nb);
+    FloatT *c_ii(c + i0 * (c_rs + c_cs));
+    mat_mul_blocked(ib, k, n - i0, 
+        alpha, 
+        a + i0 * a_rs, a_rs, a_cs, 
+        a + i0 * a_rs, a_cs, a_rs, 
+        beta, 
+        c_ii, c_rs, c_cs);
+    for(int i(1); i < ib; i++){
+      for(int j(0); j < i; j++){c_ii[i * c_rs + j * c_cs] = c_ii[j * c_rs + i * c_cs];}
+    }
+    mat_copy(n - i0 - ib, ib, 
+        c_ii + ib * c_cs, c_cs, c_rs, 
+        c_ii + ib * c_rs, c_rs, c_cs);
+  }
+}
+
+/*
+ * Kernels for sparse storage
+ * 
+ * A sparse matrix is specified by its arrays compressed by rows (CSR),
+ * i.e., the nonzero elements of row i are values[offsets[i]], ..., 
+ * values[offsets[i + 1] - 1] whose column indices are indices[offsets[i]], ...
+ * (offsets[0] is zero). One compressed by columns (CSC) is the transpose of CSR 
+ * with the same arrays, therefore the products with both the compressed matrix 
+ * and its transpose are provided.
+ * Only the nonzero elements are multiplied; the dense operand is read 
+ * by rows selected by the indices, which is cache friendly when it is row-major.
+ */
+
+/*
+ * Minimum number of multiply-adds (nonzeros * columns of the dense operand) 
+ * for the parallel sparse multiplication.
+ */
+#ifndef MATRIX_SPARSE_PARALLEL_THRESHOLD
+#define MATRIX_SPARSE_PARALLEL_THRESHOLD (256 * 1024)
+#endif
+
+/**
+ * Sparse matrix multiplication C = alpha * A * B + beta * C (SPMM),
+ * where A is m x k compressed by rows, B is k x n (b[i * b_rs + j * b_cs]),
+ * and C is m x n (c[i * c_rs + j * c_cs]).
+ * Each row of C is accumulated from the rows of B selected by the row of A
+ * with the axpy form kernel of mat_gemv_kernel_t;
+ * for a vector B (n == 1), it is the matrix-vector product (SPMV) in the dot form.
+ * If beta is zero, C is not read.
+ * This function runs on the caller thread; see mat_sparse_mm() for parallel one.
+ */
+template <class FloatT>
+void mat_sparse_mm_serial(
+    const int m, const int n,
+    const FloatT &alpha,
+    const int *offsets, const int *indices, const FloatT *values,
+    const FloatT *b, const int b_rs, const int b_cs,
+    const FloatT &beta,
+    FloatT *c, const int c_rs, const int c_cs){
+  const mat_gemv_kernel_t<FloatT> &k_info(mat_gemv_kernel_t<FloatT>::get());
+  for(int i(0); i < m; i++){
+    FloatT *c_i(c + i * c_rs);
+    if(beta == FloatT(0)){
+      for(int j(0); j < n; j++){c_i[j * c_cs] = FloatT(0);}
+    }else if(beta != FloatT(1)){
+      for(int j(0); j < n; j++){c_i[j * c_cs] *= beta;}
+    }
+    const int k0(offsets[i]), k1(offsets[i + 1]);
+    if((b_cs == 1) && (c_cs == 1) && (n > 1)){
+      for(int k(k0); k < k1; k++){
+        k_info.axpy(n, 1, alpha, b + indices[k] * b_rs, 0, values + k, 1, c_i);
+      }
+    }else{
+      for(int j(0); j < n; j++){
+        const FloatT *b_j(b + j * b_cs);
+        FloatT sum(0);
+        for(int k(k0); k < k1; k++){sum += values[k] * b_j[indices[k] * b_rs];}
+        c_i[j * c_cs] += alpha * sum;
+      }
+    }
+  }
+}
+
+/**
+ * Sparse matrix multiplication with the transpose, C = alpha * A^{T} * B + beta * C,
+ * where A is m x k compressed by rows, B is m x n, and C is k x n,
+ * which is also the product of a matrix compressed by columns.
+ * Each row of B is scattered to the rows of C selected by the row of A
+ * with the axpy form kernel of mat_gemv_kernel_t.
+ * If beta is zero, C is not read.
+ */
+template <class FloatT>
+void mat_sparse_tmm_serial(
+    const int m, const int k, const int n,
+    const FloatT &alpha,
+    const int *offsets, const int *indices, const FloatT *values,
+    const FloatT *b, const int b_rs, const int b_cs,
+    const FloatT &beta,
+    FloatT *c, const int c_rs, const int c_cs){
+  if(beta == FloatT(0)){
+    for(int i(0); i < k; i++){
+      for(int j(0); j < n; j++){c[i * c_rs + j * c_cs] = FloatT(0);}
+    }
+  }else if(beta != FloatT(1)){
+    mat_scale(k, n, beta, c, c_rs, c_cs);
+  }
+  const mat_gemv_kernel_t<FloatT> &k_info(mat_gemv_kernel_t<FloatT>::get());
+  for(int i(0); i < m; i++){
+    const FloatT *b_i(b + i * b_rs);
+    for(int p(offsets[i]); p < offsets[i + 1]; p++){
+      FloatT *c_j(c + indices[p] * c_rs);
+      if((b_cs == 1) && (c_cs == 1)){
+        k_info.axpy(n, 1, alpha, b_i, 0, values + p, 1, c_j);
+      }else{
+        const FloatT a(alpha * values[p]);
+        for(int j(0); j < n; j++){c_j[j * c_cs] += a * b_i[j * b_cs];}
+      }
+    }
+  }
+}
+
+#if defined(MATRIX_THREADING)
+/**
+ * Task of the parallel sparse multiplication, which processes a row block of C
+ * for A * B, or a column block of C for A^{T} * B, so that no element of C 
+ * is written by multiple tasks.
+ * 
+ */
+template <class FloatT>
+struct mat_sparse_parallel_task_t {
+  bool a_trans;
+  int m, k, n;
+  FloatT alpha;
+  const int *offsets, *indices; const FloatT *values;
+  const FloatT *b; int b_rs, b_cs;
+  FloatT beta;
+  FloatT *c; int c_rs, c_cs;
+  int block;
+  
+  static void run(void *context, const unsigned int &index){
+    const mat_sparse_parallel_task_t &t(*static_cast<mat_sparse_parallel_task_t *>(context));
+    int i((int)index * t.block);
+    if(t.a_trans){
+      mat_sparse_tmm_serial(t.m, t.k, ((t.n - i) < t.block) ? (t.n - i) : t.block, 
+          t.alpha, t.offsets, t.indices, t.values, 
+          t.b + i * t.b_cs, t.b_rs, t.b_cs, 
+          t.beta, 
+          t.c + i * t.c_cs, t.c_rs, t.c_cs);
+    }else{
+      mat_sparse_mm_serial(((t.m - i) < t.block) ? (t.m - i) : t.block, t.n, 
+          t.alpha, t.offsets + i, t.indices, t.values, 
+          t.b, t.b_rs, t.b_cs, 
+          t.beta, 
+          t.c + i * t.c_rs, t.c_rs, t.c_cs);
+    }
+  }
+};
+#endif
+
+/**
+ * Sparse matrix multiplication C = alpha * op(A) * B + beta * C, 
+ * where A is m x k compressed by rows, and op(A) is A, or A^{T} if a_trans is true
+ * (see mat_sparse_mm_serial() and mat_sparse_tmm_serial()).
+ * A large product is split into blocks of C, which are multiplied
+ * by the threads of Matrix_ThreadPool in parallel.
+ * 
+ */
+template <class FloatT>
+void mat_sparse_mm(
+    const bool &a_trans, 
+    const int m, const int k, const int n,
+    const FloatT &alpha,
+    const int *offsets, const int *indices, const FloatT *values,
+    const FloatT *b, const int b_rs, const int b_cs,
+    const FloatT &beta,
+    FloatT *c, const int c_rs, const int c_cs){
+#if defined(MATRIX_THREADING)
+  Matrix_ThreadPool &pool(Matrix_ThreadPool::get());
+  const int lines(a_trans ? n : m);
+  if((pool.size() > 1) && (lines >= (a_trans ? 16 : 2))
+      && (((double)offsets[m] * n) >= MATRIX_SPARSE_PARALLEL_THRESHOLD)){
+    // Each thread gets about four blocks to balance the nonzeros of the rows.
+    int block((lines + pool.size() * 4 - 1) / (pool.size() * 4));
+    if(a_trans){block = ((block + 7) / 8) * 8;}
+    mat_sparse_parallel_task_t<FloatT> task = {
+        a_trans, m, k, n, alpha, offsets, indices, values, 
+        b, b_rs, b_cs, beta, c, c_rs, c_cs, block};
+    pool.run(mat_sparse_parallel_task_t<FloatT>::run, &task,
+        (unsigned int)((lines + block - 1) / block));
+    return;
+  }
+#endif
+  if(a_trans){
+    mat_sparse_tmm_serial(m, k, n, alpha, offsets, indices, values, 
+        b, b_rs, b_cs, beta, c, c_rs, c_cs);
+  }else{
+    mat_sparse_mm_serial(m, n, alpha, offsets, indices, values, 
+        b, b_rs, b_cs, beta, c, c_rs, c_cs);
+  }
+}
+
+/**
+ * Transpose of a sparse matrix, which converts the compression by rows 
+ * into the one by columns and vice versa; A (m x k) compressed by rows 
+ * is converted into A^{T} (k x m) compressed by rows,
+ * whose indices are in ascending order again.
+ * t_offsets has k + 1 elements, and t_indices and t_values have offsets[m] ones.
+ */
+template <class FloatT>
+void mat_sparse_transpose(
+    const int m, const int k,
+    const int *offsets, const int *indices, const FloatT *values,
+    int *t_offsets, int *t_indices, FloatT *t_values){
+  for(int j(0); j <= k; j++){t_offsets[j] = 0;}
+  for(int p(0); p < offsets[m]; p++){t_offsets[indices[p] + 1]++;}
+  for(int j(0); j < k; j++){t_offsets[j + 1] += t_offsets[j];}
+  // t_offsets[j] is used as the cursor of line j, which ends at the beginning of line j + 1.
+  for(int i(0); i < m; i++){
+    for(int p(offsets[i]); p < offsets[i + 1]; p++){
+      int &q(t_offsets[indices[p]]);
+      t_indices[q] = i;
+      t_values[q] = values[p];
+      q++;
+    }
+  }
+  for(int j(k); j > 0; j--){t_offsets[j] = t_offsets[j - 1];}
+  t_offsets[0] = 0;
+}
+
+/*
+ * Kernels for banded storage
+ * 
+ * A banded matrix (including diagonal and triangular ones) is specified by 
+ * its buffer and strides with which the elements in the band, 
+ * -lower <= j - i <= upper, are accessed (see Array2D::band_view_t);
+ * the structural zeros outside the band are never touched.
+ * The multiplication processes a block of rows at a time; the columns 
+ * covered by the band in all the rows of the block are passed to mat_mul_blocked(),
+ * and the remaining edges of the band are handled row by row,
+ * so that a triangular matrix runs at the speed of the multiplication engine
+ * and a narrow band costs O(n * bandwidth) per column of the other operand.
+ */
+
+/**
+ * Part of the banded matrix multiplication, C(i, :) += alpha * A(i, j0:j1) * B(j0:j1, :)
+ * for a row, whose elements of A are in the band.
+ */
+template <class FloatT>
+void mat_band_mm_row(
+    const int n, const int j0, const int j1,
+    const FloatT &alpha,
+    const FloatT *a_i, const int a_cs,
+    const FloatT *b, const int b_rs, const int b_cs,
+    FloatT *c_i, const int c_cs,
+    const mat_gemv_kernel_t<FloatT> &k_info){
+  if(j0 >= j1){return;}
+  if((b_cs == 1) && (c_cs == 1) && (n > 1)){
+    k_info.axpy(n, j1 - j0, alpha, b + j0 * b_rs, b_rs, a_i + j0 * a_cs, a_cs, c_i);
+    return;
+  }
+  for(int j(0); j < n; j++){
+    const FloatT *b_j(b + j * b_cs);
+    FloatT sum(0);
+    for(int k(j0); k < j1; k++){sum += a_i[k * a_cs] * b_j[k * b_rs];}
+    c_i[j * c_cs] += alpha * sum;
+  }
+}
+
+/**
+ * Banded matrix multiplication C = alpha * A * B + beta * C,
+ * where A is m x k banded (a[i * a_rs + j * a_cs] is A(i, j) in the band), 
+ * B is k x n (b[i * b_rs + j * b_cs]), and C is m x n (c[i * c_rs + j * c_cs]).
+ * A banded B is multiplied as C^{T} = B^{T} * A^{T}, i.e., 
+ * with the strides and the bandwidths exchanged.
+ * If beta is zero, C is not read.
+ */
+template <class FloatT>
+void mat_band_mm(
+    const int m, const int k, const int n,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs, 
+    const int lower, const int upper,
+    const FloatT *b, const int b_rs, const int b_cs,
+    const FloatT &beta,
+    FloatT *c, const int c_rs, const int c_cs){
+  if(beta == FloatT(0)){
+    for(int i(0); i < m; i++){
+      for(int j(0); j < n; j++){c[i * c_rs + j * c_cs] = FloatT(0);}
+    }
+  }else if(beta != FloatT(1)){
+    mat_scale(m, n, beta, c, c_rs, c_cs);
+  }
+  if((n <= 0) || (k <= 0)){return;}
+  const mat_gemv_kernel_t<FloatT> &k_info(mat_gemv_kernel_t<FloatT>::get());
+  const int nb(MATRIX_FACTORIZATION_BLOCK);
+  for(int i0(0); i0 < m; i0 += nb){
+    const int i1(((m - i0) < nb) ? m : (i0 + nb));
+    // columns [j0, j1) are in the band for all the rows of the block
+    int j0(i1 - 1 - lower), j1(i0 + upper + 1);
+    if(j0 < 0){j0 = 0;}
+    if(j1 > k){j1 = k;}
+    if(j0 < j1){
+      mat_mul_blocked(i1 - i0, j1 - j0, n,
+          alpha,
+          a + i0 * a_rs + j0 * a_cs, a_rs, a_cs,
+          b + j0 * b_rs, b_rs, b_cs,
+          FloatT(1),
+          c + i0 * c_rs, c_rs, c_cs);
+    }
+    for(int i(i0); i < i1; i++){
+      int l0(i - lower), l1(i + upper + 1);
+      if(l0 < 0){l0 = 0;}
+      if(l1 > k){l1 = k;}
+      const FloatT *a_i(a + i * a_rs);
+      FloatT *c_i(c + i * c_rs);
+      if(j0 < j1){
+        mat_band_mm_row(n, l0, j0, alpha, a_i, a_cs, b, b_rs, b_cs, c_i, c_cs, k_info);
+        mat_band_mm_row(n, j1, l1, alpha, a_i, a_cs, b, b_rs, b_cs, c_i, c_cs, k_info);
+      }else{
+        mat_band_mm_row(n, l0, l1, alpha, a_i, a_cs, b, b_rs, b_cs, c_i, c_cs, k_info);
+      }
+    }
+  }
+}
+
+/**
+ * Banded scaling X = alpha * X, where X is m x n banded, whose elements in the band
+ * are scaled; if alpha is zero, they are not read but set to zero.
+ * A dense matrix is scaled with lower = m and upper = n.
+ */
+template <class FloatT>
+void mat_band_scale(
+    const int m, const int n,
+    const FloatT &alpha,
+    FloatT *x, const int x_rs, const int x_cs, 
+    const int lower, const int upper){
+  if(alpha == FloatT(1)){return;}
+  for(int i(0); i < m; i++){
+    int j0(i - lower), j1(i + upper + 1);
+    if(j0 < 0){j0 = 0;}
+    if(j1 > n){j1 = n;}
+    FloatT *x_i(x + i * x_rs);
+    if(alpha == FloatT(0)){
+      for(int j(j0); j < j1; j++){x_i[j * x_cs] = FloatT(0);}
+    }else{
+      for(int j(j0); j < j1; j++){x_i[j * x_cs] *= alpha;}
+    }
+  }
+}
+
+/**
+ * Banded addition C += alpha * A, where A is m x n banded, 
+ * whose elements in the band are added to C.
+ * C may be banded as long as its band contains the one of A.
+ */
+template <class FloatT>
+void mat_band_axpy(
+    const int m, const int n,
+    const FloatT &alpha,
+    const FloatT *a, const int a_rs, const int a_cs, 
+    const int lower, const int upper,
+    FloatT *c, const int c_rs, const int c_cs){
+  for(int i(0); i < m; i++){
+    int j0(i - lower), j1(i + upper + 1);
+    if(j0 < 0){j0 = 0;}
+    if(j1 > n){j1 = n;}
+    const FloatT *a_i(a + i * a_rs);
+    FloatT *c_i(c + i * c_rs);
+    for(int j(j0); j < j1; j++){c_i[j * c_cs] += alpha * a_i[j * a_cs];}
+  }
+}
+
+/**
+ * Banded solve in place, X = A^{-1} * X, where A is n x n banded
+ * (a[i * a_rs + j * a_cs] is A(i, j) in the band, and A is not modified),
+ * and X is n x m (x[i * x_rs + j * x_cs] is X(i, j)).
+ * A triangular band (lower or upper is zero) is solved by the substitution,
+ * or by mat_trsm_left() if it covers the whole triangle.
+ * Otherwise, A is copied into a workspace of n * (2 * lower + upper + 1) elements, 
+ * and is factorized by LU decomposition with partial pivoting within the band,
+ * whose upper bandwidth grows to lower + upper by the row interchanges.
+ * Both cost O(n * bandwidth * (bandwidth + m)).
+ * 
+ * @return (bool) false if A is singular, in which case X is undefined
+ */
+template <class FloatT>
+bool mat_band_solve(
+    const int n, const int m,
+    const FloatT *a, const int a_rs, const int a_cs, 
+    const int lower, const int upper,
+    FloatT *x, const int x_rs, const int x_cs){
+  if((lower == 0) || (upper == 0)){
+    for(int i(0); i < n; i++){
+      if(a[i * (a_rs + a_cs)] == FloatT(0)){return false;}
+    }
+    const bool is_lower(lower > 0);
+    const int bw(is_lower ? lower : upper);
+    if((bw > 0) && (bw >= n - 1)){
+      mat_trsm_left(n, m, a, a_rs, a_cs, is_lower, false, x, x_rs, x_cs);
+      return true;
+    }
+    for(int ii(0); ii < n; ii++){
+      const int i(is_lower ? ii : (n - 1 - ii));
+      int k0(is_lower ? (i - bw) : (i + 1)), k1(is_lower ? i : (i + bw + 1));
+      if(k0 < 0){k0 = 0;}
+      if(k1 > n){k1 = n;}
+      FloatT *x_i(x + i * x_rs);
+      for(int k(k0); k < k1; k++){
+        const FloatT a_ik(a[i * a_rs + k * a_cs]);
+        if(a_ik == FloatT(0)){continue;}
+        const FloatT *x_k(x + k * x_rs);
+        for(int j(0); j < m; j++){x_i[j * x_cs] -= a_ik * x_k[j * x_cs];}
+      }
+      const FloatT a_ii(a[i * (a_rs + a_cs)]);
+      for(int j(0); j < m; j++){x_i[j * x_cs] /= a_ii;}
+    }
+    return true;
+  }
+  
+  // W(r, c) = w[r * w_rs + c], -lower <= c - r <= lower + upper
+  const int u2(lower + upper), w_rs(2 * lower + upper);
+  FloatT *w_buf(new FloatT[n * (w_rs + 1)]), *w(w_buf + lower);
+  for(int i(0); i < n; i++){
+    for(int j(i - lower); j <= i + u2; j++){
+      w[i * w_rs + j] = ((j >= 0) && (j < n) && (j <= i + upper)) 
+          ? a[i * a_rs + j * a_cs] : FloatT(0);
+    }
+  }
+  bool regular(true);
+  for(int i(0); i < n; i++){
+    const int r1(((i + lower) < n) ? (i + lower + 1) : n), 
+        c1(((i + u2) < n) ? (i + u2 + 1) : n);
+    int p(i);
+    FloatT p_abs(0);
+    for(int r(i); r < r1; r++){
+      FloatT v(w[r * w_rs + i]);
+      if(v < FloatT(0)){v = -v;}
+      if(v > p_abs){p = r; p_abs = v;}
+    }
+    if(p_abs == FloatT(0)){
+      regular = false;
+      break;
+    }
+    if(p != i){
+      FloatT *w_i(w + i * w_rs), *w_p(w + p * w_rs);
+      for(int c(i); c < c1; c++){
+        FloatT temp(w_i[c]);
+        w_i[c] = w_p[c];
+        w_p[c] = temp;
+      }
+      FloatT *x_i(x + i * x_rs), *x_p(x + p * x_rs);
+      for(int j(0); j < m; j++){
+        FloatT temp(x_i[j * x_cs]);
+        x_i[j * x_cs] = x_p[j * x_cs];
+        x_p[j * x_cs] = temp;
+      }
+    }
+    const FloatT *w_i(w + i * w_rs), *x_i(x + i * x_rs);
+    for(int r(i + 1); r < r1; r++){
+      FloatT *w_r(w + r * w_rs);
+      const FloatT l(w_r[i] / w_i[i]);
+      if(l == FloatT(0)){continue;}
+      for(int c(i + 1); c < c1; c++){w_r[c] -= l * w_i[c];}
+      FloatT *x_r(x + r * x_rs);
+      for(int j(0); j < m; j++){x_r[j * x_cs] -= l * x_i[j * x_cs];}
+    }
+  }
+  if(regular){
+    for(int i(n - 1); i >= 0; i--){
+      const int c1(((i + u2) < n) ? (i + u2 + 1) : n);
+      const FloatT *w_i(w + i * w_rs);
+      FloatT *x_i(x + i * x_rs);
+      for(int c(i + 1); c < c1; c++){
+        if(w_i[c] == FloatT(0)){continue;}
+        const FloatT *x_c(x + c * x_rs);
+        for(int j(0); j < m; j++){x_i[j * x_cs] -= w_i[c] * x_c[j * x_cs];}
+      }
+      for(int j(0); j < m; j++){x_i[j * x_cs] /= w_i[i];}
+    }
+  }
+  delete [] w_buf;
+  return regular;
+}
+
+template <class FloatT>
+class Matrix;
+
+template <class T>
+class TransposedMatrix;
+
+template <class T>
+class PartialMatrix;
+
+/*
+ * Expression templates for element-wise arithmetic
+ * 
+ * Addition, subtraction, negation, and scaling by a scalar return 
+ * lightweight expression objects instead of matrices, 
+ * and the whole expression is evaluated element by element in a single pass
+ * when it is assigned, so that a + b * 2 - c neither allocates temporaries
+ * nor sweeps the memory more than once.
+ * A matrix operand is referred by reference, therefore an expression object
+ * must not outlive its operands; copy() evaluates it into a new matrix.
+ * The read-only members of Matrix, such as (a + b).transpose() or 
+ * (a - b).inverse(), are also available on an expression, 
+ * each of which evaluates the expression into a temporary matrix beforehand
+ * (see Matrix_Expression_Evaluable).
+ * 
+ * Each expression type E has value_t, rows(), columns(), 
+ * and evaluator_t, which is constructed from E and has the following members;
+ *   unit()       : true if every operand has unit column stride
+ *   transpose()  : exchange the roles of rows and columns of every operand,
+ *                  which is used to run the inner loop along the unit stride
+ *   row(i)       : move to row i
+ *   at(j)        : element (i, j) of the current row
+ *   at_unit(j)   : same as at(j), valid only when unit() is true
+ */
+template <class E>
+struct Matrix_Expression {
+  const E &expression() const {return static_cast<const E &>(*this);}
+};
+
+/**
+ * Read-only members of Matrix<T> for an expression E, 
+ * which are forwarded to the matrix evaluated from the expression.
+ * Element access only evaluates the requested element.
+ * Views, such as transpose() and partial(), share the evaluated temporary, 
+ * therefore they remain valid after the expression is destroyed.
+ */
+template <class E, class T>
+struct Matrix_Expression_Evaluable : public Matrix_Expression<E> {
+  typedef Matrix<T> matrix_t;
+  
+  /**
+   * Evaluate into a new matrix
+   * 
+   * @return (Matrix<T>) result
+   */
+  matrix_t copy() const {return matrix_t(this->expression());}
+  
+  T operator()(const unsigned int &row, const unsigned int &column) const {
+    assert((row < this->expression().rows()) && (column < this->expression().columns()));
+    typename E::evaluator_t e(this->expression());
+    e.row(row);
+    return e.at(column);
+  }
+  
+  /**
+   * Matrix multiplication, for which the expression is evaluated beforehand.
+   * 
+   * @param matrix right hand side
+   * @return (Matrix<T>) product
+   */
+  matrix_t operator*(const matrix_t &matrix) const {return copy() * matrix;}
+  matrix_t operator/(const matrix_t &matrix) const {return copy() / matrix;}
+  
+  TransposedMatrix<T> transpose() const {return copy().transpose();}
+  PartialMatrix<T> partial(
+      const unsigned int &rowSize,
+      const unsigned int &columnSize,
+      const unsigned int &rowOffset,
+      const unsigned int &columnOffset) const {
+    return copy().partial(rowSize, columnSize, rowOffset, columnOffset);
+  }
+  PartialMatrix<T> rowVector(const unsigned int &row) const {return copy().rowVector(row);}
+  PartialMatrix<T> columnVector(const unsigned int &column) const {return copy().columnVector(column);}
+  
+  bool isSquare() const {return this->expression().rows() == this->expression().columns();}
+  bool isDiagonal() const {return copy().isDiagonal();}
+  bool isSymmetric() const {return copy().isSymmetric();}
+  bool isDifferentSize(const matrix_t &matrix) const {
+    return (this->expression().rows() != matrix.rows()) 
+        || (this->expression().columns() != matrix.columns());
+  }
+  
+  T trace(bool do_check = true) const {return copy().trace(do_check);}
+  T determinant(bool do_check = false) const {return copy().determinant(do_check);}
+  T logDeterminant(int *sign = NULL, bool do_check = false) const {
+    return copy().logDeterminant(sign, do_check);
+  }
+  matrix_t coMatrix(const unsigned int &row, const unsigned int &column) const {
+    return copy().coMatrix(row, column);
+  }
+  matrix_t decomposeLU(bool do_check = false) const {return copy().decomposeLU(do_check);}
+  matrix_t decomposeUD(bool do_check = false) const {return copy().decomposeUD(do_check);}
+  matrix_t solve(const matrix_t &matrix, bool do_check = false) const {
+    return copy().solve(matrix, do_check);
+  }
+  matrix_t inverse(bool do_check = false) const {return copy().inverse(do_check);}
+  matrix_t pivotAdd(const int &row, const int &column, const matrix_t &matrix) const {
+    return copy().pivotAdd(row, column, matrix);
+  }
+  void inspect(char *buffer, int buffer_size) const {copy().inspect(buffer, buffer_size);}
+};
+
+/**
+ * Operands are held by value, except for matrices, which are held by reference.
+ */
+template <class E>
+struct Matrix_Expression_Holder {typedef const E type;};
+
+template <class T>
+struct Matrix_Expression_Holder<Matrix<T> > {typedef const Matrix<T> &type;};
+
+/**
+ * Element-wise binary operation, E1 op E2
+ */
+template <class E1, class E2, class Op>
+class Matrix_Expression_Binary 
+    : public Matrix_Expression_Evaluable<
+        Matrix_Expression_Binary<E1, E2, Op>, typename E1::value_t> {
+  public:
+    typedef typename E1::value_t value_t;
+    typedef Matrix_Expression_Binary<E1, E2, Op> self_t;
+  
+  protected:
+    typename Matrix_Expression_Holder<E1>::type m_e1;
+    typename Matrix_Expression_Holder<E2>::type m_e2;
+  
+  public:
+    Matrix_Expression_Binary(const E1 &e1, const E2 &e2) 
+        : m_e1(e1), m_e2(e2) {
+      assert((e1.rows() == e2.rows()) && (e1.columns() == e2.columns()));
+    }
+    
+    unsigned int rows() const {return m_e1.rows();}
+    unsigned int columns() const {return m_e1.columns();}
+    
+    struct evaluator_t {
+      typename E1::evaluator_t e1;
+      typename E2::evaluator_t e2;
+      evaluator_t(const self_t &expr) : e1(expr.m_e1), e2(expr.m_e2) {}
+      bool unit() const {return e1.unit() && e2.unit();}
+      void transpose(){e1.transpose(); e2.transpose();}
+      void row(const unsigned int &i){e1.row(i); e2.row(i);}
+      value_t at(const unsigned int &j) const {
+        return Op::apply(e1.at(j), e2.at(j));
+      }
+      value_t at_unit(const unsigned int &j) const {
+        return Op::apply(e1.at_unit(j), e2.at_unit(j));
+      }
+    };
+};
+
+struct Matrix_Expression_Plus {
+  template <class T>
+  static T apply(const T &a, const T &b){return a + b;}
+};
+
+struct Matrix_Expression_Minus {
+  template <class T>
+  static T apply(const T &a, const T &b){return a - b;}
+};
+
+/**
+ * Element-wise scaling, alpha * E
+ */
+template <class E>
+class Matrix_Expression_Scale 
+    : public Matrix_Expression_Evaluable<
+        Matrix_Expression_Scale<E>, typename E::value_t> {
+  public:
+    typedef typename E::value_t value_t;
+    typedef Matrix_Expression_Scale<E> self_t;
+  
+  protected:
+    typename Matrix_Expression_Holder<E>::type m_e;
+    value_t m_alpha;
+    
+  public:
+    Matrix_Expression_Scale(const E &e, const value_t &alpha) 
+        : m_e(e), m_alpha(alpha) {}
+    
+    unsigned int rows() const {return m_e.rows();}
+    unsigned int columns() const {return m_e.columns();}
+    
+    struct evaluator_t {
+      typename E::evaluator_t e;
+      value_t alpha;
+      evaluator_t(const self_t &expr) : e(expr.m_e), alpha(expr.m_alpha) {}
+      bool unit() const {return e.unit();}
+      void transpose(){e.transpose();}
+      void row(const unsigned int &i){e.row(i);}
+      value_t at(const unsigned int &j) const {return alpha * e.at(j);}
+      value_t at_unit(const unsigned int &j) const {return alpha * e.at_unit(j);}
+    };
+};
+
+template <class E1, class E2>
+Matrix_Expression_Binary<E1, E2, Matrix_Expression_Plus> operator+(
+    const Matrix_Expression<E1> &e1, const Matrix_Expression<E2> &e2){
+  return Matrix_Expression_Binary<E1, E2, Matrix_Expression_Plus>(
+      e1.expression(), e2.expression());
+}
+
+template <class E1, class E2>
+Matrix_Expression_Binary<E1, E2, Matrix_Expression_Minus> operator-(
+    const Matrix_Expression<E1> &e1, const Matrix_Expression<E2> &e2){
+  return Matrix_Expression_Binary<E1, E2, Matrix_Expression_Minus>(
+      e1.expression(), e2.expression());
+}
+
+template <class E>
+Matrix_Expression_Scale<E> operator*(
+    const Matrix_Expression<E> &e, const typename E::value_t &scalar){
+  return Matrix_Expression_Scale<E>(e.expression(), scalar);
+}
+
+template <class E>
+Matrix_Expression_Scale<E> operator*(
+    const typename E::value_t &scalar, const Matrix_Expression<E> &e){
+  return Matrix_Expression_Scale<E>(e.expression(), scalar);
+}
+
+template <class E>
+Matrix_Expression_Scale<E> operator/(
+    const Matrix_Expression<E> &e, const typename E::value_t &scalar){
+  return Matrix_Expression_Scale<E>(e.expression(), 1 / scalar);
+}
+
+/**
+ * Same as e / scalar, which is kept for compatibility.
+ */
+template <class E>
+Matrix_Expression_Scale<E> operator/(
+    const typename E::value_t &scalar, const Matrix_Expression<E> &e){
+  return Matrix_Expression_Scale<E>(e.expression(), 1 / scalar);
+}
+
+template <class E>
+Matrix_Expression_Scale<E> operator-(const Matrix_Expression<E> &e){
+  return Matrix_Expression_Scale<E>(e.expression(), -1);
+}
+
+/**
+ * @brief 
+ *
+ * (?)?
+ * ???(????)?
+ * ?
+ * ????
+ */
+template <class T>
+class DelegatedMatrix : public Matrix<T>{
+  protected:
+    typedef Matrix<T> super_t;
+    typedef DelegatedMatrix<T> self_t;
+
+    super_t &substitute(const super_t &matrix){
+      if((this != &matrix) && (super_t::m_Storage)){
+#define __MIN_MACRO(x, y) ((x) < (y) ? (x) : (y))
+        super_t::m_Storage->detach();
+        typename super_t::view_t y;
+        if(super_t::m_Storage->view(y)){
+          typename super_t::dense_view_t x(matrix);
+          mat_copy(
+              (int)__MIN_MACRO(super_t::rows(), matrix.rows()),
+              (int)__MIN_MACRO(super_t::columns(), matrix.columns()),
+              (const T *)x.buffer, x.row_stride, x.column_stride,
+              y.buffer, y.row_stride, y.column_stride);
+          return *this;
+        }
+        for(unsigned int i(0); i < __MIN_MACRO(super_t::rows(), matrix.rows()); i++){
+          for(unsigned int j(0); j < __MIN_MACRO(super_t::columns(), matrix.columns()); j++){
+            (*this)(i, j) = matrix(i, j);
+          }
+        }
+#undef __MIN_MACRO
+      }
+      return *this;
+    }
+
+    DelegatedMatrix(const typename super_t::storage_t *storage)
+        : super_t(storage){}
+    DelegatedMatrix(const self_t &matrix)
+        : super_t(matrix.m_Storage->shallow_copy()){}
+#if __cplusplus >= 201103L
+    DelegatedMatrix(self_t &&matrix)
+        : super_t(std::move(matrix)){}
+    
+    /**
+     * A temporary is also copied into the delegated region element by element,
+     * because the storage of a view must not be replaced.
+     *
+     * @param matrix source
+     */
+    super_t &substitute(super_t &&matrix){
+      return substitute(static_cast<const super_t &>(matrix));
+    }
+#endif
+    virtual ~DelegatedMatrix(){}
+
+    /**
+     * ?
+     * ?Storage?
+     *
+     * @param matrix 
+     */
+    self_t &operator=(const super_t &matrix){
+      return static_cast<self_t &>(self_t::substitute(matrix));
+    }
+
+    self_t &operator=(const self_t &matrix){
+      return static_cast<self_t &>(self_t::substitute(matrix));
+    }
+
+  public:
+    Matrix<T> original() const{
+      return super_t::make_instance(
+          static_cast<Array2D_Delegate<T> *>(Matrix<T>::m_Storage)
+            ->getParent()->shallow_copy());
+    }
+};
+
+/**
+ * @brief 
+ *
+ * ??
+ * ??
+ * 2?Array2D_Transpose
+ *
+ * @see Array2D_Transpose 2?
+ */
+template <class T>
+class TransposedMatrix : public DelegatedMatrix<T>{
+  protected:
+    typedef Matrix<T> root_t;
+    typedef DelegatedMatrix<T> super_t;
+    typedef TransposedMatrix<T> self_t;
+
+  public:
+    using root_t::rows;
+    using root_t::columns;
+    
+    /**
+     * TransposedMatrix()???
+     *
+     * @param matrix 
+     */
+    TransposedMatrix(const root_t &matrix)
+        : super_t(new Array2D_Transpose<T>(*(matrix.storage()))){}
+    
+    /**
+     * Copy constructor, which shares the transposed view.
+     *
+     * @param matrix origin
+     */
+    TransposedMatrix(const self_t &matrix)
+        : super_t(matrix){}
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move constructor, which takes over the transposed view.
+     *
+     * @param matrix origin
+     */
+    TransposedMatrix(self_t &&matrix)
+        : super_t(std::move(matrix)){}
+#endif
+
+    /**
+     * ?
+     */
+    ~TransposedMatrix(){}
+
+    /**
+     * 
+     * ??
+     * transpose().copy()
+     *
+     * @return (root_t) 
+     */
+    inline root_t untranspose() const{
+      return super_t::original();
+    }
+
+    self_t &operator=(const root_t &matrix){
+      return static_cast<self_t &>(super_t::substitute(matrix));
+    }
+    self_t &operator=(const self_t &matrix){
+      return static_cast<self_t &>(super_t::substitute(matrix));
+    }
+    
+    /**
+     * Evaluate an element-wise expression directly into the delegated region.
+     *
+     * @param expr expression
+     */
+    template <class E>
+    self_t &operator=(const Matrix_Expression<E> &expr){
+      root_t::assign_expression(expr.expression());
+      return *this;
+    }
+    
+    /**
+     * ( * )
+     *
+     * @param matrix 
+     * @return (root_t) ?
+     */
+    root_t operator*(const root_t &matrix) const{
+      return root_t::mul(untranspose(), true, matrix, false);
+    }
+    
+    /**
+     * ( * )
+     *
+     * @param matrix 
+     * @return (root_t) ?
+     * @throw MatrixException ?(??????)
+     */
+    root_t operator*(const self_t &matrix) const{
+      return root_t::mul(untranspose(), true, matrix.untranspose(), true);
+    }
+};
+
+/**
+ * @brief ?
+ *
+ * ???
+ * ??
+ * ?2?Array2D_Partial?
+ *
+ * @see Array2D_Partial ?2?
+ */
+template <class T>
+class PartialMatrix : public DelegatedMatrix<T>{
+  protected:
+    typedef Matrix<T> root_t;
+    typedef DelegatedMatrix<T> super_t;
+    typedef PartialMatrix<T> self_t;
+
+  public:
+    /**
+     * PartialMatrix(?)???
+     *
+     * @param matrix 
+     * @param rows ?
+     * @param columns ?
+     * @param rowOffset ?(0,0)?
+     * @param columnOffset ?
+     */
+    PartialMatrix(
+        const root_t &matrix,
+        const unsigned int &rows,
+        const unsigned int &columns,
+        const unsigned int &rowOffset,
+        const unsigned int &columnOffset)
+            : super_t(new Array2D_Partial<T>(
+                rows, columns,
+                *(matrix.storage()),
+                rowOffset, columnOffset)){}
+    
+    /**
+     * Copy constructor, which shares the partial view.
+     *
+     * @param matrix origin
+     */
+    PartialMatrix(const self_t &matrix)
+        : super_t(matrix){}
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move constructor, which takes over the partial view.
+     *
+     * @param matrix origin
+     */
+    PartialMatrix(self_t &&matrix)
+        : super_t(std::move(matrix)){}
+#endif
+
+    /**
+     * ?
+     */
+    ~PartialMatrix(){}
+
+    self_t &operator=(const root_t &matrix){
+      return static_cast<self_t &>(super_t::substitute(matrix));
+    }
+    self_t &operator=(const self_t &matrix){
+      return static_cast<self_t &>(super_t::substitute(matrix));
+    }
+    
+    /**
+     * Evaluate an element-wise expression directly into the delegated region.
+     *
+     * @param expr expression
+     */
+    template <class E>
+    self_t &operator=(const Matrix_Expression<E> &expr){
+      root_t::assign_expression(expr.expression());
+      return *this;
+    }
+};
+
+/**
+ * Matrix class.
+ * 
+ * ?
+ * 
+ */
+template <class FloatT = double>
+class Matrix : public Matrix_Expression<Matrix<FloatT> > {
+  public:
+    typedef Matrix<FloatT> self_t;
+    typedef FloatT value_t;
+    typedef Array2D<FloatT> storage_t;
+    typedef typename storage_t::view_t view_t;
+      
+    /**
+     * Memory layout descriptor of a matrix.
+     * If the storage does not have the descriptor, 
+     * a dense copy is made, which is released together with this.
+     */
+    struct dense_view_t : public storage_t::view_t {
+      Array2D_Dense<FloatT> *temp;
+      dense_view_t(const self_t &matrix) : temp(NULL) {
+        if(!matrix.m_Storage->view(*this)){
+          temp = new Array2D_Dense<FloatT>(matrix.m_Storage->dense());
+          temp->view(*this);
+        }
+      }
+      ~dense_view_t(){delete temp;}
+    };
+      
+  protected:
+    storage_t *m_Storage;
+    
+    /**
+     * Matrix???
+     * ?
+     * 
+     * @param array ?
+     */
+    Matrix(const storage_t *storage) : m_Storage(const_cast<storage_t *>(storage)){}
+    
+    static self_t make_instance(const storage_t *storage){
+      return self_t(storage);
+    }
+    
+    /**
+     * Matrix???
+     * ??
+     * ?
+     *
+     * @param rows ?
+     * @param columns ?
+     */
+    static self_t naked(
+        const unsigned int &rows,
+        const unsigned int &columns){
+      return Matrix(new Array2D_Dense<FloatT>(rows, columns));
+    }
+    
+    /**
+     * Multiplication with the blocked engine mat_mul_blocked().
+     * A transposed operand is specified by its original matrix and the flag,
+     * and is read with exchanged strides without materialization.
+     * Views such as partial() are also read in place through their descriptors.
+     * A symmetric packed operand is multiplied by mat_symm_packed(), 
+     * a sparse one by mat_sparse_mm(), and a banded one, such as diagonal
+     * and triangular ones, by mat_band_mm() (see multiply_into()).
+     *
+     * @param x left operand
+     * @param x_trans true when x^{T} is multiplied
+     * @param y right operand
+     * @param y_trans true when y^{T} is multiplied
+     * @return (self_t) product
+     */
+    static self_t mul(
+        const self_t &x, const bool &x_trans,
+        const self_t &y, const bool &y_trans){
+      unsigned int r1(x_trans ? x.columns() : x.rows()), 
+          c1(x_trans ? x.rows() : x.columns()),
+          c2(y_trans ? y.rows() : y.columns());
+      assert(c1 == (y_trans ? y.columns() : y.rows()));
+      self_t result(self_t::naked(r1, c2));
+      typename storage_t::symmetric_view_t sv;
+      typename storage_t::sparse_view_t sp;
+      typename storage_t::band_view_t bv;
+      if(x.m_Storage->symmetric_view(sv) || y.m_Storage->symmetric_view(sv)
+          || x.m_Storage->sparse_view(sp) || y.m_Storage->sparse_view(sp)
+          || x.m_Storage->band_view(bv) || y.m_Storage->band_view(bv)){
+        multiply_into(result, x, y, FloatT(1), FloatT(0), x_trans, y_trans);
+        return result;
+      }
+      dense_view_t x_v(x), y_v(y);
+      mat_mul_blocked((int)r1, (int)c1, (int)c2, 
+          FloatT(1),
+          x_v.buffer, 
+          (x_trans ? x_v.column_stride : x_v.row_stride), 
+          (x_trans ? x_v.row_stride : x_v.column_stride),
+          y_v.buffer, 
+          (y_trans ? y_v.column_stride : y_v.row_stride), 
+          (y_trans ? y_v.row_stride : y_v.column_stride),
+          FloatT(0),
+          static_cast<Array2D_Dense<FloatT> *>(result.m_Storage)->buffer(), 
+          (int)static_cast<Array2D_Dense<FloatT> *>(result.m_Storage)->ld(), 1);
+      return result;
+    }
+  
+  public:
+    /**
+     * Evaluate an element-wise expression into this matrix in a single pass.
+     * The loops are exchanged when the destination is column-major or a column vector,
+     * so that the inner loop runs along its unit stride.
+     * Each element of the destination is written after the corresponding elements
+     * of the operands are read, therefore the destination can appear 
+     * in the expression as long as it is not a view with different layout.
+     *
+     * @param expr expression
+     */
+    template <class E>
+    void assign_expression(const E &expr){
+      assert((rows() == expr.rows()) && (columns() == expr.columns()));
+      detach();
+      typename E::evaluator_t ev(expr);
+      view_t v;
+      if(m_Storage->view(v)){
+        unsigned int r(v.rows), c(v.columns);
+        int rs(v.row_stride), cs(v.column_stride);
+        int rs_abs((rs < 0) ? -rs : rs), cs_abs((cs < 0) ? -cs : cs);
+        if((rs_abs < cs_abs) || ((rs_abs == cs_abs) && (c < r))){
+          ev.transpose();
+          r = v.columns; c = v.rows;
+          rs = v.column_stride; cs = v.row_stride;
+        }
+        if((cs == 1) && ev.unit()){
+          for(unsigned int i(0); i < r; i++){
+            FloatT *d(v.buffer + (int)i * rs);
+            ev.row(i);
+            for(unsigned int j(0); j < c; j++){d[j] = ev.at_unit(j);}
+          }
+        }else{
+          for(unsigned int i(0); i < r; i++){
+            FloatT *d(v.buffer + (int)i * rs);
+            ev.row(i);
+            for(unsigned int j(0); j < c; j++){d[(int)j * cs] = ev.at(j);}
+          }
+        }
+      }else{
+        Array2D_Dense<FloatT> temp(rows(), columns());
+        for(unsigned int i(0); i < rows(); i++){
+          ev.row(i);
+          for(unsigned int j(0); j < columns(); j++){temp(i, j) = ev.at(j);}
+        }
+        write_back(temp);
+      }
+    }
+    
+    /**
+     * Evaluator of a matrix as an operand of expressions, 
+     * which reads the elements through the memory layout descriptor.
+     */
+    struct evaluator_t {
+      dense_view_t v;
+      const FloatT *r;
+      evaluator_t(const self_t &matrix) : v(matrix), r(NULL) {}
+      bool unit() const {return v.column_stride == 1;}
+      void transpose(){
+        int temp(v.row_stride);
+        v.row_stride = v.column_stride;
+        v.column_stride = temp;
+      }
+      void row(const unsigned int &i){r = v.buffer + (int)i * v.row_stride;}
+      FloatT at(const unsigned int &j) const {return r[(int)j * v.column_stride];}
+      FloatT at_unit(const unsigned int &j) const {return r[j];}
+    };
+    
+    /**
+     * ?
+     * 
+     * @return (const storage_t *) ?
+     */
+    const storage_t *storage() const{return m_Storage;}
+
+    /**
+     * Matrix???
+     * 
+     */
+    Matrix() : m_Storage(NULL){}
+    
+    /**
+     * Matrix???
+     * ??
+     * FloatT(0)?
+     * 
+     *     
+     * @param rows ?
+     * @param columns ?
+     */
+    Matrix(const unsigned int &rows, const unsigned int &columns)
+        : m_Storage(new Array2D_Dense<FloatT>(rows, columns)){m_Storage->clear();}
+    
+    /**
+     * Matrix???
+     * ??
+     * seialized?
+     *
+     * @param rows ?
+     * @param columns ?
+     * @param serialized 
+     */
+    Matrix(
+        const unsigned int &rows, const unsigned int &columns,
+        const FloatT *serialized)
+        : m_Storage(new Array2D_Dense<FloatT>(rows, columns, serialized)){}
+    
+    /**
+     * ??
+     * ??
+     * 
+     * @param matrix 
+     */
+    Matrix(const Matrix &matrix) : m_Storage(matrix.m_Storage->share()){}
+    
+    /**
+     * Evaluate an element-wise expression into a new matrix in a single pass.
+     * 
+     * @param expr expression such as a + b * 2
+     */
+    template <class E>
+    Matrix(const Matrix_Expression<E> &expr) 
+        : m_Storage(new Array2D_Dense<FloatT>(
+            expr.expression().rows(), expr.expression().columns())){
+      assign_expression(expr.expression());
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move constructor.
+     * The storage is taken over as it is, so no allocation happens.
+     * 
+     * @param matrix origin, which becomes empty
+     */
+    Matrix(Matrix &&matrix) : m_Storage(matrix.m_Storage){
+      matrix.m_Storage = NULL;
+    }
+#endif
+    /**
+     * ?
+     */
+    virtual ~Matrix(){delete m_Storage;}
+    
+  protected:
+    /**
+     * ??
+     * ???
+     *
+     * @return (self_t) 
+     */
+    virtual self_t &substitute(const self_t &matrix){
+      if(this != &matrix){
+        delete m_Storage;
+        m_Storage = matrix.m_Storage 
+            ? matrix.m_Storage->share()
+            : NULL;
+      }
+      return *this;
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Substitution from a temporary.
+     * The storages are swapped, therefore no allocation happens and
+     * the previous storage is released with the temporary.
+     *
+     * @return (self_t) myself
+     */
+    virtual self_t &substitute(self_t &&matrix){
+      if(this != &matrix){
+        storage_t *storage(m_Storage);
+        m_Storage = matrix.m_Storage;
+        matrix.m_Storage = storage;
+      }
+      return *this;
+    }
+#endif
+
+  public:
+    /**
+     * ?
+     *
+     * @return (self_t) 
+     */
+    self_t &operator=(const self_t &matrix){
+      return substitute(matrix);
+    }
+    
+#if __cplusplus >= 201103L
+    /**
+     * Move assignment
+     *
+     * @return (self_t) myself
+     */
+    self_t &operator=(self_t &&matrix){
+      return substitute(std::move(matrix));
+    }
+#endif
+    
+    /**
+     * Assignment of an element-wise expression.
+     * The result is evaluated into new storage in a single pass, 
+     * because the current storage may be shared with other matrices.
+     *
+     * @return (self_t) myself
+     */
+    template <class E>
+    self_t &operator=(const Matrix_Expression<E> &expr){
+      self_t result(expr);
+#if __cplusplus >= 201103L
+      return substitute(std::move(result));
+#else
+      return substitute(result);
+#endif
+    }
+    
+    /**
+     * ()
+     * 
+     * @return (self_t) 
+     */
+    self_t copy() const{
+      return self_t(m_Storage->copy());
+    }
+    
+    /**
+     * ?
+     * 
+     * @return (int) ?
+     */
+    unsigned int rows() const{return m_Storage->rows();}
+    /**
+     * ?
+     * 
+     * @return (int) ?
+     */
+    unsigned int columns() const{return m_Storage->columns();}
+    
+    /**
+     * 
+     * 
+     * @param row ?(?0)
+     * @param column ?(?0)
+     * @return (FloatT) 
+     */
+    inline FloatT &operator()(const unsigned int &row, const unsigned int &column){
+      if(m_Storage->structured() && !m_Storage->holds(row, column)){ // structural zero to be written
+        densify();
+      }
+      return m_Storage->operator()(row, column);
+    }
+    
+    /**
+     * Read-only element accessor, which never detaches the buffer
+     * shared by copy-on-write.
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    inline const FloatT &operator()(const unsigned int &row, const unsigned int &column) const {
+      return static_cast<const storage_t *>(m_Storage)->operator()(row, column);
+    }
+    
+    /**
+     * Make the buffer exclusive to this matrix (and views on it).
+     * Copies share their buffer until either of them is written (copy-on-write);
+     * writes through operator() and the member functions detach automatically,
+     * therefore this is required only before writing directly to 
+     * the buffer obtained by storage()->view().
+     * 
+     * @return (self_t) myself
+     */
+    self_t &detach(){
+      if(m_Storage){m_Storage->detach();}
+      return *this;
+    }
+    /**
+     * (Matlab?)
+     * 
+     * @param row ?(?1)
+     * @param column ?(?1)
+     * @return (FloatT) 
+     */
+    FloatT &matlab(const int &row, const int &column){
+      return (*this)(row - 1, column - 1);
+    }
+    
+    /**
+     * ??
+     * 
+     */
+    self_t clear(){
+      m_Storage->clear();
+      return *this;
+    }
+    
+    /**
+     * Scalar matrix, whose storage is diagonal (Array2D_Diagonal),
+     * therefore it holds only the diagonal elements, and multiplication with it 
+     * costs O(n^2). Writing an off-diagonal element through operator(),
+     * or creating a view to write through, such as partial() and transpose(),
+     * replaces the storage with dense one, so that it can be filled as before.
+     *
+     * @param size number of rows (and columns)
+     * @param scalar diagonal element
+     */
+    static self_t getScalar(const unsigned int &size, const FloatT &scalar){
+      self_t result(new Array2D_Diagonal<FloatT>(size));
+      for(unsigned int i = 0; i < size; i++){result(i, i) = scalar;}
+      return result;
+    }
+    
+    /**
+     * 
+     * 
+     * @parma size ?(?)
+     */
+    static self_t getI(const int &size){
+      return getScalar(size, FloatT(1));
+    }
+    
+    /**
+     * Symmetric matrix filled with zero, whose storage is packed 
+     * (Array2D_SymmetricPacked), therefore it requires about half of the memory.
+     * Element (i, j) and (j, i) are the same, so writing one of them changes the other.
+     * Multiplication, scaling, and addition of another packed matrix
+     * work on the packed elements directly.
+     * 
+     * @param size number of rows (and columns)
+     * @return (self_t) symmetric matrix
+     */
+    static self_t getSymmetricPacked(const unsigned int &size){
+      self_t result(new Array2D_SymmetricPacked<FloatT>(size));
+      result.m_Storage->clear();
+      return result;
+    }
+    
+    /**
+     * Copy of this matrix into symmetric packed storage,
+     * which is made from the upper triangle; the lower one is not referred.
+     * 
+     * @return (self_t) symmetric matrix
+     * @see getSymmetricPacked(const unsigned int &)
+     */
+    self_t toSymmetricPacked() const {
+      assert(isSquare());
+      const int n((int)rows());
+      Array2D_SymmetricPacked<FloatT> *packed(new Array2D_SymmetricPacked<FloatT>(n));
+      dense_view_t v(*this);
+      for(int i(0); i < n; i++){
+        FloatT *dst(packed->buffer() + mat_packed_offset(n, i));
+        const FloatT *src(v.buffer + i * v.row_stride);
+        for(int j(i); j < n; j++){dst[j] = src[j * v.column_stride];}
+      }
+      return self_t(packed);
+    }
+    
+    /**
+     * Banded matrix filled with zero, whose storage (Array2D_Banded) holds 
+     * only the elements in the band -lower <= column - row <= upper; 
+     * the others are structural zeros, writing to which through operator()
+     * replaces the storage with dense one.
+     * Multiplication, addition, and solve skip the structural zeros.
+     * 
+     * @param rows number of rows
+     * @param columns number of columns
+     * @param lower number of the subdiagonals
+     * @param upper number of the superdiagonals
+     * @return (self_t) banded matrix
+     */
+    static self_t getBanded(
+        const unsigned int &rows, const unsigned int &columns,
+        const unsigned int &lower, const unsigned int &upper){
+      return self_t(new Array2D_Banded<FloatT>(rows, columns, (int)lower, (int)upper));
+    }
+    
+    /**
+     * Triangular matrix filled with zero, whose storage (Array2D_Triangular)
+     * is banded one covering the lower (or upper) triangle.
+     * 
+     * @param size number of rows (and columns)
+     * @param lower true for lower triangular, otherwise upper
+     * @return (self_t) triangular matrix
+     * @see getBanded()
+     */
+    static self_t getTriangular(const unsigned int &size, const bool &lower){
+      return self_t(new Array2D_Triangular<FloatT>(size, lower));
+    }
+    
+    /**
+     * Copy of the band of this matrix into banded storage;
+     * the elements outside the band are not referred.
+     * 
+     * @param lower number of the subdiagonals
+     * @param upper number of the superdiagonals
+     * @return (self_t) banded matrix
+     * @see getBanded()
+     */
+    self_t toBanded(const unsigned int &lower, const unsigned int &upper) const {
+      return to_band(new Array2D_Banded<FloatT>(rows(), columns(), (int)lower, (int)upper));
+    }
+    
+    /**
+     * Copy of the lower (or upper) triangle of this matrix into triangular storage,
+     * e.g., L and U are extracted from the result of decomposeLUP() by
+     * toTriangular(true, true) and toTriangular(false), respectively.
+     * 
+     * @param lower true for the lower triangle, otherwise the upper one
+     * @param unit true if the diagonal elements are replaced with one
+     * @return (self_t) triangular matrix
+     * @see getTriangular()
+     */
+    self_t toTriangular(const bool &lower, const bool &unit = false) const {
+      assert(isSquare());
+      self_t result(to_band(new Array2D_Triangular<FloatT>(rows(), lower)));
+      if(unit){
+        for(unsigned int i(0); i < rows(); i++){result(i, i) = FloatT(1);}
+      }
+      return result;
+    }
+    
+    /**
+     * Sparse matrix filled with zero, whose storage (Array2D_Sparse) holds 
+     * only the nonzero elements compressed by rows (CSR), or by columns (CSC).
+     * Writing to an element which is not stored inserts it, 
+     * which is slow for a large matrix; toSparse() of a dense matrix is faster.
+     * Multiplication with a dense matrix touches only the nonzero elements.
+     * 
+     * @param rows number of rows
+     * @param columns number of columns
+     * @param column_major true for compression by columns (CSC)
+     * @return (self_t) sparse matrix
+     */
+    static self_t getSparse(
+        const unsigned int &rows, const unsigned int &columns,
+        const bool &column_major = false){
+      return self_t(new Array2D_Sparse<FloatT>(rows, columns, column_major));
+    }
+    
+    /**
+     * Copy of this matrix into sparse storage, which holds its nonzero elements.
+     * A sparse matrix is converted between CSR and CSC without expansion.
+     * 
+     * @param column_major true for compression by columns (CSC)
+     * @return (self_t) sparse matrix
+     * @see getSparse(const unsigned int &, const unsigned int &, const bool &)
+     */
+    self_t toSparse(const bool &column_major = false) const {
+      const unsigned int major(column_major ? columns() : rows()), 
+          minor(column_major ? rows() : columns());
+      typename storage_t::sparse_view_t sv;
+      if(m_Storage->sparse_view(sv)){
+        const unsigned int sv_major(sv.column_major ? sv.columns : sv.rows);
+        const int nnz(sv.offsets[sv_major]);
+        Array2D_Sparse<FloatT> *sparse(
+            new Array2D_Sparse<FloatT>(rows(), columns(), column_major, nnz));
+        if(sv.column_major == column_major){
+          memcpy(sparse->offsets(), sv.offsets, sizeof(int) * (major + 1));
+          memcpy(sparse->indices(), sv.indices, sizeof(int) * nnz);
+          memcpy(sparse->buffer(), sv.values, sizeof(FloatT) * nnz);
+        }else{
+          mat_sparse_transpose((int)sv_major, (int)major, 
+              (const int *)sv.offsets, (const int *)sv.indices, (const FloatT *)sv.values,
+              sparse->offsets(), sparse->indices(), sparse->buffer());
+        }
+        return self_t(sparse);
+      }
+      dense_view_t v(*this);
+      const int major_s(column_major ? v.column_stride : v.row_stride), 
+          minor_s(column_major ? v.row_stride : v.column_stride);
+      int nnz(0);
+      for(unsigned int i(0); i < major; i++){
+        const FloatT *src(v.buffer + (int)i * major_s);
+        for(unsigned int j(0); j < minor; j++){
+          if(src[(int)j * minor_s] != FloatT(0)){nnz++;}
+        }
+      }
+      Array2D_Sparse<FloatT> *sparse(
+          new Array2D_Sparse<FloatT>(rows(), columns(), column_major, nnz));
+      int *offsets(sparse->offsets()), *indices(sparse->indices());
+      FloatT *values(sparse->buffer());
+      nnz = 0;
+      for(unsigned int i(0); i < major; i++){
+        const FloatT *src(v.buffer + (int)i * major_s);
+        offsets[i] = nnz;
+        for(unsigned int j(0); j < minor; j++){
+          if(src[(int)j * minor_s] == FloatT(0)){continue;}
+          indices[nnz] = (int)j;
+          values[nnz++] = src[(int)j * minor_s];
+        }
+      }
+      offsets[major] = nnz;
+      return self_t(sparse);
+    }
+    
+    /**
+     * Copy of this matrix into dense storage, 
+     * which expands symmetric packed or sparse storage.
+     * 
+     * @return (self_t) dense matrix
+     */
+    self_t toDense() const {
+      return self_t(new Array2D_Dense<FloatT>(m_Storage->dense()));
+    }
+    
+  protected:
+    /**
+     * Fill banded storage with the corresponding elements of this matrix.
+     * 
+     * @param band storage, which is owned by the returned matrix
+     */
+    self_t to_band(Array2D_Banded<FloatT> *band) const {
+      self_t result(band);
+      typename storage_t::band_view_t bv;
+      band->band_view(bv);
+      dense_view_t v(*this);
+      for(int i(0); i < (int)bv.rows; i++){
+        int j0(i - bv.lower), j1(i + bv.upper + 1);
+        if(j0 < 0){j0 = 0;}
+        if(j1 > (int)bv.columns){j1 = (int)bv.columns;}
+        for(int j(j0); j < j1; j++){
+          bv.buffer[i * bv.row_stride + j * bv.column_stride]
+              = v.buffer[i * v.row_stride + j * v.column_stride];
+        }
+      }
+      return result;
+    }
+    
+  public:
+    
+    typedef TransposedMatrix<FloatT> transposed_t;
+    
+    /**
+     * 
+     * ??
+     * transpose().copy()
+     * 
+     * @return (transposed_t) 
+     */
+    transposed_t transpose() const{
+      return transposed_t(*this);
+    }
+    
+    /**
+     * Transposed view, through which this matrix can be written.
+     * Storage having structural zeros, such as that of getI(), is shared with
+     * the view (see alias()), and is made dense only when a structural zero
+     * is written through either of them; reading through the view keeps it.
+     * The buffer is detached if it is shared by copy-on-write, 
+     * and is then aliased by the view; a matrix copied while the view is alive
+     * receives its own buffer.
+     * 
+     * @return (transposed_t) transposed view
+     */
+    transposed_t transpose(){
+      alias();
+      return transposed_t(*this);
+    }
+    
+    /**
+     * Transpose this square matrix in place, 
+     * which exchanges the elements without allocating another buffer.
+     * 
+     * @return (self_t) myself
+     */
+    self_t &transposeInPlace(){
+      assert(isSquare());
+      detach();
+      view_t v;
+      if(m_Storage->view(v)){
+        mat_transpose_square((int)rows(), v.buffer, v.row_stride, v.column_stride);
+        return *this;
+      }
+      for(unsigned int i(0); i < rows(); i++){
+        for(unsigned int j(i + 1); j < columns(); j++){
+          FloatT temp((*this)(i, j));
+          (*this)(i, j) = (*this)(j, i);
+          (*this)(j, i) = temp;
+        }
+      }
+      return *this;
+    }
+    
+    typedef PartialMatrix<FloatT> partial_t;
+    
+    /**
+     * ?
+     *
+     * @param rowSize 
+     * @param columnSize 
+     * @param rowOffset ?
+     * @param columnOffset ?
+     * @return (PartialMatrix<T>) ?
+     */
+    partial_t partial(
+        const unsigned int &rowSize,
+        const unsigned int &columnSize,
+        const unsigned int &rowOffset,
+        const unsigned int &columnOffset) const {
+      assert((rowSize + rowOffset <= rows()) 
+          && (columnSize + columnOffset <= columns()));
+      return partial_t(*this, rowSize, columnSize, rowOffset, columnOffset);
+    }
+    
+    /**
+     * Partial view, through which this matrix can be written.
+     * The buffer is detached if it is shared by copy-on-write, 
+     * and is then aliased by the view.
+     *
+     * @see transpose()
+     */
+    partial_t partial(
+        const unsigned int &rowSize,
+        const unsigned int &columnSize,
+        const unsigned int &rowOffset,
+        const unsigned int &columnOffset){
+      assert((rowSize + rowOffset <= rows()) 
+          && (columnSize + columnOffset <= columns()));
+      alias();
+      return partial_t(*this, rowSize, columnSize, rowOffset, columnOffset);
+    }
+    
+    /**
+     * ?
+     * 
+     * @param row ?
+     * @return (self_t) ?
+     */
+    partial_t rowVector(const unsigned int &row) const{
+      assert(row < rows());
+      return partial_t(*this, 1, columns(), row, 0);
+    }
+    partial_t rowVector(const unsigned int &row){
+      assert(row < rows());
+      alias();
+      return partial_t(*this, 1, columns(), row, 0);
+    }
+    /**
+     * ?
+     * 
+     * @param column ?
+     * @return (partial_t) ?
+     */
+    partial_t columnVector(const unsigned int &column) const{
+      assert(column < columns());
+      return partial_t(*this, rows(), 1, 0, column);
+    }
+    partial_t columnVector(const unsigned int &column){
+      assert(column < columns());
+      alias();
+      return partial_t(*this, rows(), 1, 0, column);
+    }
+    
+    /**
+     * ?
+     * 
+     * @param row1 ?1
+     * @param row2 ?2
+     * @return (self_t) 
+     */
+    self_t &exchangeRows(const unsigned int &row1, const unsigned int &row2){
+      assert(row1 < rows() && row2 < rows());
+      FloatT temp;
+      for(unsigned int j = 0; j < columns(); j++){
+        temp = (*this)(row1, j);
+        (*this)(row1, j) = (*this)(row2, j);
+        (*this)(row2, j) = temp;
+      }
+      return *this;
+    }
+    /**
+     * ?
+     * 
+     * @param column1 ?1
+     * @param column2 ?2
+     * @return (self_t) 
+     */
+    self_t &exchangeColumns(const unsigned int &column1, const unsigned int &column2){
+      assert(column1 < columns() && column2 < columns());
+      FloatT temp;
+      for(unsigned int i = 0; i < rows(); i++){
+        temp = (*this)(i, column1);
+        (*this)(i, column1) = (*this)(i, column2);
+        (*this)(i, column2) = temp;
+      }
+      return *this;
+    }
+    
+    /**
+     * 
+     * 
+     * @return (bool) ??true?false
+     */
+    bool isSquare() const{return rows() == columns();}
+    
+    /**
+     * 
+     *
+     * @return (bool) ??true?false
+     */
+    bool isDiagonal() const{
+      typename storage_t::band_view_t bv;
+      if(isSquare() && m_Storage->band_view(bv) && (bv.lower == 0) && (bv.upper == 0)){
+        return true;
+      }
+      if(isSquare()){
+        for(unsigned int i = 0; i < rows(); i++){
+          for(unsigned int j = i + 1; j < columns(); j++){
+            if(((*this)(i, j) != FloatT(0)) || ((*this)(j, i) != FloatT(0))){
+              return false;
+            }
+          }
+        }
+        return true;
+      }else{return false;}
+    }
+    
+    /**
+     * 
+     * 
+     * @return (bool) ??true?false
+     */
+    bool isSymmetric() const{
+      typename storage_t::symmetric_view_t sv;
+      if(m_Storage->symmetric_view(sv)){return true;}
+      if(isSquare()){
+        for(unsigned int i = 0; i < rows(); i++){
+          for(unsigned int j = i + 1; j < columns(); j++){
+            if((*this)(i, j) != (*this)(j, i)){
+              return false;
+            }
+          } 
+        }
+        return true;
+      }else{return false;}
+    }
+    
+    /**
+     * 
+     *
+     * @param matrix 
+     * @return (bool) ?true
+     */
+    bool isDifferentSize(const self_t &matrix) const{
+      return (rows() != matrix.rows()) || (columns() != matrix.columns());
+    }
+    
+    /**
+     * ?
+     *
+     * @param do_check ?true
+     * @return (T) ?
+     */
+    FloatT trace(bool do_check = true) const {
+      assert(do_check && !isSquare());
+      FloatT tr(0);
+      for(unsigned i(0); i < rows(); i++){
+        tr += (*this)(i, i);
+      }
+      return tr;
+    }
+    
+    /**
+     * ?
+     * 
+     * @param scalar ?
+     * @return (self_t) 
+     */
+    self_t &operator*=(const FloatT &scalar){
+      typename storage_t::symmetric_view_t sv;
+      if(m_Storage->symmetric_view(sv)){
+        detach();
+        m_Storage->symmetric_view(sv);
+        const int size((int)Array2D_SymmetricPacked<FloatT>::packed_size(sv.size));
+        mat_scale(1, size, scalar, sv.buffer, size, 1);
+        return *this;
+      }
+      typename storage_t::sparse_view_t sp;
+      if(m_Storage->sparse_view(sp)){
+        detach();
+        m_Storage->sparse_view(sp);
+        const int nnz(sp.offsets[sp.column_major ? sp.columns : sp.rows]);
+        mat_scale(1, nnz, scalar, sp.values, nnz, 1);
+        return *this;
+      }
+      typename storage_t::band_view_t bv;
+      if(m_Storage->band_view(bv)){
+        detach();
+        m_Storage->band_view(bv);
+        mat_band_scale((int)bv.rows, (int)bv.columns, scalar, 
+            bv.buffer, bv.row_stride, bv.column_stride, bv.lower, bv.upper);
+        return *this;
+      }
+      scale_kernel_t kernel = {rows(), columns(), scalar};
+      apply_dense(kernel);
+      return *this;
+    }
+    /**
+     * ??
+     * 
+     * @param scalar ?
+     * @return (self_t) 
+     */
+    self_t &operator/=(const FloatT &scalar){return (*this) *= (1 / scalar);}
+    
+    /**
+     * ?
+     * 
+     * @param matrix 
+     * @return (self_t) 
+     */
+    self_t &operator+=(const self_t &matrix){
+      assert(rows() == matrix.rows() && columns() == matrix.columns());
+      if(add_symmetric(matrix, FloatT(1)) || add_band(matrix, FloatT(1))){return *this;}
+      dense_view_t x(matrix);
+      axpy_kernel_t kernel = {rows(), columns(), FloatT(1), &x};
+      apply_dense(kernel);
+      return *this;
+    }
+
+    /**
+     * Addition of an element-wise expression in place, in a single pass.
+     * 
+     * @param expr expression
+     * @return (self_t) myself
+     */
+    template <class E>
+    self_t &operator+=(const Matrix_Expression<E> &expr){
+      assign_expression(*this + expr);
+      return *this;
+    }
+    
+    /**
+     * 
+     * 
+     * @param matrix 
+     * @return (self_t) 
+     */
+    self_t &operator-=(const self_t &matrix){
+      assert(rows() == matrix.rows() && columns() == matrix.columns());
+      if(add_symmetric(matrix, FloatT(-1)) || add_band(matrix, FloatT(-1))){return *this;}
+      dense_view_t x(matrix);
+      axpy_kernel_t kernel = {rows(), columns(), FloatT(-1), &x};
+      apply_dense(kernel);
+      return *this;
+    }
+    
+    /**
+     * Subtraction of an element-wise expression in place, in a single pass.
+     * 
+     * @param expr expression
+     * @return (self_t) myself
+     */
+    template <class E>
+    self_t &operator-=(const Matrix_Expression<E> &expr){
+      assign_expression(*this - expr);
+      return *this;
+    }
+    
+    /**
+     * 
+     * 
+     * @param matrix 
+     * @return (self_t) ?
+     */
+    self_t operator*(const self_t &matrix) const{
+      return mul(*this, false, matrix, false);
+    }
+    
+    /**
+     * (??)
+     *
+     * @param matrix 
+     * @return (self_t) ?
+     */
+    self_t operator*(const transposed_t &matrix) const{
+      return mul(*this, false, matrix.untranspose(), true);
+    }
+    
+    /**
+     * ?
+     *
+     * @param matrix 
+     * @return (self_t) 
+     */
+    template <class RhsMatrix>
+    self_t &operator*=(const RhsMatrix &matrix){
+      return (*this = (*this * matrix));
+    }
+    
+    
+    /**
+     * ()?
+     * 
+     * @param row ?
+     * @param column ?
+     * @return (self_t) 
+     */
+    self_t coMatrix(const unsigned int &row, const unsigned int &column) const{
+      assert(row < rows() && column < columns());
+      self_t result(rows() - 1, columns() - 1);
+      for(int i = 0; i < rows() - 1; i++){
+        for(int j = 0; j < columns() - 1; j++){
+          result(i, j) = (*this)((i < row ? i : i + 1), (j < column ? j : j + 1));
+        }  
+      }
+      return result;
+    }
+    
+    /**
+     * 
+     * 
+     * @return (FloatT) ?
+     */
+    FloatT determinant(bool do_check = false) const{
+      assert((!do_check) || isSquare());
+      self_t lu(toDense());
+      unsigned int *pivot(new unsigned int[rows()]);
+      lu.decomposeLUP(pivot);
+      FloatT det(1);
+      for(unsigned int i(0); i < rows(); i++){
+        det *= lu(i, i);
+        if(pivot[i] != i){det = -det;}
+      }
+      delete [] pivot;
+      return det;
+    }
+    
+    /**
+     * Logarithm of the absolute value of the determinant,
+     * which does not overflow or underflow even if the determinant does.
+     * It is calculated with LU decomposition with partial pivoting in O(n^3).
+     * 
+     * @param sign if not NULL, the sign of the determinant (1, -1, or 0 if singular) is stored
+     * @param do_check check whether this matrix is square
+     * @return (FloatT) log(|det|), which is -inf if singular
+     */
+    FloatT logDeterminant(int *sign = NULL, bool do_check = false) const{
+      assert((!do_check) || isSquare());
+      using std::log;
+      self_t lu(toDense());
+      unsigned int *pivot(new unsigned int[rows()]);
+      lu.decomposeLUP(pivot);
+      FloatT log_det(0);
+      int s(1);
+      for(unsigned int i(0); i < rows(); i++){
+        FloatT u_ii(lu(i, i));
+        if(u_ii < FloatT(0)){
+          u_ii = -u_ii;
+          s = -s;
+        }else if(u_ii == FloatT(0)){
+          s = 0;
+        }
+        log_det += log(u_ii);
+        if(pivot[i] != i){s = -s;}
+      }
+      delete [] pivot;
+      if(sign){*sign = s;}
+      return log_det;
+    }
+    
+    /**
+     * LU
+     * (0, 0)(n-1, n-1):  L
+     * (0, n)(n-1, 2n-1): U
+     * 
+     * @return (self_t) LU
+     */
+    self_t decomposeLU(bool do_check = false) const{
+      assert((!do_check) || isSquare());
+      unsigned int size(rows());
+      self_t LU(self_t::naked(size, size * 2));
+#define L(i, j) LU(i, j)
+#define U(i, j) LU(i, j + size)
+      for(int i = 0; i < size; i++){
+        for(int j = 0; j < size; j++){
+          if(i >= j){
+            L(i, j) = (*this)(i, j);
+            for(int k = 0; k < j; k++){
+              L(i, j) -= (L(i, k) * U(k, j));
+            }
+          }else{
+            U(i, j) = (*this)(i, j);
+            for(int k = 0; k < i; k++){
+              U(i, j) -= (L(i, k) * U(k, j));
+            }
+            U(i, j) /= L(i, i);
+          }
+        }
+        U(i, i) = 1;
+      }
+#undef L
+#undef U
+      return LU;
+    }
+    
+  protected:
+    /**
+     * Addition of a symmetric packed matrix to this symmetric packed matrix,
+     * this += alpha * matrix, on the packed elements.
+     * 
+     * @return (bool) false if either of them is not symmetric packed, 
+     * and nothing is done
+     */
+    bool add_symmetric(const self_t &matrix, const FloatT &alpha){
+      typename storage_t::symmetric_view_t sv, sv_x;
+      if((!matrix.m_Storage->symmetric_view(sv_x)) 
+          || (!m_Storage->symmetric_view(sv))){return false;}
+      detach();
+      m_Storage->symmetric_view(sv);
+      matrix.m_Storage->symmetric_view(sv_x); // this may be matrix itself
+      const int size((int)Array2D_SymmetricPacked<FloatT>::packed_size(sv.size));
+      mat_axpby(1, size, alpha, (const FloatT *)sv_x.buffer, size, 1, FloatT(1), sv.buffer, size, 1);
+      return true;
+    }
+    
+    /**
+     * Addition of a banded matrix, this += alpha * matrix, on its band.
+     * If this matrix is banded, its band must contain the one of the other,
+     * otherwise it becomes dense.
+     * 
+     * @return (bool) false if neither of them is banded, and nothing is done
+     */
+    bool add_band(const self_t &matrix, const FloatT &alpha){
+      typename storage_t::band_view_t bv;
+      if((!matrix.m_Storage->band_view(bv)) && (!m_Storage->band_view(bv))){return false;}
+      add_into(*this, matrix, alpha, FloatT(1));
+      return true;
+    }
+    
+    /**
+     * Replace the storage with a dense copy if it has structural zeros,
+     * such as the outside of the band, before they may be written.
+     * Views and copies already made keep the original storage.
+     */
+    void densify(){
+      if(!m_Storage->structured()){return;}
+      storage_t *dense(new Array2D_Dense<FloatT>(m_Storage->dense()));
+      delete m_Storage;
+      m_Storage = dense;
+    }
+    
+    /**
+     * Prepare the storage for views to write through.
+     * Restructurable storage, such as banded or sparse one, is wrapped with Array2D_Aliased
+     * so as to be shared by this matrix and the views; otherwise the buffer
+     * is detached if it is shared by copy-on-write, and is then aliased by the views.
+     */
+    void alias(){
+      if(m_Storage->restructurable()){
+        m_Storage = new Array2D_Aliased<FloatT>(m_Storage);
+      }
+      m_Storage->detach(true);
+    }
+    
+    /**
+     * Write a modified dense copy of this matrix back to the storage.
+     * Only the changed elements are written; if any of them is a structural zero
+     * of the storage, such as the outside of the band, the storage is replaced
+     * with the dense copy.
+     * 
+     * @param modified dense copy
+     */
+    void write_back(const Array2D_Dense<FloatT> &modified){
+      const storage_t &original(*m_Storage);
+      for(unsigned int i(0); i < rows(); i++){
+        for(unsigned int j(0); j < columns(); j++){
+          if((original(i, j) != modified(i, j)) && (!original.holds(i, j))){
+            delete m_Storage;
+            m_Storage = new Array2D_Dense<FloatT>(modified);
+            return;
+          }
+        }
+      }
+      for(unsigned int i(0); i < rows(); i++){
+        for(unsigned int j(0); j < columns(); j++){
+          const FloatT &value(modified(i, j));
+          if(original(i, j) != value){(*m_Storage)(i, j) = value;}
+        }
+      }
+    }
+    
+    /**
+     * Run a kernel on the dense storage of this matrix.
+     * The kernel works on the buffer directly if the storage has 
+     * its memory layout descriptor, such as dense storage and views on it,
+     * otherwise on a dense copy, whose changed elements are written back afterward
+     * (therefore sparse storage receives only its new nonzero elements; 
+     * see write_back()).
+     *
+     * @param kernel functor called with (buffer, row stride, column stride)
+     */
+    template <class Kernel>
+    void apply_dense(Kernel &kernel){
+      detach();
+      dense_view_t v(*this);
+      kernel(v.buffer, v.row_stride, v.column_stride);
+      if(v.temp){write_back(*v.temp);}
+    }
+    
+    struct scale_kernel_t {
+      unsigned int r, c;
+      FloatT alpha;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        mat_scale((int)r, (int)c, alpha, buffer, rs, cs);
+      }
+    };
+    
+    struct axpy_kernel_t {
+      unsigned int r, c;
+      FloatT alpha;
+      const view_t *x;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        mat_axpby((int)r, (int)c, alpha, 
+            (const FloatT *)x->buffer, x->row_stride, x->column_stride,
+            FloatT(1),
+            buffer, rs, cs);
+      }
+    };
+    
+    struct lup_kernel_t {
+      unsigned int n;
+      unsigned int *pivot;
+      bool regular;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        regular = mat_lu_blocked((int)n, buffer, rs, cs, pivot);
+      }
+    };
+    
+    struct cholesky_kernel_t {
+      unsigned int n;
+      bool ldl, result;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        result = ldl 
+            ? mat_ldl_blocked((int)n, buffer, rs, cs)
+            : mat_cholesky_blocked((int)n, buffer, rs, cs);
+      }
+    };
+    
+    struct triangular_solve_kernel_t {
+      const FloatT *t;
+      int t_rs, t_cs;
+      unsigned int n, m;
+      bool lower, unit, trans;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        if(trans){
+          mat_trsm_left((int)n, (int)m, t, t_cs, t_rs, !lower, unit, buffer, rs, cs);
+        }else{
+          mat_trsm_left((int)n, (int)m, t, t_rs, t_cs, lower, unit, buffer, rs, cs);
+        }
+      }
+    };
+    
+    struct band_solve_kernel_t {
+      const typename storage_t::band_view_t *a;
+      unsigned int m;
+      bool regular;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        regular = mat_band_solve((int)a->rows, (int)m, 
+            (const FloatT *)a->buffer, a->row_stride, a->column_stride, a->lower, a->upper,
+            buffer, rs, cs);
+      }
+    };
+    
+    struct lup_solve_kernel_t {
+      const FloatT *lu;
+      int lu_rs, lu_cs;
+      unsigned int n, m;
+      const unsigned int *pivot;
+      bool trans;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        if(trans){ // A^{T} = U^{T} * L^{T} * P
+          mat_trsm_left((int)n, (int)m, lu, lu_cs, lu_rs, true, false, buffer, rs, cs);
+          mat_trsm_left((int)n, (int)m, lu, lu_cs, lu_rs, false, true, buffer, rs, cs);
+          mat_swap_rows((int)n, (int)m, buffer, rs, cs, pivot, true);
+        }else{
+          mat_swap_rows((int)n, (int)m, buffer, rs, cs, pivot);
+          mat_trsm_left((int)n, (int)m, lu, lu_rs, lu_cs, true, true, buffer, rs, cs);
+          mat_trsm_left((int)n, (int)m, lu, lu_rs, lu_cs, false, false, buffer, rs, cs);
+        }
+      }
+    };
+    
+    struct qr_kernel_t {
+      unsigned int m, n;
+      FloatT *tau;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        mat_qr_blocked((int)m, (int)n, buffer, rs, cs, tau);
+      }
+    };
+    
+    struct qr_multiply_kernel_t {
+      const FloatT *qr;
+      int qr_rs, qr_cs;
+      unsigned int m, k, n;
+      const FloatT *tau;
+      bool trans;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        mat_qr_multiply((int)m, (int)k, (int)n, qr, qr_rs, qr_cs, tau, trans, buffer, rs, cs);
+      }
+    };
+    
+    struct tridiagonal_kernel_t {
+      unsigned int n;
+      FloatT *d, *e, *tau;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        mat_tridiagonalize((int)n, buffer, rs, cs, d, e, tau);
+      }
+    };
+    
+    struct eigen_vector_kernel_t {
+      const FloatT *a;
+      int a_rs, a_cs;
+      unsigned int n;
+      const FloatT *tau;
+      FloatT *d, *e;
+      bool converged;
+      void operator()(FloatT *buffer, const int &rs, const int &cs){
+        // V is formed in the transposed layout, whose columns are contiguous,
+        // so that the rotations of the QL iterations sweep them in unit stride
+        if(n > 1){ // Q = diag(1, Q'), where Q' is given as QR of A[1:n, 0:n-1]
+          mat_qr_multiply((int)n - 1, (int)n - 1, (int)n - 1,
+              a + a_rs, a_rs, a_cs, tau, false,
+              buffer + rs + cs, cs, rs);
+        }
+        converged = mat_tridiagonal_ql((int)n, d, e, buffer, cs, rs);
+      }
+    };
+    
+    /**
+     * Solve op(A) * X = B in place, where op(A) is this square matrix A, 
+     * or A^{T} if trans is true, and B is overwritten by X.
+     * The factorization is selected with the storage of A; 
+     * banded storage is solved with mat_band_solve() directly, 
+     * symmetric packed one with Cholesky decomposition 
+     * (or LU decomposition if it is not positive definite),
+     * and the others with LU decomposition with partial pivoting.
+     * The factor is calculated in a dense copy of A, 
+     * and X is solved in the buffer of B without any further temporary.
+     * 
+     * @param x right hand side B, which is overwritten by X
+     * @param trans true if A^{T} * X = B is solved
+     * @return (bool) false if A is singular
+     */
+    bool solve_in_place(self_t &x, const bool &trans = false) const {
+      assert(isSquare() && (rows() == x.rows()));
+      const unsigned int n(rows()), m(x.columns());
+      typename storage_t::band_view_t bv;
+      if(m_Storage->band_view(bv)){
+        if(trans){bv = bv.transpose();}
+        band_solve_kernel_t kernel = {&bv, m, true};
+        x.apply_dense(kernel);
+        return kernel.regular;
+      }
+      typename storage_t::symmetric_view_t sv;
+      if(m_Storage->symmetric_view(sv)){
+        self_t l(toDense());
+        if(l.decomposeCholesky()){ // A^{T} = A
+          dense_view_t lv(l);
+          triangular_solve_kernel_t kernel = {
+              lv.buffer, lv.row_stride, lv.column_stride, 
+              n, m, true, false, false};
+          x.apply_dense(kernel);
+          kernel.trans = true;
+          x.apply_dense(kernel);
+          return true;
+        }
+      }
+      self_t lu(toDense());
+      unsigned int *pivot(new unsigned int[n]);
+      bool regular(lu.decomposeLUP(pivot));
+      dense_view_t luv(lu);
+      lup_solve_kernel_t kernel = {
+          luv.buffer, luv.row_stride, luv.column_stride, 
+          n, m, pivot, trans};
+      x.apply_dense(kernel);
+      delete [] pivot;
+      return regular;
+    }
+    
+  public:
+    /**
+     * LU decomposition with partial pivoting, P * A = L * U, in place.
+     * This matrix is overwritten by L (strictly lower part, 
+     * whose diagonal elements are one and omitted) and U (upper part).
+     * The permutation P is returned as the row interchanges, i.e., 
+     * rows i and pivot[i] have been exchanged at step i (same as LAPACK getrf).
+     * The trailing matrix is updated blockwise with the multiplication engine.
+     * 
+     * @param pivot buffer of the row interchanges, whose length must be rows()
+     * @param do_check check whether this matrix is square
+     * @return (bool) false if the matrix is singular
+     * @see solveLUP(const unsigned int *, const self_t &)
+     */
+    bool decomposeLUP(unsigned int *pivot, bool do_check = false){
+      assert((!do_check) || isSquare());
+      lup_kernel_t kernel = {rows(), pivot, true};
+      apply_dense(kernel);
+      return kernel.regular;
+    }
+    
+    /**
+     * Solve A * X = B with the factors of decomposeLUP().
+     * This matrix must be the result of decomposeLUP().
+     * 
+     * @param pivot row interchanges returned by decomposeLUP()
+     * @param matrix right hand side B, which can have multiple columns
+     * @return (self_t) X
+     */
+    self_t solveLUP(const unsigned int *pivot, const self_t &matrix) const{
+      assert(rows() == matrix.rows());
+      dense_view_t lu(*this);
+      self_t result(matrix.copy());
+      lup_solve_kernel_t kernel = {
+          lu.buffer, lu.row_stride, lu.column_stride, 
+          rows(), matrix.columns(), pivot, false};
+      result.apply_dense(kernel);
+      return result;
+    }
+    
+    /**
+     * Solve A * X = B, where A is this matrix, 
+     * with LU decomposition with partial pivoting, 
+     * or the factorization suitable for the storage (see solve_in_place()).
+     * 
+     * @param matrix right hand side B, which can have multiple columns
+     * @param do_check check whether this matrix is square
+     * @return (self_t) X
+     */
+    self_t solve(const self_t &matrix, bool do_check = false) const{
+      assert((!do_check) || isSquare());
+      self_t result(matrix.toDense());
+      solve_in_place(result);
+      return result;
+    }
+    
+    /**
+     * Cholesky decomposition, A = L * L^{T}, in place.
+     * This matrix must be symmetric positive definite, and only its lower part is referred.
+     * The lower part is overwritten by L, while the strictly upper part is left untouched.
+     * 
+     * @param do_check check whether this matrix is symmetric
+     * @return (bool) false if the matrix is not positive definite
+     * @see solveCholesky(const self_t &)
+     */
+    bool decomposeCholesky(bool do_check = false){
+      assert((!do_check) || isSymmetric());
+      cholesky_kernel_t kernel = {rows(), false, true};
+      apply_dense(kernel);
+      return kernel.result;
+    }
+    
+    /**
+     * LDL^{T} decomposition, A = L * D * L^{T}, in place,
+     * where L is unit lower triangular, and D is diagonal.
+     * This matrix must be symmetric, and only its lower part is referred.
+     * The strictly lower part is overwritten by L, and the diagonal by D, 
+     * so that D is stored compactly as a vector;
+     * the strictly upper part is left untouched.
+     * Unlike decomposeUD(), no square root is taken and no extra storage is allocated.
+     * 
+     * @param do_check check whether this matrix is symmetric
+     * @return (bool) false if a zero pivot appears
+     * @see solveLDL(const self_t &)
+     */
+    bool decomposeLDL(bool do_check = false){
+      assert((!do_check) || isSymmetric());
+      cholesky_kernel_t kernel = {rows(), true, true};
+      apply_dense(kernel);
+      return kernel.result;
+    }
+    
+    /**
+     * Solve T * X = B (or T^{T} * X = B), where T is this triangular matrix.
+     * Only the triangle specified by lower is referred.
+     * 
+     * @param matrix right hand side B, which can have multiple columns
+     * @param lower true if this matrix is lower triangular, otherwise upper
+     * @param unit true if the diagonal elements are assumed to be one
+     * @param trans true if T^{T} * X = B is solved
+     * @return (self_t) X
+     */
+    self_t solveTriangular(const self_t &matrix, 
+        const bool &lower, const bool &unit = false, const bool &trans = false) const{
+      assert(isSquare() && (rows() == matrix.rows()));
+      dense_view_t t(*this);
+      self_t result(matrix.copy());
+      triangular_solve_kernel_t kernel = {
+          t.buffer, t.row_stride, t.column_stride, 
+          rows(), matrix.columns(), lower, unit, trans};
+      result.apply_dense(kernel);
+      return result;
+    }
+    
+    /**
+     * Solve A * X = B with the factor of decomposeCholesky(),
+     * i.e., L * Y = B, then L^{T} * X = Y.
+     * This matrix must be the result of decomposeCholesky().
+     * 
+     * @param matrix right hand side B, which can have multiple columns
+     * @return (self_t) X
+     */
+    self_t solveCholesky(const self_t &matrix) const{
+      return solveTriangular(solveTriangular(matrix, true), true, false, true);
+    }
+    
+    /**
+     * Solve A * X = B with the factors of decomposeLDL(),
+     * i.e., L * Y = B, D * Z = Y, then L^{T} * X = Z.
+     * This matrix must be the result of decomposeLDL().
+     * 
+     * @param matrix right hand side B, which can have multiple columns
+     * @return (self_t) X
+     */
+    self_t solveLDL(const self_t &matrix) const{
+      self_t z(solveTriangular(matrix, true, true));
+      for(unsigned int i(0); i < z.rows(); i++){
+        const FloatT d_i((*this)(i, i));
+        for(unsigned int j(0); j < z.columns(); j++){z(i, j) /= d_i;}
+      }
+      return solveTriangular(z, true, true, true);
+    }
+    
+    /**
+     * Householder QR decomposition, A = Q * R, in place,
+     * where A is this m x n matrix, which can be a partial view.
+     * The upper trapezoid is overwritten by R, and the part below the diagonal 
+     * by the Householder vectors v_j, whose first elements are one and omitted, i.e., 
+     * Q = H_0 * H_1 * ... * H_{k-1}, H_j = I - tau[j] * v_j * v_j^{T}, k = min(m, n)
+     * (same as LAPACK geqrf).
+     * The trailing matrix is updated blockwise in the compact WY representation
+     * with the multiplication engine.
+     * 
+     * @param tau buffer of the scalar factors, whose length must be min(rows(), columns())
+     * @see multiplyQ(const FloatT *, const self_t &, const bool &)
+     */
+    void decomposeQR(FloatT *tau){
+      qr_kernel_t kernel = {rows(), columns(), tau};
+      apply_dense(kernel);
+    }
+    
+    /**
+     * Multiplication by Q of decomposeQR(), Q * B, or Q^{T} * B if trans is true.
+     * This matrix must be the result of decomposeQR().
+     * 
+     * @param tau scalar factors returned by decomposeQR()
+     * @param matrix B, whose number of rows is rows()
+     * @param trans true if Q^{T} * B is calculated
+     * @return (self_t) Q * B or Q^{T} * B
+     */
+    self_t multiplyQ(const FloatT *tau, const self_t &matrix, const bool &trans = false) const{
+      assert(rows() == matrix.rows());
+      dense_view_t qr(*this);
+      self_t result(matrix.toDense());
+      qr_multiply_kernel_t kernel = {
+          qr.buffer, qr.row_stride, qr.column_stride, 
+          rows(), ((rows() < columns()) ? rows() : columns()), matrix.columns(),
+          tau, trans};
+      result.apply_dense(kernel);
+      return result;
+    }
+    
+    /**
+     * Householder QR decomposition, A = Q * R, where A is this m x n matrix.
+     * If thin is true (default), Q is m x k with orthonormal columns 
+     * and R is k x n upper trapezoidal, k = min(m, n), which is sufficient for 
+     * A = Q * R (thin QR); otherwise Q is m x m orthogonal, and R is m x n.
+     * 
+     * @param q Q, which is overwritten
+     * @param r R, which is overwritten
+     * @param thin true if the thin QR is calculated
+     * @see decomposeQR(FloatT *)
+     */
+    void decomposeQR(self_t &q, self_t &r, const bool &thin = true) const{
+      const unsigned int m(rows()), n(columns()), k((m < n) ? m : n), q_columns(thin ? k : m);
+      self_t qr(toDense());
+      FloatT *tau(new FloatT[k]);
+      qr.decomposeQR(tau);
+      r = self_t(q_columns, n);
+      for(unsigned int i(0); i < k; i++){
+        for(unsigned int j(i); j < n; j++){r(i, j) = qr(i, j);}
+      }
+      self_t e(m, q_columns);
+      for(unsigned int i(0); i < q_columns; i++){e(i, i) = FloatT(1);}
+      q = qr.multiplyQ(tau, e);
+      delete [] tau;
+    }
+    
+    /**
+     * Least squares solution X, which minimizes ||A * X - B|| (Frobenius norm),
+     * where A is this m x n matrix of full rank, with Householder QR decomposition.
+     * A^{T} * A is never formed, therefore the condition number is not squared.
+     * If m >= n, R * X = (Q^{T} * B)[0:n] is solved with A = Q * R; otherwise
+     * (underdetermined), the minimum norm solution X = Q * [R^{-T} * B; 0]
+     * is obtained with A^{T} = Q * R.
+     * 
+     * @param matrix right hand side B, which can have multiple columns
+     * @return (self_t) X, whose number of rows is columns()
+     */
+    self_t leastSquares(const self_t &matrix) const{
+      assert(rows() == matrix.rows());
+      const unsigned int m(rows()), n(columns()), p(matrix.columns());
+      if(m >= n){
+        self_t qr(toDense());
+        FloatT *tau(new FloatT[n]);
+        qr.decomposeQR(tau);
+        self_t c(qr.multiplyQ(tau, matrix, true));
+        delete [] tau;
+        return qr.partial(n, n, 0, 0).solveTriangular(c.partial(n, p, 0, 0), false);
+      }else{
+        self_t qr(transpose().toDense());
+        FloatT *tau(new FloatT[m]);
+        qr.decomposeQR(tau);
+        self_t y(n, p);
+        y.partial(m, p, 0, 0) = qr.partial(m, m, 0, 0).solveTriangular(matrix, false, false, true);
+        self_t x(qr.multiplyQ(tau, y));
+        delete [] tau;
+        return x;
+      }
+    }
+    
+    /**
+     * Eigen decomposition of this symmetric matrix, A = V * diag(lambda) * V^{T},
+     * with Householder tridiagonalization and the implicit QL method 
+     * (see mat_tridiagonalize() and mat_tridiagonal_ql()).
+     * This matrix is either dense, whose both triangles are referred, 
+     * or symmetric packed, and is not modified.
+     * If the eigenvectors are not required, the QL iterations cost only O(n^2),
+     * therefore the cost is dominated by the tridiagonalization.
+     * 
+     * @param values overwritten by the eigenvalues in ascending order (n x 1)
+     * @param vectors if not NULL, overwritten by orthogonal V (n x n), 
+     * whose column j is the eigenvector corresponding to the j-th eigenvalue
+     * @param do_check check whether this matrix is symmetric
+     * @return (bool) false if the QL iterations do not converge
+     */
+    bool decomposeEigenSymmetric(
+        self_t &values, self_t *vectors = NULL, bool do_check = false) const{
+      assert(isSquare() && ((!do_check) || isSymmetric()));
+      const unsigned int n(rows());
+      FloatT *work(new FloatT[n * 3 + 1]), *d(work), *e(d + n), *tau(e + n);
+      self_t a(toDense());
+      tridiagonal_kernel_t kernel = {n, d, e, tau};
+      a.apply_dense(kernel);
+      bool converged;
+      if(vectors){
+        dense_view_t av(a);
+        eigen_vector_kernel_t kernel_v = {
+            av.buffer, av.row_stride, av.column_stride, n, tau, d, e, true};
+        self_t z_t(getI(n).toDense());
+        z_t.apply_dense(kernel_v);
+        converged = kernel_v.converged;
+        *vectors = z_t.transpose().toDense();
+      }else{
+        converged = mat_tridiagonal_ql((int)n, d, e, (FloatT *)NULL, 0, 0);
+      }
+      values = self_t(n, 1);
+      for(unsigned int i(0); i < n; i++){values(i, 0) = d[i];}
+      delete [] work;
+      return converged;
+    }
+     
+    /**
+     * UD
+     * (0, 0)(n-1,n-1):  U
+     * (0, n)(n-1,2n-1): D
+     * 
+     * @return (self_t) UD
+     */
+    self_t decomposeUD(bool do_check = false) const{
+      assert((!do_check) || isSymmetric());
+      unsigned int size(rows());
+      self_t P(copy());
+      self_t UD(size, size * 2);
+#define U(i, j) UD(i, j)
+#define D(i, j) UD(i, j + size)
+      for(int i = size - 1; i >= 0; i--){
+        D(i, i) = P(i, i);
+        U(i, i) = FloatT(1);      
+        for(int j = 0; j < i; j++){
+          U(j, i) = P(j, i) / D(i, i);
+          for(int k = 0; k <= j; k++){
+            P(k, j) -= U(k, i) * D(i, i) * U(j, i);
+          }
+        }
+      }
+#undef U
+#undef D
+      return UD;
+    }
+    
+    /**
+     * Inverse matrix. 
+     * Symmetric matrices, which are stored in symmetric packed storage
+     * or are found to be symmetric, are inverted with Cholesky decomposition
+     * A = L * L^{T} as A^{-1} = L^{-T} * L^{-1}, whose symmetric product is
+     * calculated by symmetric_rank_k_into() and the storage is kept.
+     * The others, as well as the symmetric ones which are not positive definite, 
+     * are inverted with LU decomposition with partial pivoting
+     * (or mat_band_solve() for banded storage), 
+     * and diagonal storage is inverted elementwise.
+     * If the matrix is singular, the result has infinite or NaN elements.
+     * To solve a linear system, solve() or operator/ is faster and more accurate 
+     * than the multiplication with the inverse.
+     * 
+     * @param do_check check whether this matrix is square
+     * @return (self_t) inverse
+     */
+    self_t inverse(bool do_check = false) const{
+      assert((!do_check) || isSquare());
+      
+      const unsigned int size(rows());
+      
+      typename storage_t::band_view_t bv;
+      if(m_Storage->band_view(bv)){
+        if((bv.lower == 0) && (bv.upper == 0)){
+          self_t result(copy());
+          result.detach();
+          result.storage()->band_view(bv);
+          for(unsigned int i(0); i < size; i++){
+            FloatT &d(bv.buffer[i * (bv.row_stride + bv.column_stride)]);
+            d = FloatT(1) / d;
+          }
+          return result;
+        }
+      }else{
+        typename storage_t::symmetric_view_t sv;
+        const bool packed(m_Storage->symmetric_view(sv));
+        if(packed || isSymmetric()){
+          self_t l(toDense());
+          if(l.decomposeCholesky()){
+            self_t l_inv(l.solveTriangular(getI(size).toDense(), true));
+            self_t result(packed ? getSymmetricPacked(size) : self_t(size, size));
+            return symmetric_rank_k_into(result, l_inv, FloatT(1), FloatT(0), true);
+          }
+        }
+      }
+      
+      self_t result(getI(size).toDense());
+      solve_in_place(result);
+      return result;
+    }
+    /**
+     * Division by a matrix from the right, A = A * B^{-1}, 
+     * which is solved as B^{T} * X^{T} = A^{T} without the inverse of B 
+     * (see solve_in_place()). X^{T} is solved in a transposed copy, 
+     * whose rows are contiguous, and then is transposed back to this matrix.
+     * 
+     * @param matrix B, which is square
+     * @return (self_t) A * B^{-1}
+     */
+    self_t &operator/=(const self_t &matrix){
+      self_t x_t(transpose().toDense());
+      matrix.solve_in_place(x_t, true);
+      return scale_into(*this, x_t, FloatT(1), true);
+    }
+    /**
+     * Division by a matrix from the right, A * B^{-1}, see operator/=(const self_t &).
+     * 
+     * @param matrix B, which is square
+     * @return (self_t) A * B^{-1}
+     */
+    self_t operator/(const self_t &matrix) const{
+      self_t x_t(transpose().toDense());
+      matrix.solve_in_place(x_t, true);
+      return x_t.transpose().toDense();
+    }
+    
+    /**
+     * 
+     * 
+     * 
+     * @param row ?
+     * @param column ?
+     * @param matrix 
+     */
+    self_t pivotMerge(const int &row, const int &column, const self_t &matrix){
+      for(int i = 0; i < matrix.rows(); i++){
+        if(row + i < 0){continue;}
+        else if(row + i >= rows()){break;}
+        for(int j = 0; j < matrix.columns(); j++){
+          if(column + j < 0){continue;}
+          else if(column + j >= columns()){break;}
+          (*this)(row + i, column + j) += matrix(i, j);
+        }
+      }
+      return *this;
+    }
+    
+    /**
+     * 
+     * 
+     * @param row ?
+     * @param column ?
+     * @param matrix 
+     */
+    self_t pivotAdd(const int &row, const int &column, const self_t &matrix) const{
+      return copy().pivotMerge(row, column, matrix);
+    }
+    
+    /**
+     * 以易於閱讀的格式輸出矩陣。
+     * 
+     */
+    void inspect(char *buffer, int buffer_size) const{
+      using std::snprintf;
+      if(m_Storage){
+        int printed;
+        printed = snprintf(buffer, buffer_size, "{");
+        printf("%s",buffer);
+        buffer += printed;
+        buffer_size -= printed;
+        for(unsigned int i = 0; i < rows(); i++){
+          printed = snprintf(buffer, buffer_size, (i == 0 ? "\n{" : ",\n{"));
+          printf("%s",buffer);
+          buffer += printed;
+          buffer_size -= printed;
+          for(unsigned int j = 0; j < columns(); j++){
+            /*printed = printf((j == 0 ? "%f" : ",%f"), 
+                               const_cast<self_t *>(this)->operator()(i, j));*/
+            printed = snprintf(buffer, buffer_size, (j == 0 ? "%f" : ",%f"), 
+                               (*this)(i, j));
+            printf("%s",buffer);
+            buffer += printed;
+            buffer_size -= printed;
+          }
+          printed = snprintf(buffer, buffer_size, "}");
+          printf("%s",buffer);
+          buffer += printed;
+          buffer_size -= printed;
+        }
+        snprintf(buffer, buffer_size, "\n}");
+        printf("%s",buffer);
+      }
+    }
+};
+
+/*
+ * Allocation-free operations
+ * 
+ * They write the result into the storage of a caller-owned matrix,
+ * which may be a view such as a PartialMatrix, without allocating a new one.
+ * A transposed operand is specified by the flag, so that no view is created.
+ * Operands whose storage has no memory layout descriptor are copied densely,
+ * which is the only case where heap memory is allocated 
+ * (except for the first multiplication of the largest size on each thread, 
+ * which allocates the packing workspace).
+ */
+
+/**
+ * General matrix multiplication in place, C = alpha * op(A) * op(B) + beta * C,
+ * where op(X) is X, or X^{T} if the corresponding flag is true.
+ * A symmetric packed, sparse, or banded (including diagonal and triangular) 
+ * operand is multiplied by its own kernel, i.e., mat_symm_packed(), 
+ * mat_sparse_mm(), or mat_band_mm(), on its stored elements.
+ * C must not share its memory with A or B.
+ * If beta is zero, C is not read.
+ *
+ * @param C destination, r1 x c2
+ * @param A left operand, op(A) is r1 x c1
+ * @param B right operand, op(B) is c1 x c2
+ * @param alpha coefficient of the product
+ * @param beta coefficient of C
+ * @param a_trans true if A^{T} is multiplied
+ * @param b_trans true if B^{T} is multiplied
+ * @return (Matrix<FloatT>) C
+ */
+template <class FloatT>
+Matrix<FloatT> &multiply_into(
+    Matrix<FloatT> &C, const Matrix<FloatT> &A, const Matrix<FloatT> &B,
+    const typename Matrix<FloatT>::value_t &alpha = 1,
+    const typename Matrix<FloatT>::value_t &beta = 0,
+    const bool &a_trans = false, const bool &b_trans = false){
+  unsigned int r1(a_trans ? A.columns() : A.rows()), 
+      c1(a_trans ? A.rows() : A.columns()),
+      c2(b_trans ? B.rows() : B.columns());
+  assert((c1 == (b_trans ? B.columns() : B.rows()))
+      && (C.rows() == r1) && (C.columns() == c2));
+  C.detach();
+  typename Matrix<FloatT>::view_t c;
+  if(!C.storage()->view(c)){
+    Matrix<FloatT> temp(C.rows(), C.columns());
+    if(beta != FloatT(0)){add_into(temp, C);}
+    multiply_into(temp, A, B, alpha, beta, a_trans, b_trans);
+    C = temp;
+    return C;
+  }
+  typename Matrix<FloatT>::storage_t::symmetric_view_t s;
+  if(A.storage()->symmetric_view(s)){ // op(A) = A
+    typename Matrix<FloatT>::dense_view_t b(B);
+    mat_symm_packed((int)r1, (int)c2,
+        alpha, (const FloatT *)s.buffer,
+        (const FloatT *)b.buffer, 
+        (b_trans ? b.column_stride : b.row_stride), 
+        (b_trans ? b.row_stride : b.column_stride),
+        beta,
+        c.buffer, c.row_stride, c.column_stride);
+    return C;
+  }else if(B.storage()->symmetric_view(s)){ // C^{T} = B * op(A)^{T}
+    typename Matrix<FloatT>::dense_view_t a(A);
+    mat_symm_packed((int)c2, (int)r1,
+        alpha, (const FloatT *)s.buffer,
+        (const FloatT *)a.buffer, 
+        (a_trans ? a.row_stride : a.column_stride), 
+        (a_trans ? a.column_stride : a.row_stride),
+        beta,
+        c.buffer, c.column_stride, c.row_stride);
+    return C;
+  }
+  typename Matrix<FloatT>::storage_t::sparse_view_t sp;
+  if(A.storage()->sparse_view(sp)){ // op(A) is either CSR or its transpose
+    typename Matrix<FloatT>::dense_view_t b(B);
+    mat_sparse_mm((sp.column_major != a_trans),
+        (int)(sp.column_major ? sp.columns : sp.rows), 
+        (int)(sp.column_major ? sp.rows : sp.columns),
+        (int)c2,
+        alpha, 
+        (const int *)sp.offsets, (const int *)sp.indices, (const FloatT *)sp.values,
+        (const FloatT *)b.buffer, 
+        (b_trans ? b.column_stride : b.row_stride), 
+        (b_trans ? b.row_stride : b.column_stride),
+        beta,
+        c.buffer, c.row_stride, c.column_stride);
+    return C;
+  }else if(B.storage()->sparse_view(sp)){ // C^{T} = op(B)^{T} * op(A)^{T}
+    typename Matrix<FloatT>::dense_view_t a(A);
+    mat_sparse_mm((sp.column_major == b_trans),
+        (int)(sp.column_major ? sp.columns : sp.rows), 
+        (int)(sp.column_major ? sp.rows : sp.columns),
+        (int)r1,
+        alpha, 
+        (const int *)sp.offsets, (const int *)sp.indices, (const FloatT *)sp.values,
+        (const FloatT *)a.buffer, 
+        (a_trans ? a.row_stride : a.column_stride), 
+        (a_trans ? a.column_stride : a.row_stride),
+        beta,
+        c.buffer, c.column_stride, c.row_stride);
+    return C;
+  }
+  typename Matrix<FloatT>::storage_t::band_view_t bv;
+  if(A.storage()->band_view(bv)){ // op(A) is banded
+    if(a_trans){bv = bv.transpose();}
+    typename Matrix<FloatT>::dense_view_t b(B);
+    mat_band_mm((int)r1, (int)c1, (int)c2,
+        alpha,
+        (const FloatT *)bv.buffer, bv.row_stride, bv.column_stride, bv.lower, bv.upper,
+        (const FloatT *)b.buffer, 
+        (b_trans ? b.column_stride : b.row_stride), 
+        (b_trans ? b.row_stride : b.column_stride),
+        beta,
+        c.buffer, c.row_stride, c.column_stride);
+    return C;
+  }else if(B.storage()->band_view(bv)){ // C^{T} = op(B)^{T} * op(A)^{T}
+    if(!b_trans){bv = bv.transpose();}
+    typename Matrix<FloatT>::dense_view_t a(A);
+    mat_band_mm((int)c2, (int)c1, (int)r1,
+        alpha,
+        (const FloatT *)bv.buffer, bv.row_stride, bv.column_stride, bv.lower, bv.upper,
+        (const FloatT *)a.buffer, 
+        (a_trans ? a.row_stride : a.column_stride), 
+        (a_trans ? a.column_stride : a.row_stride),
+        beta,
+        c.buffer, c.column_stride, c.row_stride);
+    return C;
+  }
+  typename Matrix<FloatT>::dense_view_t a(A), b(B);
+  mat_mul_blocked((int)r1, (int)c1, (int)c2,
+      alpha,
+      (const FloatT *)a.buffer, 
+      (a_trans ? a.column_stride : a.row_stride), 
+      (a_trans ? a.row_stride : a.column_stride),
+      (const FloatT *)b.buffer, 
+      (b_trans ? b.column_stride : b.row_stride), 
+      (b_trans ? b.row_stride : b.column_stride),
+      beta,
+      c.buffer, c.row_stride, c.column_stride);
+  return C;
+}
+
+/**
+ * Addition in place, C = alpha * op(A) + beta * C,
+ * where op(A) is A, or A^{T} if a_trans is true.
+ * If beta is zero, C is not read.
+ *
+ * @param C destination
+ * @param A operand, which can be C itself if a_trans is false
+ * @param alpha coefficient of A
+ * @param beta coefficient of C
+ * @param a_trans true if A^{T} is added
+ * @return (Matrix<FloatT>) C
+ */
+template <class FloatT>
+Matrix<FloatT> &add_into(
+    Matrix<FloatT> &C, const Matrix<FloatT> &A,
+    const typename Matrix<FloatT>::value_t &alpha = 1,
+    const typename Matrix<FloatT>::value_t &beta = 1,
+    const bool &a_trans = false){
+  assert((C.rows() == (a_trans ? A.columns() : A.rows()))
+      && (C.columns() == (a_trans ? A.rows() : A.columns())));
+  C.detach();
+  typename Matrix<FloatT>::storage_t::symmetric_view_t s_c, s_a;
+  if(C.storage()->symmetric_view(s_c) && A.storage()->symmetric_view(s_a)){ // op(A) = A
+    const int size((int)Array2D_SymmetricPacked<FloatT>::packed_size(s_c.size));
+    mat_axpby(1, size, 
+        alpha, (const FloatT *)s_a.buffer, size, 1, 
+        beta, s_c.buffer, size, 1);
+    return C;
+  }
+  typename Matrix<FloatT>::view_t c;
+  typename Matrix<FloatT>::storage_t::band_view_t b_c, b_a;
+  if(A.storage()->band_view(b_a)){ // only the band of op(A) is added
+    if(a_trans){b_a = b_a.transpose();}
+    if(C.storage()->band_view(b_c) 
+        && (b_a.lower <= b_c.lower) && (b_a.upper <= b_c.upper)){
+      c.buffer = b_c.buffer;
+      c.row_stride = b_c.row_stride;
+      c.column_stride = b_c.column_stride;
+      mat_band_scale((int)C.rows(), (int)C.columns(), beta, 
+          c.buffer, c.row_stride, c.column_stride, b_c.lower, b_c.upper);
+    }else if(C.storage()->view(c)){
+      mat_band_scale((int)C.rows(), (int)C.columns(), beta, 
+          c.buffer, c.row_stride, c.column_stride, (int)C.rows(), (int)C.columns());
+    }else{
+      c.buffer = NULL;
+    }
+    if(c.buffer){
+      mat_band_axpy((int)C.rows(), (int)C.columns(), 
+          alpha, 
+          (const FloatT *)b_a.buffer, b_a.row_stride, b_a.column_stride, b_a.lower, b_a.upper,
+          c.buffer, c.row_stride, c.column_stride);
+      return C;
+    }
+  }
+  if(!C.storage()->view(c)){
+    Matrix<FloatT> temp(C.rows(), C.columns());
+    if(beta != FloatT(0)){add_into(temp, C);}
+    add_into(temp, A, alpha, beta, a_trans);
+    C = temp;
+    return C;
+  }
+  typename Matrix<FloatT>::dense_view_t a(A);
+  mat_axpby((int)C.rows(), (int)C.columns(),
+      alpha,
+      (const FloatT *)a.buffer, 
+      (a_trans ? a.column_stride : a.row_stride), 
+      (a_trans ? a.row_stride : a.column_stride),
+      beta,
+      c.buffer, c.row_stride, c.column_stride);
+  return C;
+}
+
+/**
+ * Symmetric rank-k update in place, C = alpha * op(A) * op(A)^{T} + beta * C,
+ * where op(A) is A, or A^{T} if a_trans is true, e.g., 
+ * the covariance of the samples in the rows of X is obtained with a_trans = true.
+ * Only the upper triangle is calculated, which halves the multiply-adds.
+ * C is either symmetric packed (see Matrix::getSymmetricPacked()) or
+ * dense, in which the lower triangle is copied from the upper one.
+ * C must be symmetric unless beta is zero, in which case C is not read.
+ *
+ * @param C destination, n x n
+ * @param A operand, op(A) is n x k
+ * @param alpha coefficient of the product
+ * @param beta coefficient of C
+ * @param a_trans true if A^{T} * A is calculated
+ * @return (Matrix<FloatT>) C
+ */
+template <class FloatT>
+Matrix<FloatT> &symmetric_rank_k_into(
+    Matrix<FloatT> &C, const Matrix<FloatT> &A,
+    const typename Matrix<FloatT>::value_t &alpha = 1,
+    const typename Matrix<FloatT>::value_t &beta = 0,
+    const bool &a_trans = false){
+  unsigned int n(a_trans ? A.columns() : A.rows()), k(a_trans ? A.rows() : A.columns());
+  assert((C.rows() == n) && (C.columns() == n));
+  C.detach();
+  typename Matrix<FloatT>::dense_view_t a(A);
+  typename Matrix<FloatT>::storage_t::symmetric_view_t s;
+  if(C.storage()->symmetric_view(s)){
+    mat_syrk_packed((int)n, (int)k,
+        alpha,
+        (const FloatT *)a.buffer, 
+        (a_trans ? a.column_stride : a.row_stride), 
+        (a_trans ? a.row_stride : a.column_stride),
+        beta, s.buffer);
+    return C;
+  }
+  typename Matrix<FloatT>::view_t c;
+  if(!C.storage()->view(c)){
+    Matrix<FloatT> temp(C.rows(), C.columns());
+    if(beta != FloatT(0)){add_into(temp, C);}
+    symmetric_rank_k_into(temp, A, alpha, beta, a_trans);
+    C = temp;
+    return C;
+  }
+  mat_syrk((int)n, (int)k,
+      alpha,
+      (const FloatT *)a.buffer, 
+      (a_trans ? a.column_stride : a.row_stride), 
+      (a_trans ? a.row_stride : a.column_stride),
+      beta, 
+      c.buffer, c.row_stride, c.column_stride);
+  return C;
+}
+
+/**
+ * Scaling (or copy) in place, C = alpha * op(A),
+ * where op(A) is A, or A^{T} if a_trans is true.
+ *
+ * @param C destination
+ * @param A operand, which can be C itself if a_trans is false
+ * @param alpha coefficient
+ * @param a_trans true if A^{T} is scaled
+ * @return (Matrix<FloatT>) C
+ */
+template <class FloatT>
+Matrix<FloatT> &scale_into(
+    Matrix<FloatT> &C, const Matrix<FloatT> &A,
+    const typename Matrix<FloatT>::value_t &alpha = 1,
+    const bool &a_trans = false){
+  return add_into(C, A, alpha, FloatT(0), a_trans);
+}
+
+/**
+ * Evaluate an element-wise expression into C in place, in a single pass.
+ * Unlike assignment to a Matrix, which replaces its storage, 
+ * the current storage of C is overwritten.
+ *
+ * @param C destination, which can appear in the expression
+ * @param expr expression such as a + b * 2
+ * @return (Matrix<FloatT>) C
+ */
+template <class FloatT, class E>
+Matrix<FloatT> &assign_into(
+    Matrix<FloatT> &C, const Matrix_Expression<E> &expr){
+  C.assign_expression(expr.expression());
+  return C;
+}
+
+/*
+ * Fixed-size matrix
+ * 
+ * The dimensions are given as template arguments, so that the elements are
+ * held in the object itself (on the stack), mismatched dimensions are
+ * rejected at compile time, and the loops with constant trip counts are
+ * completely unrolled by the compiler.
+ * No heap allocation, reference counting, or virtual function call happens;
+ * explicit conversion from / to Matrix is provided to interoperate with the dynamic API,
+ * which is not implicit in order to keep the dimension check at compile time.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 8)
+#define MATRIX_FIXED_UNROLL _Pragma("GCC unroll 16")
+#else
+#define MATRIX_FIXED_UNROLL
+#endif
+
+template <class FloatT, unsigned int R, unsigned int C>
+class FixedMatrix;
+
+/**
+ * Compile-time assertion, where FixedMatrix_StaticAssert<false> is incomplete
+ */
+template <bool>
+struct FixedMatrix_StaticAssert;
+template <>
+struct FixedMatrix_StaticAssert<true> {};
+
+/**
+ * Determinant and inverse of a N x N fixed-size matrix, 
+ * which are specialized with closed forms for small N.
+ * The generic one uses Gauss-Jordan elimination with partial pivoting.
+ */
+template <class FloatT, unsigned int N>
+struct FixedMatrix_Square {
+  typedef FixedMatrix<FloatT, N, N> mat_t;
+  
+  static FloatT determinant(const mat_t &m){
+    FloatT a[N][N];
+    for(unsigned int i(0); i < N; i++){
+      for(unsigned int j(0); j < N; j++){a[i][j] = m(i, j);}
+    }
+    FloatT det(1);
+    for(unsigned int k(0); k < N; k++){
+      unsigned int p(k);
+      for(unsigned int i(k + 1); i < N; i++){
+        if(std::abs(a[i][k]) > std::abs(a[p][k])){p = i;}
+      }
+      if(a[p][k] == FloatT(0)){return FloatT(0);}
+      if(p != k){
+        for(unsigned int j(k); j < N; j++){
+          FloatT temp(a[k][j]); a[k][j] = a[p][j]; a[p][j] = temp;
+        }
+        det = -det;
+      }
+      det *= a[k][k];
+      for(unsigned int i(k + 1); i < N; i++){
+        FloatT l(a[i][k] / a[k][k]);
+        for(unsigned int j(k + 1); j < N; j++){a[i][j] -= l * a[k][j];}
+      }
+    }
+    return det;
+  }
+  
+  static mat_t inverse(const mat_t &m){
+    mat_t left(m), right(mat_t::getI());
+    for(unsigned int k(0); k < N; k++){
+      unsigned int p(k);
+      for(unsigned int i(k + 1); i < N; i++){
+        if(std::abs(left(i, k)) > std::abs(left(p, k))){p = i;}
+      }
+      assert(left(p, k) != FloatT(0));
+      if(p != k){
+        for(unsigned int j(0); j < N; j++){
+          FloatT temp;
+          temp = left(k, j); left(k, j) = left(p, j); left(p, j) = temp;
+          temp = right(k, j); right(k, j) = right(p, j); right(p, j) = temp;
+        }
+      }
+      FloatT pivot_inv(FloatT(1) / left(k, k));
+      for(unsigned int j(0); j < N; j++){
+        left(k, j) *= pivot_inv;
+        right(k, j) *= pivot_inv;
+      }
+      for(unsigned int i(0); i < N; i++){
+        if(i == k){continue;}
+        FloatT l(left(i, k));
+        for(unsigned int j(0); j < N; j++){
+          left(i, j) -= l * left(k, j);
+          right(i, j) -= l * right(k, j);
+        }
+      }
+    }
+    return right;
+  }
+};
+
+template <class FloatT>
+struct FixedMatrix_Square<FloatT, 1> {
+  typedef FixedMatrix<FloatT, 1, 1> mat_t;
+  static FloatT determinant(const mat_t &m){return m(0, 0);}
+  static mat_t inverse(const mat_t &m){
+    assert(m(0, 0) != FloatT(0));
+    mat_t res;
+    res(0, 0) = FloatT(1) / m(0, 0);
+    return res;
+  }
+};
+
+template <class FloatT>
+struct FixedMatrix_Square<FloatT, 2> {
+  typedef FixedMatrix<FloatT, 2, 2> mat_t;
+  static FloatT determinant(const mat_t &m){
+    return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+  }
+  static mat_t inverse(const mat_t &m){
+    FloatT det(determinant(m));
+    assert(det != FloatT(0));
+    FloatT det_inv(FloatT(1) / det);
+    mat_t res;
+    res(0, 0) =  m(1, 1) * det_inv; res(0, 1) = -m(0, 1) * det_inv;
+    res(1, 0) = -m(1, 0) * det_inv; res(1, 1) =  m(0, 0) * det_inv;
+    return res;
+  }
+};
+
+template <class FloatT>
+struct FixedMatrix_Square<FloatT, 3> {
+  typedef FixedMatrix<FloatT, 3, 3> mat_t;
+  static FloatT determinant(const mat_t &m){
+    return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+        - m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+        + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+  }
+  static mat_t inverse(const mat_t &m){
+    mat_t res;
+    res(0, 0) = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+    res(1, 0) = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+    res(2, 0) = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+    FloatT det(m(0, 0) * res(0, 0) + m(0, 1) * res(1, 0) + m(0, 2) * res(2, 0));
+    assert(det != FloatT(0));
+    FloatT det_inv(FloatT(1) / det);
+    res(0, 0) *= det_inv; res(1, 0) *= det_inv; res(2, 0) *= det_inv;
+    res(0, 1) = (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * det_inv;
+    res(1, 1) = (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * det_inv;
+    res(2, 1) = (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * det_inv;
+    res(0, 2) = (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * det_inv;
+    res(1, 2) = (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * det_inv;
+    res(2, 2) = (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * det_inv;
+    return res;
+  }
+};
+
+template <class FloatT>
+struct FixedMatrix_Square<FloatT, 4> {
+  typedef FixedMatrix<FloatT, 4, 4> mat_t;
+  /*
+   * 2 x 2 minors of the upper two rows (s) and the lower two rows (c),
+   * with which det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0.
+   */
+  struct minors_t {
+    FloatT s[6], c[6];
+    minors_t(const mat_t &m){
+      s[0] = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+      s[1] = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+      s[2] = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+      s[3] = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+      s[4] = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+      s[5] = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+      c[5] = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+      c[4] = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+      c[3] = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+      c[2] = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+      c[1] = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+      c[0] = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+    }
+    FloatT determinant() const {
+      return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] 
+          + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+    }
+  };
+  static FloatT determinant(const mat_t &m){
+    return minors_t(m).determinant();
+  }
+  static mat_t inverse(const mat_t &m){
+    minors_t mi(m);
+    const FloatT *s(mi.s), *c(mi.c);
+    FloatT det(mi.determinant());
+    assert(det != FloatT(0));
+    FloatT det_inv(FloatT(1) / det);
+    mat_t res;
+    res(0, 0) = ( m(1, 1) * c[5] - m(1, 2) * c[4] + m(1, 3) * c[3]) * det_inv;
+    res(0, 1) = (-m(0, 1) * c[5] + m(0, 2) * c[4] - m(0, 3) * c[3]) * det_inv;
+    res(0, 2) = ( m(3, 1) * s[5] - m(3, 2) * s[4] + m(3, 3) * s[3]) * det_inv;
+    res(0, 3) = (-m(2, 1) * s[5] + m(2, 2) * s[4] - m(2, 3) * s[3]) * det_inv;
+    res(1, 0) = (-m(1, 0) * c[5] + m(1, 2) * c[2] - m(1, 3) * c[1]) * det_inv;
+    res(1, 1) = ( m(0, 0) * c[5] - m(0, 2) * c[2] + m(0, 3) * c[1]) * det_inv;
+    res(1, 2) = (-m(3, 0) * s[5] + m(3, 2) * s[2] - m(3, 3) * s[1]) * det_inv;
+    res(1, 3) = ( m(2, 0) * s[5] - m(2, 2) * s[2] + m(2, 3) * s[1]) * det_inv;
+    res(2, 0) = ( m(1, 0) * c[4] - m(1, 1) * c[2] + m(1, 3) * c[0]) * det_inv;
+    res(2, 1) = (-m(0, 0) * c[4] + m(0, 1) * c[2] - m(0, 3) * c[0]) * det_inv;
+    res(2, 2) = ( m(3, 0) * s[4] - m(3, 1) * s[2] + m(3, 3) * s[0]) * det_inv;
+    res(2, 3) = (-m(2, 0) * s[4] + m(2, 1) * s[2] - m(2, 3) * s[0]) * det_inv;
+    res(3, 0) = (-m(1, 0) * c[3] + m(1, 1) * c[1] - m(1, 2) * c[0]) * det_inv;
+    res(3, 1) = ( m(0, 0) * c[3] - m(0, 1) * c[1] + m(0, 2) * c[0]) * det_inv;
+    res(3, 2) = (-m(3, 0) * s[3] + m(3, 1) * s[1] - m(3, 2) * s[0]) * det_inv;
+    res(3, 3) = ( m(2, 0) * s[3] - m(2, 1) * s[1] + m(2, 2) * s[0]) * det_inv;
+    return res;
+  }
+};
+
+/**
+ * Fixed-size matrix class, whose R x C elements are stored in row-major order
+ * inside the object. Unlike Matrix, copy is deep (value semantics).
+ * 
+ */
+template <class FloatT, unsigned int R, unsigned int C = R>
+class FixedMatrix {
+  public:
+    typedef FixedMatrix<FloatT, R, C> self_t;
+    typedef FloatT value_t;
+    static const unsigned int rows_fixed = R;
+    static const unsigned int columns_fixed = C;
+    
+  protected:
+    FloatT m_buffer[R * C];
+    
+  public:
+    /**
+     * Constructor of a zero matrix
+     * 
+     */
+    FixedMatrix(){
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R * C; i++){m_buffer[i] = FloatT(0);}
+    }
+    
+    /**
+     * Constructor with initial values
+     * 
+     * @param serialized R * C elements in row-major order
+     */
+    explicit FixedMatrix(const FloatT *serialized){
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R * C; i++){m_buffer[i] = serialized[i];}
     }
-     
+    
     /**
-     * UD
-     * (0, 0)(n-1,n-1):  U
-     * (0, n)(n-1,2n-1): D
+     * Conversion from a dynamic matrix, whose dimensions are checked at runtime.
      * 
-     * @return (self_t) UD
+     * @param matrix R x C matrix
      */
-    self_t decomposeUD(bool do_check = false) const{
-      assert((!do_check) || isSymmetric());
-      unsigned int size(rows());
-      self_t P(copy());
-      self_t UD(size, size * 2);
-#define U(i, j) UD(i, j)
-#define D(i, j) UD(i, j + size)
-      for(int i = size - 1; i >= 0; i--){
-        D(i, i) = P(i, i);
-        U(i, i) = FloatT(1);      
-        for(int j = 0; j < i; j++){
-          U(j, i) = P(j, i) / D(i, i);
-          for(int k = 0; k <= j; k++){
-            P(k, j) -= U(k, i) * D(i, i) * U(j, i);
-          }
+    explicit FixedMatrix(const Matrix<FloatT> &matrix){
+      assert((matrix.rows() == R) && (matrix.columns() == C));
+      typename Matrix<FloatT>::dense_view_t v(matrix);
+      for(unsigned int i(0); i < R; i++){
+        for(unsigned int j(0); j < C; j++){
+          m_buffer[i * C + j] = v.buffer[(int)i * v.row_stride + (int)j * v.column_stride];
         }
       }
-#undef U
-#undef D
-      return UD;
     }
     
     /**
-     * ?
+     * Conversion to a dynamic matrix, which allocates new storage.
      * 
-     * @return (self_t) 
+     * @return (Matrix<FloatT>) R x C matrix
      */
-    self_t inverse(bool do_check = false) const{
-      assert((!do_check) || isSquare());
-      
-      unsigned int size(rows());
-      
-      //?
-      self_t left(copy());
-      self_t right(self_t::getI(size));
-      for(unsigned int i = 0; i < size; i++){
-        if(left(i, i) == FloatT(0)){ //(i, i)
-          for(unsigned int j = i+1; j <= size; j++){
-            assert(j != size);
-            if(left(j, i) != FloatT(0)){
-              left.exchangeRows(j, i);
-              right.exchangeRows(j, i);
-              break;
-            }
-          }
-        }
-        if(left(i, i) != FloatT(1)){
-          for(unsigned int j = 0; j < size; j++){right(i, j) /= left(i, i);}
-          for(unsigned int j = i+1; j < size; j++){left(i, j) /= left(i, i);}
-          left(i, i) = FloatT(1);
-        }
-        for(unsigned int k = 0; k < size; k++){
-          if(k == i){continue;}
-          if(left(k, i) != FloatT(0)){
-            for(unsigned int j = 0; j < size; j++){right(k, j) -= right(i, j) * left(k, i);}
-            for(unsigned int j = i+1; j < size; j++){left(k, j) -= left(i, j) * left(k, i);}
-            left(k, i) = FloatT(0);
-          }
-        }
-      }
-      //cout << "L:" << left << endl;
-      //cout << "R:" << right << endl;
-      
-      return right;
-      
-      //LU
-      /*
-      */
+    Matrix<FloatT> dynamic() const {return Matrix<FloatT>(R, C, m_buffer);}
+    
+    unsigned int rows() const {return R;}
+    unsigned int columns() const {return C;}
+    bool isSquare() const {return R == C;}
+    
+    FloatT *buffer() {return m_buffer;}
+    const FloatT *buffer() const {return m_buffer;}
+    
+    FloatT &operator()(const unsigned int &row, const unsigned int &column){
+      assert((row < R) && (column < C));
+      return m_buffer[row * C + column];
     }
+    const FloatT &operator()(const unsigned int &row, const unsigned int &column) const {
+      assert((row < R) && (column < C));
+      return m_buffer[row * C + column];
+    }
+    
     /**
-     * ?
+     * Copy, which is provided for compatibility with Matrix.
      * 
-     * @param matrix 
-     * @return (self_t) 
+     * @return (self_t) copy
      */
-    self_t &operator/=(const self_t &matrix){return (*this) *= matrix.inverse();}
+    self_t copy() const {return *this;}
+    
     /**
-     * 
+     * Scalar matrix
      * 
-     * @param matrix 
-     * @return (self_t) ?
+     * @param scalar diagonal element
+     * @return (self_t) scalar matrix
      */
-    self_t operator/(const self_t &matrix) const{return (copy() /= matrix);}
+    static self_t getScalar(const FloatT &scalar){
+      (void)sizeof(FixedMatrix_StaticAssert<R == C>);
+      self_t res;
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R; i++){res.m_buffer[i * C + i] = scalar;}
+      return res;
+    }
     
     /**
-     * 
-     * 
+     * Identity matrix
      * 
-     * @param row ?
-     * @param column ?
-     * @param matrix 
+     * @return (self_t) identity matrix
      */
-    self_t pivotMerge(const int &row, const int &column, const self_t &matrix){
-      for(int i = 0; i < matrix.rows(); i++){
-        if(row + i < 0){continue;}
-        else if(row + i >= rows()){break;}
-        for(int j = 0; j < matrix.columns(); j++){
-          if(column + j < 0){continue;}
-          else if(column + j >= columns()){break;}
-          (*this)(row + i, column + j) += (*const_cast<self_t *>(&matrix))(i, j);
-        }
+    static self_t getI(){return getScalar(FloatT(1));}
+    
+    /**
+     * Transposed matrix (copy)
+     * 
+     * @return (FixedMatrix<FloatT, C, R>) transposed matrix
+     */
+    FixedMatrix<FloatT, C, R> transpose() const {
+      FixedMatrix<FloatT, C, R> res;
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R; i++){
+        MATRIX_FIXED_UNROLL
+        for(unsigned int j(0); j < C; j++){res(j, i) = m_buffer[i * C + j];}
       }
+      return res;
+    }
+    
+    FloatT trace() const {
+      (void)sizeof(FixedMatrix_StaticAssert<R == C>);
+      FloatT tr(0);
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R; i++){tr += m_buffer[i * C + i];}
+      return tr;
+    }
+    
+    self_t &operator*=(const FloatT &scalar){
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R * C; i++){m_buffer[i] *= scalar;}
+      return *this;
+    }
+    self_t operator*(const FloatT &scalar) const {return self_t(*this) *= scalar;}
+    friend self_t operator*(const FloatT &scalar, const self_t &matrix){return matrix * scalar;}
+    self_t &operator/=(const FloatT &scalar){return (*this) *= (FloatT(1) / scalar);}
+    self_t operator/(const FloatT &scalar) const {return self_t(*this) /= scalar;}
+    self_t operator-() const {return (*this) * FloatT(-1);}
+    
+    self_t &operator+=(const self_t &matrix){
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R * C; i++){m_buffer[i] += matrix.m_buffer[i];}
+      return *this;
+    }
+    self_t operator+(const self_t &matrix) const {return self_t(*this) += matrix;}
+    self_t &operator-=(const self_t &matrix){
+      MATRIX_FIXED_UNROLL
+      for(unsigned int i(0); i < R * C; i++){m_buffer[i] -= matrix.m_buffer[i];}
       return *this;
     }
+    self_t operator-(const self_t &matrix) const {return self_t(*this) -= matrix;}
     
     /**
-     * 
+     * Multiplication, whose dimensions are checked at compile time.
      * 
-     * @param row ?
-     * @param column ?
-     * @param matrix 
+     * @param matrix C x C2 matrix
+     * @return (FixedMatrix<FloatT, R, C2>) product
      */
-    self_t pivotAdd(const int &row, const int &column, const self_t &matrix) const{
-      return copy().pivotMerge(row, column, matrix);
+    template <unsigned int C2>
+    FixedMatrix<FloatT, R, C2> operator*(const FixedMatrix<FloatT, C, C2> &matrix) const {
+      FixedMatrix<FloatT, R, C2> res;
+      FloatT *r(res.buffer());
+      const FloatT *y(matrix.buffer());
+      if(R * C * C2 <= 256){ // completely unrolled
+        MATRIX_FIXED_UNROLL
+        for(unsigned int i(0); i < R; i++){
+          MATRIX_FIXED_UNROLL
+          for(unsigned int k(0); k < C; k++){
+            const FloatT a_ik(m_buffer[i * C + k]);
+            MATRIX_FIXED_UNROLL
+            for(unsigned int j(0); j < C2; j++){r[i * C2 + j] += a_ik * y[k * C2 + j];}
+          }
+        }
+      }else{ // only the innermost loop is unrolled to avoid code bloat
+        for(unsigned int i(0); i < R; i++){
+          for(unsigned int k(0); k < C; k++){
+            const FloatT a_ik(m_buffer[i * C + k]);
+            MATRIX_FIXED_UNROLL
+            for(unsigned int j(0); j < C2; j++){r[i * C2 + j] += a_ik * y[k * C2 + j];}
+          }
+        }
+      }
+      return res;
     }
     
     /**
-     * 以易於閱讀的格式輸出矩陣。
+     * Multiplication with a dynamic matrix
      * 
+     * @param matrix C x n matrix
+     * @return (Matrix<FloatT>) product
      */
-    void inspect(char *buffer, int buffer_size) const{
-      using std::snprintf;
-      if(m_Storage){
-        int printed;
-        printed = snprintf(buffer, buffer_size, "{");
-        printf("%s",buffer);
-        buffer += printed;
-        buffer_size -= printed;
-        for(unsigned int i = 0; i < rows(); i++){
-          printed = snprintf(buffer, buffer_size, (i == 0 ? "\n{" : ",\n{"));
-          printf("%s",buffer);
-          buffer += printed;
-          buffer_size -= printed;
-          for(unsigned int j = 0; j < columns(); j++){
-            /*printed = printf((j == 0 ? "%f" : ",%f"), 
-                               const_cast<self_t *>(this)->operator()(i, j));*/
-            printed = snprintf(buffer, buffer_size, (j == 0 ? "%f" : ",%f"), 
-                               const_cast<self_t *>(this)->operator()(i, j));
-            printf("%s",buffer);
-            buffer += printed;
-            buffer_size -= printed;
-          }
-          printed = snprintf(buffer, buffer_size, "}");
-          printf("%s",buffer);
-          buffer += printed;
-          buffer_size -= printed;
-        }
-        snprintf(buffer, buffer_size, "\n}");
-        printf("%s",buffer);
+    Matrix<FloatT> operator*(const Matrix<FloatT> &matrix) const {
+      return dynamic() * matrix;
+    }
+    
+    self_t &operator*=(const FixedMatrix<FloatT, C, C> &matrix){
+      return (*this) = (*this) * matrix;
+    }
+    
+    bool operator==(const self_t &matrix) const {
+      for(unsigned int i(0); i < R * C; i++){
+        if(m_buffer[i] != matrix.m_buffer[i]){return false;}
       }
+      return true;
+    }
+    bool operator!=(const self_t &matrix) const {return !((*this) == matrix);}
+    
+    /**
+     * Determinant, calculated with a closed form for R = C <= 4.
+     * 
+     * @return (FloatT) determinant
+     */
+    FloatT determinant() const {
+      (void)sizeof(FixedMatrix_StaticAssert<R == C>);
+      return FixedMatrix_Square<FloatT, R>::determinant(*this);
+    }
+    
+    /**
+     * Inverse matrix, calculated with a closed form for R = C <= 4.
+     * 
+     * @return (self_t) inverse
+     */
+    self_t inverse() const {
+      (void)sizeof(FixedMatrix_StaticAssert<R == C>);
+      return FixedMatrix_Square<FloatT, R>::inverse(*this);
     }
 };
 
+template <class FloatT, unsigned int R, unsigned int C>
+const unsigned int FixedMatrix<FloatT, R, C>::rows_fixed;
+template <class FloatT, unsigned int R, unsigned int C>
+const unsigned int FixedMatrix<FloatT, R, C>::columns_fixed;
+
+#undef MATRIX_FIXED_UNROLL
+
 #if defined(DSPF_DP_MAT_MUL_H_) || defined(DSPF_SP_MAT_MUL_ASM_H_)
 /**
  * ???2???
@@ -1575,6 +8534,28 @@ class Array2D_DenseAligned
       return m_buffer_columns;
     }
     
+    /**
+     * Row stride of the buffer in elements
+     * 
+     * @return (unsigned int) leading dimension
+     */
+    unsigned int ld() const {return m_buffer_columns;}
+    
+  protected:
+    /**
+     * Fill the padding with zero, which the kernels applied to the whole 
+     * padded buffer, such as DSPF_*_mat_mul, require.
+     */
+    void clear_padding(){
+      for(unsigned int i(0); i < m_buffer_rows; i++){
+        for(unsigned int j((i < rows()) ? columns() : 0); j < m_buffer_columns; j++){
+          m_buffer[i * m_buffer_columns + j] = FloatT(0);
+        }
+      }
+    }
+    
+  public:
+    
     static unsigned int aligned_rows(
         const unsigned int &_rows,
         const unsigned int &_columns){
@@ -1603,10 +8584,10 @@ class Array2D_DenseAligned
         const unsigned int &_columns)
         : super_t(_rows, _columns),
         buffer_manager_t(
-            new FloatT[aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)]),
+            aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)),
         m_buffer_rows(aligned_rows(_rows, _columns)),
         m_buffer_columns(aligned_columns(_rows, _columns)){
-          
+      clear_padding();
     }
     
     /**
@@ -1623,7 +8604,7 @@ class Array2D_DenseAligned
         const FloatT *serialized)
         : super_t(_rows, _columns),
         buffer_manager_t(
-            new FloatT[aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)]),
+            aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)),
         m_buffer_rows(aligned_rows(_rows, _columns)),
         m_buffer_columns(aligned_columns(_rows, _columns)){
       
@@ -1634,6 +8615,7 @@ class Array2D_DenseAligned
         src += _columns;
         dist += m_buffer_columns;
       }
+      clear_padding();
     }
   
   public:
@@ -1680,14 +8662,53 @@ class Array2D_DenseAligned
         const unsigned int &row, 
         const unsigned int &column){
       assert((row < rows()) && (column < columns()));
+      if(buffer_manager_t::shared()){buffer_manager_t::unshare();}
+      return *(m_buffer + (row * m_buffer_columns) + column);
+    }
+    
+    /**
+     * Read-only element accessor
+     * 
+     * @param row row index (starting from 0)
+     * @param column column index (starting from 0)
+     * @return (const FloatT &) element
+     */
+    inline const FloatT &operator()(
+        const unsigned int &row, 
+        const unsigned int &column) const {
+      assert((row < rows()) && (column < columns()));
       return *(m_buffer + (row * m_buffer_columns) + column);
     }
     
+    /**
+     * Detach the buffer if it is shared by copy-on-write.
+     * 
+     * @param for_view mark the buffer as aliased by views
+     */
+    void detach(const bool &for_view = false){
+      buffer_manager_t::unshare(for_view);
+    }
+    
+    /**
+     * Memory layout descriptor of the padded row-major buffer.
+     * 
+     * @return (bool) always true
+     */
+    bool view(typename super_t::view_t &v) const {
+      v.buffer = m_buffer;
+      v.row_stride = (int)m_buffer_columns;
+      v.column_stride = 1;
+      v.rows = rows();
+      v.columns = columns();
+      return true;
+    }
+    
     /**
      * ??
      * 
      */
     void clear(){
+      buffer_manager_t::unshare();
       for(unsigned int i(0); 
           i < m_buffer_rows * m_buffer_columns; 
           i++){*(m_buffer + i) = FloatT(0);}
@@ -1713,12 +8734,12 @@ class Array2D_DenseAligned
  */
 #define MAKE_SPECIALIZED(type, prefix) \
 template<> \
-Array2D_DenseAligned<type >::Array2D_DenseAligned( \
+inline Array2D_DenseAligned<type >::Array2D_DenseAligned( \
     const unsigned int &_rows, const unsigned int &_columns, \
     const type *serialized) \
     : super_t(_rows, _columns), \
     buffer_manager_t( \
-        new type[aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)]), \
+        aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)), \
     m_buffer_rows(aligned_rows(_rows, _columns)), \
     m_buffer_columns(aligned_columns(_rows, _columns)){ \
   \
@@ -1742,9 +8763,10 @@ Array2D_DenseAligned<type >::Array2D_DenseAligned( \
       dist += m_buffer_columns; \
     } \
   } \
+  clear_padding(); \
 } \
 template <> \
-Array2D<type > *Array2D_DenseAligned<type >::copy_helper( \
+inline Array2D<type > *Array2D_DenseAligned<type >::copy_helper( \
     Array2D_DenseAligned<type > *dist) const { \
   unsigned int move_size(m_buffer_rows * m_buffer_columns); \
   if(move_size % 2 == 1){ \
@@ -1755,51 +8777,8 @@ Array2D<type > *Array2D_DenseAligned<type >::copy_helper( \
   return dist; \
 }
 
-template<>
-Array2D_DenseAligned<double>::Array2D_DenseAligned(
-    const unsigned int &_rows, const unsigned int &_columns,
-    const double *serialized)
-    : super_t(_rows, _columns),
-    buffer_manager_t(
-        new double[aligned_rows(_rows, _columns) * aligned_columns(_rows, _columns)]),
-    m_buffer_rows(aligned_rows(_rows, _columns)),
-    m_buffer_columns(aligned_columns(_rows, _columns)){
-  
-  double *src(const_cast<double *>(serialized));
-  double *dist(m_buffer);
-  if((_rows == 1) || (_columns == 1)){
-    unsigned int move_size(_rows * _columns);
-    if(move_size % 2 == 1){
-      move_size--;
-      dist[move_size] = src[move_size];
-    }
-    DSPF_dp_blk_move(src, dist, move_size);
-  }else if(_columns % 2 == 0){
-    DSPF_dp_blk_move(src, dist, _rows * _columns);
-  }else{
-    unsigned int column_step(_columns - 1);
-    for(unsigned int i = 0; i < _rows; i++){
-      DSPF_dp_blk_move(src, dist, column_step);
-      src += column_step;
-      dist[column_step] = *(src++);
-      dist += m_buffer_columns;
-    }
-  }
-}
-template <>
-Array2D<double> *Array2D_DenseAligned<double>::copy_helper(
-    Array2D_DenseAligned<double> *dist) const {
-  unsigned int move_size(m_buffer_rows * m_buffer_columns);
-  if(move_size % 2 == 1){
-    move_size--;
-    (dist->m_buffer)[move_size] = m_buffer[move_size];
-  }
-  DSPF_dp_blk_move(m_buffer, dist->m_buffer, move_size);
-  return dist;
-}
-    
 #if defined(DSPF_DP_BLK_MOVE_H_)
-//MAKE_SPECIALIZED(double, dp)
+MAKE_SPECIALIZED(double, dp)
 #endif
 #if defined(DSPF_SP_BLK_MOVE_ASM_H_)
 MAKE_SPECIALIZED(float, sp)
@@ -1853,7 +8832,13 @@ class Array2D_Dense<type > \
      *
      * @return (Array2D_Dense<FloatT>)
      */ \
-    self_t dense() const {return self_t(*this);} \
+    self_t dense() const { \
+      if(super_t::shareable()){return self_t(*this);} \
+      root_t *array(copy()); \
+      self_t res(*static_cast<self_t *>(array)); \
+      delete array; \
+      return res; \
+    } \
     \
     /**
      * ??
@@ -1862,6 +8847,10 @@ class Array2D_Dense<type > \
      */ \
     root_t *shallow_copy() const{return new self_t(*this);} \
     \
+    root_t *share() const{ \
+      return super_t::shareable() ? shallow_copy() : copy(); \
+    } \
+    \
     /**
      * ?
      * 
@@ -1906,89 +8895,6 @@ MAKE_SPECIALIZED(float)
 #undef MAKE_SPECIALIZED
 #endif
 
-/*
- * ?(unrolled version)
- */
-#define MAKE_SPECIALIZED(type) \
-template <> \
-Matrix<type > Matrix<type >::operator*(const type &scalar) const{ \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  type *x_buf(x.buffer()); \
-  type *r_buf(r->buffer()); \
-  unsigned int elements(x.buffer_rows() * x.buffer_columns()); \
-  for(unsigned int i(elements / 2); i > 0; i--){ \
-    *(r_buf++) = *(x_buf++) * scalar; \
-    *(r_buf++) = *(x_buf++) * scalar; \
-  } \
-  if(elements % 2 != 0){*r_buf = *x_buf * scalar;} \
-  return Matrix<type >(r); \
-} \
-template<> \
-Matrix<type > Matrix<type >::operator/(const type &scalar) const{ \
-  return (*this) * (1. / scalar); \
-}
-
-#if defined(DSPF_DP_MAT_MUL_H_)
-MAKE_SPECIALIZED(double)
-#endif
-#if defined(DSPF_SP_MAT_MUL_ASM_H_)
-MAKE_SPECIALIZED(float)
-#endif
-
-#undef MAKE_SPECIALIZED
-
-/*
- * (unrolled version)
- */
-#define MAKE_SPECIALIZED(type) \
-template <> \
-Matrix<type > Matrix<type >::operator+(const Matrix<type > &matrix) const{ \
-  assert((rows() == matrix.rows()) && (columns() == matrix.columns())); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  Array2D_Dense<type > y(matrix.storage()->dense()); \
-  type *x_buf(x.buffer()); \
-  type *y_buf(y.buffer()); \
-  type *r_buf(r->buffer()); \
-  unsigned int elements(x.buffer_rows() * x.buffer_columns()); \
-  for(unsigned int i(elements / 2); i > 0; i--){ \
-    *(r_buf++) = *(x_buf++) + *(y_buf++); \
-    *(r_buf++) = *(x_buf++) + *(y_buf++); \
-  } \
-  if(elements % 2 != 0){*r_buf = (*x_buf) + (*y_buf);} \
-  return Matrix<type >(r); \
-} \
-template<> \
-Matrix<type > Matrix<type >::operator-(const Matrix<type > &matrix) const{ \
-  assert((rows() == matrix.rows()) && (columns() == matrix.columns())); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  Array2D_Dense<type > y(matrix.storage()->dense()); \
-  type *x_buf(x.buffer()); \
-  type *y_buf(y.buffer()); \
-  type *r_buf(r->buffer()); \
-  unsigned int elements(x.buffer_rows() * x.buffer_columns()); \
-  for(unsigned int i(elements / 2); i > 0; i--){ \
-    *(r_buf++) = *(x_buf++) - *(y_buf++); \
-    *(r_buf++) = *(x_buf++) - *(y_buf++); \
-  } \
-  if(elements % 2 != 0){*r_buf = (*x_buf) - (*y_buf);} \
-  return Matrix<type >(r); \
-}
-
-#if defined(DSPF_DP_MAT_MUL_H_)
-MAKE_SPECIALIZED(double)
-#endif
-#if defined(DSPF_SP_MAT_MUL_ASM_H_)
-MAKE_SPECIALIZED(float)
-#endif
-
-#undef MAKE_SPECIALIZED
-
 template <class FloatT>
 void mat_mul(FloatT *x, const int r1, const int c1, 
     FloatT *y, const int c2, 
@@ -2080,124 +8986,85 @@ void mat_mul_unrolled(FloatT *x, const int r1, const int c1,
 }
 
 /*
- * ( * )
- * 
+ * Multiplication with DSPF_*_mat_mul.
+ * The operands are converted to the aligned dense storage, where a transposed one
+ * is transposed with DSPF_*_mat_trans (see Array2D_Transpose::dense()).
+ * The kernel is applied to the padded buffers, whose padding is zero,
+ * when their padded dimensions agree; otherwise, e.g., in the case of 
+ * odd inner dimension, the generic multiplication is used.
+ * A product with a row or column vector result is always passed to 
+ * the generic one, i.e., mat_gemv(), without converting the operands,
+ * as well as a product with a symmetric packed, sparse, or banded operand,
+ * whose own kernels touch fewer elements.
  */
-#define MAKE_SPECIALIZED1(type, prefix) \
-template<> \
-Matrix<type > Matrix<type >::operator*(const Matrix<type > &matrix) const{ \
-  assert(columns() == matrix.rows()); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), matrix.columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  Array2D_Dense<type > y(matrix.storage()->dense()); \
-  \
-  if((rows() == 1) || (columns() == 1) || (matrix.columns() == 1)){ \
-    mat_mul(x.buffer(), x.buffer_rows(), x.buffer_columns(), \
-        y.buffer(), y.buffer_columns(), \
-        r->buffer()); \
-  }else{ \
-    /*LOG_printf(&trace, "%d, parent: %d", rows(), x.rows());
-    LOG_printf(&trace, "%d, parent: %d", columns(), x.columns());
-    LOG_printf(&trace, "%d, parent: %d", matrix.columns(), y.columns());
-    if((rows() > x.rows()) || (columns() > x.columns()) || (matrix.columns() > y.columns())){
-      LOG_printf(&trace, "error!!");
-    }*/ \
-    \
-    DSPF_ ## prefix ## _mat_mul(x.buffer(), x.buffer_rows(), x.buffer_columns(), \
-        y.buffer(), y.buffer_columns(), \
-        r->buffer()); \
+#define MAKE_SPECIALIZED(type, prefix) \
+inline bool mat_mul_dspf_applicable( \
+    const Array2D<type > &x, const Array2D<type > &y){ \
+  Array2D<type >::symmetric_view_t sv; \
+  Array2D<type >::sparse_view_t sp; \
+  Array2D<type >::band_view_t bv; \
+  return (x.rows() > 1) && (y.columns() > 1) \
+      && (!x.symmetric_view(sv)) && (!y.symmetric_view(sv)) \
+      && (!x.sparse_view(sp)) && (!y.sparse_view(sp)) \
+      && (!x.band_view(bv)) && (!y.band_view(bv)); \
+} \
+inline Array2D_Dense<type > *mat_mul_dspf( \
+    const Array2D_Dense<type > &x, const Array2D_Dense<type > &y){ \
+  typedef Array2D_DenseAligned<type > aligned_t; \
+  unsigned int r1(x.rows()), c1(x.columns()), c2(y.columns()); \
+  if((aligned_t::aligned_columns(r1, c1) != aligned_t::aligned_rows(c1, c2)) \
+      || (aligned_t::aligned_rows(r1, c2) != aligned_t::aligned_rows(r1, c1)) \
+      || (aligned_t::aligned_columns(r1, c2) != aligned_t::aligned_columns(c1, c2))){ \
+    return NULL; \
   } \
-  return Matrix<type >(r); \
-}
-#define MAKE_SPECIALIZED2(type) \
+  Array2D_Dense<type > *r(new Array2D_Dense<type >(r1, c2)); \
+  DSPF_ ## prefix ## _mat_mul( \
+      const_cast<type *>(x.buffer()), x.buffer_rows(), x.buffer_columns(), \
+      const_cast<type *>(y.buffer()), y.buffer_columns(), \
+      r->buffer()); \
+  return r; \
+} \
 template<> \
-Matrix<type > Matrix<type >::operator*( \
-    const Matrix<type > &matrix) const { \
-  assert(this->columns() == matrix.rows()); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), matrix.columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  Array2D_Dense<type > y(matrix.storage()->dense()); \
-  \
-  mat_mul_unrolled(x.buffer(), x.buffer_rows(), x.buffer_columns(), \
-      y.buffer(), y.buffer_columns(), \
-      r->buffer(), \
-      false, false); \
-  \
-  return Matrix<type >(r); \
-}
-
-#if defined(DSPF_DP_MAT_MUL_H_)
-MAKE_SPECIALIZED1(double, dp)
-//MAKE_SPECIALIZED2(double)
-#endif
-#if defined(DSPF_SP_MAT_MUL_ASM_H_)
-MAKE_SPECIALIZED1(float, sp)
-//MAKE_SPECIALIZED2(float)
-#endif
-
-#undef MAKE_SPECIALIZED1
-#undef MAKE_SPECIALIZED2
-
-/*
- * ( * ,  * ,  * )
- */
-#define MAKE_SPECIALIZED(type) \
+inline Matrix<type > Matrix<type >::operator*(const Matrix<type > &matrix) const { \
+  assert(columns() == matrix.rows()); \
+  Array2D_Dense<type > *r(!mat_mul_dspf_applicable(*storage(), *matrix.storage()) \
+      ? NULL : mat_mul_dspf(storage()->dense(), matrix.storage()->dense())); \
+  return r ? Matrix<type >(r) : mul(*this, false, matrix, false); \
+} \
 template<> \
-Matrix<type > Matrix<type >::operator*( \
+inline Matrix<type > Matrix<type >::operator*( \
     const TransposedMatrix<type > &matrix) const { \
-  assert(this->columns() == matrix.rows()); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), matrix.columns())); \
-  Array2D_Dense<type > x(storage()->dense()); \
-  Array2D_Dense<type > y(matrix.untranspose().storage()->dense()); \
-  \
-  mat_mul_unrolled(x.buffer(), x.buffer_rows(), x.buffer_columns(), \
-      y.buffer(), y.buffer_rows(), \
-      r->buffer(), \
-      false, true); \
-  \
-  return Matrix<type >(r); \
+  assert(columns() == matrix.rows()); \
+  Array2D_Dense<type > *r(!mat_mul_dspf_applicable(*storage(), *matrix.storage()) \
+      ? NULL : mat_mul_dspf(storage()->dense(), matrix.storage()->dense())); \
+  return r ? Matrix<type >(r) : mul(*this, false, matrix.untranspose(), true); \
 } \
 template<> \
-Matrix<type > TransposedMatrix<type >::operator*( \
+inline Matrix<type > TransposedMatrix<type >::operator*( \
     const Matrix<type > &matrix) const { \
   assert(columns() == matrix.rows()); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), matrix.columns())); \
-  Array2D_Dense<type > x(untranspose().storage()->dense()); \
-  Array2D_Dense<type > y(matrix.storage()->dense()); \
-  \
-  mat_mul_unrolled(x.buffer(), x.buffer_columns(), x.buffer_rows(), \
-      y.buffer(), y.buffer_columns(), \
-      r->buffer(), \
-      true, false); \
-  \
-  return Matrix<type >::make_instance(r); \
+  Array2D_Dense<type > *r(!mat_mul_dspf_applicable(*root_t::storage(), *matrix.storage()) \
+      ? NULL : mat_mul_dspf(root_t::storage()->dense(), matrix.storage()->dense())); \
+  return r \
+      ? Matrix<type >::make_instance(r) \
+      : root_t::mul(untranspose(), true, matrix, false); \
 } \
 template<> \
-Matrix<type > TransposedMatrix<type >::operator*( \
+inline Matrix<type > TransposedMatrix<type >::operator*( \
     const TransposedMatrix<type > &matrix) const { \
   assert(columns() == matrix.rows()); \
-  Array2D_Dense<type > *r( \
-      new Array2D_Dense<type >(rows(), matrix.columns())); \
-  Array2D_Dense<type > x(untranspose().storage()->dense()); \
-  Array2D_Dense<type > y(matrix.untranspose().storage()->dense()); \
-  \
-  mat_mul_unrolled(x.buffer(), x.buffer_columns(), x.buffer_rows(), \
-      y.buffer(), y.buffer_rows(), \
-      r->buffer(), \
-      true, true); \
-  \
-  return Matrix<type >::make_instance(r); \
+  Array2D_Dense<type > *r(!mat_mul_dspf_applicable(*root_t::storage(), *matrix.storage()) \
+      ? NULL : mat_mul_dspf(root_t::storage()->dense(), matrix.storage()->dense())); \
+  return r \
+      ? Matrix<type >::make_instance(r) \
+      : root_t::mul(untranspose(), true, matrix.untranspose(), true); \
 }
 
 #if defined(DSPF_DP_MAT_MUL_H_)
-MAKE_SPECIALIZED(double)
+MAKE_SPECIALIZED(double, dp)
 #endif
 #if defined(DSPF_SP_MAT_MUL_ASM_H_)
-MAKE_SPECIALIZED(float)
+MAKE_SPECIALIZED(float, sp)
 #endif
 
 #undef MAKE_SPECIALIZED
@@ -2205,14 +9072,14 @@ MAKE_SPECIALIZED(float)
 #endif
 
 
-#if defined(DSPF_DP_MAT_TRANS_H_) || defined(DSPF_SP_MAT_MUL_ASM_H_)
+#if defined(DSPF_DP_MAT_TRANS_H_) || defined(DSPF_SP_MAT_TRANS_ASM_H_)
 
 /*
  * 
  */
 #define MAKE_SPECIALIZED(type, prefix) \
 template<> \
-Array2D_Dense<type > Array2D_Transpose<type >::dense() const { \
+inline Array2D_Dense<type > Array2D_Transpose<type >::dense() const { \
   Array2D_Dense<type > before_transposed( \
       Array2D_Delegate<type >::getTarget().dense()); \
   Array2D_Dense<type > transposed( \
@@ -2224,10 +9091,10 @@ Array2D_Dense<type > Array2D_Transpose<type >::dense() const { \
   return transposed; \
 }
 
-#if defined(DSPF_DP_MAT_TRANS_H_)
+#if defined(DSPF_DP_MAT_TRANS_H_) && defined(DSPF_DP_MAT_MUL_H_)
 MAKE_SPECIALIZED(double, dp)
 #endif
-#if defined(DSPF_SP_MAT_TRANS_ASM_H_)
+#if defined(DSPF_SP_MAT_TRANS_ASM_H_) && defined(DSPF_SP_MAT_MUL_ASM_H_)
 MAKE_SPECIALIZED(float, sp)
 #endif
 
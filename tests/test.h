@@ -0,0 +1,67 @@
+/**
+ * @file Minimal harness shared by the tests of matrix.h
+ * 
+ * Each test program includes this header once, 
+ * reports failures by CHECK(), and returns test_result() from main().
+ */
+#ifndef __MATRIX_TEST_H__
+#define __MATRIX_TEST_H__
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include "matrix.h"
+
+void canary_bird(){}
+
+static int test_failures(0);
+
+#define CHECK(expr) do{ \
+  if(!(expr)){ \
+    std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+    ++test_failures; \
+  } \
+}while(0)
+
+/**
+ * Maximum absolute difference of two matrices of the same size.
+ * 
+ */
+template <class T>
+static double max_diff(const Matrix<T> &a, const Matrix<T> &b){
+  double res(0);
+  for(unsigned int i(0); i < a.rows(); i++){
+    for(unsigned int j(0); j < a.columns(); j++){
+      double d(std::fabs((double)a(i, j) - (double)b(i, j)));
+      if(d > res){res = d;}
+    }
+  }
+  return res;
+}
+
+/**
+ * Matrix whose elements are uniform random numbers in [-1, 1].
+ * 
+ */
+template <class T>
+static Matrix<T> random_matrix(const unsigned int &rows, const unsigned int &columns){
+  Matrix<T> res(rows, columns);
+  for(unsigned int i(0); i < rows; i++){
+    for(unsigned int j(0); j < columns; j++){
+      res(i, j) = T(std::rand()) / RAND_MAX * 2 - 1;
+    }
+  }
+  return res;
+}
+
+static int test_result(const char *name){
+  if(test_failures == 0){
+    std::printf("%s: OK\n", name);
+    return 0;
+  }
+  std::printf("%s: %d failure(s)\n", name, test_failures);
+  return 1;
+}
+
+#endif /* __MATRIX_TEST_H__ */
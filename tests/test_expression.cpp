@@ -0,0 +1,90 @@
+/*
+ * Expression templates of the element-wise arithmetic,
+ * and the Matrix members called on an expression.
+ */
+#include "test.h"
+
+typedef Matrix<double> mat_t;
+
+static void test_evaluation(){
+  mat_t a(random_matrix<double>(5, 6)), b(random_matrix<double>(5, 6)), c(random_matrix<double>(5, 6));
+  mat_t r(5, 6);
+  for(unsigned int i(0); i < 5; i++){
+    for(unsigned int j(0); j < 6; j++){r(i, j) = a(i, j) + b(i, j) * 2 - c(i, j);}
+  }
+  const double tol(1E-15);
+
+  CHECK(max_diff<double>(a + b * 2.0 - c, r) < tol);
+  mat_t y;
+  y = a + 2.0 * b - c;
+  CHECK(max_diff(y, r) < tol);
+  CHECK(max_diff<double>(-(c - a - b * 2.0), r) < tol);
+  CHECK(max_diff<double>((a * 2.0 + b * 4.0 - c * 2.0) / 2.0, r) < tol);
+
+  { // assignment does not modify the shared buffer, and the destination can be an operand
+    mat_t s(a), keep(a.copy());
+    s = b + c;
+    CHECK(max_diff(a, keep) == 0);
+    mat_t cc(c.copy());
+    cc = a + b * 2.0 - cc;
+    CHECK(max_diff(cc, r) < tol);
+    cc = c.copy();
+    cc += a + b;
+    cc -= b * -1.0;
+    CHECK(max_diff<double>(cc, (a + b * 2.0 + c).copy()) < tol);
+  }
+  { // views as operands and destinations
+    mat_t big(random_matrix<double>(8, 8)), expected(big.copy());
+    big.partial(5, 6, 1, 2) = a + b * 2.0 - c;
+    for(unsigned int i(0); i < 5; i++){
+      for(unsigned int j(0); j < 6; j++){expected(i + 1, j + 2) = r(i, j);}
+    }
+    CHECK(max_diff(big, expected) < tol);
+    big.transpose().partial(6, 5, 0, 0) = a.transpose() - b.transpose();
+    for(unsigned int i(0); i < 5; i++){
+      for(unsigned int j(0); j < 6; j++){expected(i, j) = a(i, j) - b(i, j);}
+    }
+    CHECK(max_diff(big, expected) < tol);
+  }
+  { // products
+    mat_t m(random_matrix<double>(6, 4));
+    CHECK(max_diff<double>((a + b) * m, (a + b).copy() * m) == 0);
+    CHECK(max_diff<double>((a + b) * (m + m), (a + b).copy() * (m * 2.0).copy()) == 0);
+    CHECK(max_diff<double>(a.transpose() * (b - c), a.transpose() * (b - c).copy()) == 0);
+  }
+  Matrix<float> fa(random_matrix<float>(3, 3));
+  CHECK(max_diff<float>(fa * 2.f + fa, fa * 3.f) < 1E-6);
+}
+
+static void test_members(){
+  mat_t a(random_matrix<double>(4, 4)), b(random_matrix<double>(4, 4)), m(random_matrix<double>(4, 2));
+  for(unsigned int i(0); i < 4; i++){a(i, i) += 5;}
+  const mat_t sum((a + b).copy()), diff((a - b).copy());
+
+  bool same(true);
+  for(unsigned int i(0); i < 4; i++){
+    for(unsigned int j(0); j < 4; j++){same &= ((a + b)(i, j) == sum(i, j));}
+  }
+  CHECK(same);
+  CHECK(max_diff<double>((a + b).transpose(), sum.transpose()) == 0);
+  CHECK(max_diff<double>((a + b).partial(2, 3, 1, 1), sum.partial(2, 3, 1, 1)) == 0);
+  CHECK(max_diff<double>((a + b).rowVector(2), sum.rowVector(2)) == 0);
+  CHECK(max_diff<double>((a * 2.0).columnVector(3), (a * 2.0).copy().columnVector(3)) == 0);
+  CHECK(max_diff<double>((a - b).inverse(), diff.inverse()) == 0);
+  CHECK(max_diff<double>((a - b).solve(m), diff.solve(m)) == 0);
+  CHECK(max_diff<double>(m.transpose() / (a - b), m.transpose() / diff) == 0);
+  CHECK((a - b).determinant() == diff.determinant());
+  CHECK((a + a.transpose()).isSymmetric() && !(a + b * 0.5).isSymmetric());
+  CHECK((a + b).isSquare() && !(a + b).isDiagonal() && (a + b).isDifferentSize(m));
+
+  { // a view of an expression outlives the expression
+    mat_t::transposed_t t((a + b).transpose());
+    CHECK(max_diff<double>(t, sum.transpose()) == 0);
+  }
+}
+
+int main(){
+  test_evaluation();
+  test_members();
+  return test_result("expression");
+}
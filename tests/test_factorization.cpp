@@ -0,0 +1,170 @@
+/*
+ * Factorizations of square matrices and the solvers on them.
+ */
+#include "test.h"
+
+typedef Matrix<double> mat_t;
+
+static const unsigned int sizes[] = {1, 2, 3, 5, 17, 64, 65, 130};
+
+static double max_abs(const mat_t &a){
+  return max_diff(a, mat_t(a.rows(), a.columns()));
+}
+
+static mat_t lower_part(const mat_t &a, const bool &unit){
+  mat_t res(a.rows(), a.columns());
+  for(unsigned int i(0); i < a.rows(); i++){
+    for(unsigned int j(0); j < i; j++){res(i, j) = a(i, j);}
+    res(i, i) = unit ? 1 : a(i, i);
+  }
+  return res;
+}
+
+static void test_lu(const unsigned int &n){
+  mat_t a(random_matrix<double>(n, n)), b(random_matrix<double>(n, 3));
+  CHECK(max_abs(a * a.solve(b) - b) < 1E-9);
+
+  // P * A = L * U
+  mat_t lu(a.copy());
+  unsigned int *pivot(new unsigned int[n]);
+  CHECK(lu.decomposeLUP(pivot));
+  mat_t pa(a.copy());
+  for(unsigned int i(0); i < n; i++){pa.exchangeRows(i, pivot[i]);}
+  CHECK(max_abs(lower_part(lu, true) * lower_part(lu.transpose(), false).transpose() - pa) < 1E-12);
+  CHECK(max_abs(a * lu.solveLUP(pivot, b) - b) < 1E-9);
+  delete [] pivot;
+
+  // in place on a view
+  mat_t big(random_matrix<double>(n + 3, n + 3)), keep(big.copy()), sub(big.partial(n, n, 1, 2).copy());
+  unsigned int *pivot2(new unsigned int[n]);
+  mat_t::partial_t view(big.partial(n, n, 1, 2));
+  view.decomposeLUP(pivot2);
+  sub.decomposeLUP(pivot2);
+  CHECK(max_diff<double>(big.partial(n, n, 1, 2), sub) == 0);
+  CHECK(big(0, 0) == keep(0, 0));
+  delete [] pivot2;
+}
+
+static void test_determinant(const unsigned int &n){
+  // product of the diagonal of U, whose sign is flipped by each row exchange
+  mat_t a(random_matrix<double>(n, n)), lu(a.copy());
+  unsigned int *pivot(new unsigned int[n]);
+  lu.decomposeLUP(pivot);
+  double det(1);
+  for(unsigned int i(0); i < n; i++){
+    det *= lu(i, i);
+    if(pivot[i] != i){det = -det;}
+  }
+  delete [] pivot;
+  CHECK(std::fabs(a.determinant() - det) < 1E-12 * (1 + std::fabs(det)));
+  int sign;
+  double log_det(a.logDeterminant(&sign));
+  CHECK((sign == (det > 0 ? 1 : -1)) && (std::fabs(log_det - std::log(std::fabs(det))) < 1E-9));
+}
+
+static void test_symmetric(const unsigned int &n){
+  mat_t g(random_matrix<double>(n, n)), b(random_matrix<double>(n, 3));
+  mat_t a(g * g.transpose() + mat_t::getI(n) * (double)n);
+  double scale(max_abs(a));
+
+  mat_t c(a.copy());
+  CHECK(c.decomposeCholesky(true));
+  mat_t l(lower_part(c, false));
+  CHECK(max_abs(l * l.transpose() - a) < 1E-12 * scale);
+  CHECK(max_abs(a * c.solveCholesky(b) - b) < 1E-9);
+  bool upper_kept(true);
+  for(unsigned int i(0); i < n; i++){
+    for(unsigned int j(i + 1); j < n; j++){upper_kept &= (c(i, j) == a(i, j));}
+  }
+  CHECK(upper_kept);
+
+  mat_t d(a.copy());
+  CHECK(d.decomposeLDL());
+  mat_t l1(lower_part(d, true)), diag(n, n);
+  for(unsigned int i(0); i < n; i++){diag(i, i) = d(i, i);}
+  CHECK(max_abs(l1 * diag * l1.transpose() - a) < 1E-12 * scale);
+  CHECK(max_abs(a * d.solveLDL(b) - b) < 1E-9);
+
+  mat_t u(l.transpose().copy());
+  CHECK(max_abs(u * u.solveTriangular(b, false) - b) < 1E-9);
+  CHECK(max_abs(u.transpose() * u.solveTriangular(b, false, false, true) - b) < 1E-9);
+  CHECK(max_abs(l * l.solveTriangular(b, true) - b) < 1E-9);
+}
+
+static void test_inverse(const unsigned int &n){
+  mat_t I(mat_t::getI(n)), a(random_matrix<double>(n, n)), g(random_matrix<double>(n, n)), b(random_matrix<double>(7, n));
+  for(unsigned int i(0); i < n; i++){a(i, i) += 3;}
+  mat_t spd(g * g.transpose() + I * (double)n), indefinite(g + g.transpose());
+
+  CHECK(max_abs(a * a.inverse() - I) < 1E-10);
+  CHECK(max_abs(spd * spd.inverse() - I) < 1E-10);
+  CHECK(spd.inverse().isSymmetric());
+  CHECK(max_abs(indefinite * indefinite.inverse() - I) < 1E-6);
+  CHECK(max_abs((b / a) * a - b) < 1E-10);
+  CHECK(max_abs((b / a.transpose()) * a.transpose() - b) < 1E-10);
+  mat_t c(b.copy());
+  c /= a;
+  CHECK(max_abs(c - b / a) == 0);
+
+  double log_det(spd.logDeterminant());
+  mat_t chol(spd.copy());
+  chol.decomposeCholesky();
+  double log_det_ref(0);
+  for(unsigned int i(0); i < n; i++){log_det_ref += 2 * std::log(chol(i, i));}
+  CHECK(std::fabs(log_det - log_det_ref) < 1E-9 * (1 + std::fabs(log_det_ref)));
+}
+
+int main(){
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){test_lu(sizes[i]);}
+  { // pivoting is required
+    double v[] = {0, 1, 1, 0};
+    mat_t a(2, 2, v), b(random_matrix<double>(2, 3));
+    CHECK(max_abs(a * a.solve(b) - b) == 0);
+    double w[] = {1, 2, 3, 2, 4, 5, 3, 5, 0}; // zero pivot after the first elimination
+    mat_t c(3, 3, w), d(random_matrix<double>(3, 2));
+    CHECK(max_abs(c * c.solve(d) - d) < 1E-12);
+  }
+
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){test_determinant(sizes[i]);}
+  {
+    double v[] = {2, 1, 0, 1, 3, 1, 0, 1, 4};
+    CHECK(std::fabs(mat_t(3, 3, v).determinant() - 18) < 1E-12);
+    double w[] = {1, 2, 2, 4};
+    CHECK(mat_t(2, 2, w).determinant() == 0);
+    double x[] = {0, 1, 1, 0}; // pivoting is required
+    int sign;
+    CHECK((mat_t(2, 2, x).determinant() == -1) && (mat_t(2, 2, x).logDeterminant(&sign) == 0) && (sign == -1));
+    mat_t big(mat_t::getScalar(400, 10.)); // overflows without the logarithm
+    CHECK(std::fabs(big.logDeterminant(&sign) - 400 * std::log(10.)) < 1E-9);
+    CHECK(sign == 1);
+  }
+
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){test_symmetric(sizes[i]);}
+  { // not positive definite
+    double v[] = {1, 2, 2, 1};
+    CHECK(!mat_t(2, 2, v).copy().decomposeCholesky());
+  }
+  { // float
+    Matrix<float> g(random_matrix<float>(50, 50)), b(random_matrix<float>(50, 2));
+    Matrix<float> a(g * g.transpose() + Matrix<float>::getI(50) * 50.f), c(a.copy());
+    CHECK(c.decomposeCholesky());
+    CHECK(max_diff<float>(a * c.solveCholesky(b), b) < 1E-4);
+  }
+
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){test_inverse(sizes[i]);}
+  { // pivoting is required
+    double v[] = {0, 1, 1, 0};
+    mat_t a(2, 2, v);
+    CHECK(max_abs(a * a.inverse() - mat_t::getI(2)) == 0);
+    double w[] = {1, 2, 3, 2, 4, 5, 3, 5, 0}; // zero pivot after the first elimination
+    mat_t b(3, 3, w);
+    CHECK(max_abs(b * b.inverse() - mat_t::getI(3)) < 1E-12);
+  }
+  { // float
+    Matrix<float> g(random_matrix<float>(50, 50));
+    Matrix<float> a(g * g.transpose() + Matrix<float>::getI(50) * 50.f);
+    CHECK(max_diff<float>(a * a.inverse(), Matrix<float>::getI(50)) < 1E-4);
+  }
+
+  return test_result("factorization");
+}
@@ -0,0 +1,38 @@
+/*
+ * FixedMatrix, whose size is a template parameter, against Matrix.
+ */
+#include "test.h"
+
+typedef Matrix<double> mat_t;
+
+template <unsigned int N>
+static void test_fixed(){
+  mat_t a(random_matrix<double>(N, N)), b(random_matrix<double>(N, 2));
+  for(unsigned int i(0); i < N; i++){a(i, i) += 3;}
+  FixedMatrix<double, N> fa(a);
+  FixedMatrix<double, N, 2> fb(b);
+  const double tol(1E-12 * (N + 1));
+
+  CHECK(max_diff(fa.dynamic(), a) == 0);
+  CHECK(max_diff<double>((fa * fb).dynamic(), a * b) < tol);
+  CHECK(max_diff<double>((fa + fa * 2.0 - fa.transpose().transpose()).dynamic(), a * 2.0) < tol);
+  CHECK(max_diff<double>(fa * a, a * a) < tol);
+  CHECK(max_diff<double>(fa.inverse().dynamic(), a.inverse()) < tol);
+  CHECK(max_diff<double>((fa.inverse() * fa).dynamic(), mat_t::getI(N)) < tol);
+  CHECK(std::fabs(fa.determinant() - a.determinant()) < tol * (1 + std::fabs(a.determinant())));
+}
+
+int main(){
+  test_fixed<1>();
+  test_fixed<2>();
+  test_fixed<3>();
+  test_fixed<4>();
+  test_fixed<5>();
+  test_fixed<6>();
+  test_fixed<15>();
+  {
+    FixedMatrix<float, 3> f(FixedMatrix<float, 3>::getI() * 2.f);
+    CHECK((f.inverse()(1, 1) == 0.5f) && (f.determinant() == 8.f) && (f.trace() == 6.f));
+  }
+  return test_result("fixed");
+}
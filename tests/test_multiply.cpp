@@ -0,0 +1,235 @@
+/*
+ * Multiplication: the packed GEMM engine, GEMV, their parallel paths,
+ * the allocation-free multiply_into(), and each SIMD kernel against
+ * the generic one.
+ */
+#include "test.h"
+
+template <class T>
+static Matrix<T> reference_product(const Matrix<T> &a, const Matrix<T> &b){
+  Matrix<T> res(a.rows(), b.columns());
+  for(unsigned int i(0); i < a.rows(); i++){
+    for(unsigned int j(0); j < b.columns(); j++){
+      double sum(0);
+      for(unsigned int k(0); k < a.columns(); k++){sum += (double)a(i, k) * (double)b(k, j);}
+      res(i, j) = (T)sum;
+    }
+  }
+  return res;
+}
+
+template <class T>
+static double tolerance(const unsigned int &k){
+  return (sizeof(T) == sizeof(float) ? 1E-5 : 1E-13) * (k + 1);
+}
+
+template <class T>
+static void test_gemm(const unsigned int &r1, const unsigned int &c1, const unsigned int &c2){
+  Matrix<T> a(random_matrix<T>(r1, c1)), b(random_matrix<T>(c1, c2));
+  Matrix<T> at(a.transpose().copy()), bt(b.transpose().copy());
+  Matrix<T> ab(reference_product(a, b));
+  const double tol(tolerance<T>(c1));
+
+  CHECK(max_diff<T>(a * b, ab) < tol);
+  CHECK(max_diff<T>(at.transpose() * b, ab) < tol);
+  CHECK(max_diff<T>(a * bt.transpose(), ab) < tol);
+  CHECK(max_diff<T>(at.transpose() * bt.transpose(), ab) < tol);
+  CHECK(max_diff<T>((bt * at).transpose(), ab) < tol);
+
+  // operands and destination are views with strides
+  Matrix<T> a_big(random_matrix<T>(r1 + 3, c1 + 2));
+  a_big.partial(r1, c1, 2, 1) = a;
+  CHECK(max_diff<T>(a_big.partial(r1, c1, 2, 1) * b, ab) < tol);
+
+  Matrix<T> c(random_matrix<T>(r1 + 2, c2 + 1)), c0(c.copy());
+  typename Matrix<T>::partial_t c_view(c.partial(r1, c2, 1, 1));
+  multiply_into(c_view, a, b, T(2), T(0.5));
+  Matrix<T> expected(c0.copy());
+  for(unsigned int i(0); i < r1; i++){
+    for(unsigned int j(0); j < c2; j++){
+      expected(i + 1, j + 1) = ab(i, j) * T(2) + c0(i + 1, j + 1) * T(0.5);
+    }
+  }
+  CHECK(max_diff(c, expected) < tol * 4);
+
+  Matrix<T> d(c2, r1);
+  multiply_into(d, bt, at, T(1), T(0), false, false);
+  CHECK(max_diff<T>(d, ab.transpose()) < tol);
+}
+
+template <class T>
+static void test_gemv(const unsigned int &m, const unsigned int &n){
+  Matrix<T> a(random_matrix<T>(m, n)), x(random_matrix<T>(n, 1)), y(random_matrix<T>(1, m));
+  const double tol(tolerance<T>(n > m ? n : m));
+
+  CHECK(max_diff<T>(a * x, reference_product(a, x)) < tol);
+  CHECK(max_diff<T>(y * a, reference_product(y, a)) < tol);
+  CHECK(max_diff<T>(a.transpose() * y.transpose(),
+      reference_product<T>(a.transpose().copy(), y.transpose().copy())) < tol);
+
+  Matrix<T> w(random_matrix<T>(n, 3));
+  CHECK(max_diff<T>(a * w.columnVector(1), reference_product<T>(a, w.columnVector(1).copy())) < tol);
+
+  Matrix<T> c(random_matrix<T>(m, 3)), c0(c.copy());
+  typename Matrix<T>::partial_t c_view(c.columnVector(1));
+  multiply_into(c_view, a, x, T(2), T(0.5));
+  Matrix<T> ax(reference_product(a, x));
+  double err(0);
+  for(unsigned int i(0); i < m; i++){
+    double d(std::fabs((double)c(i, 1) - (2 * (double)ax(i, 0) + 0.5 * (double)c0(i, 1))));
+    if(d > err){err = d;}
+    CHECK((c(i, 0) == c0(i, 0)) && (c(i, 2) == c0(i, 2)));
+  }
+  CHECK(err < tol * 4);
+}
+
+template <class T>
+static void test_products(){
+  static const unsigned int sizes[][3] = {
+    {1, 1, 1}, {3, 3, 3}, {7, 5, 9}, {17, 33, 19}, {64, 64, 64},
+    {100, 37, 129}, {1, 50, 1}, {50, 1, 50}, {130, 257, 70}, {40, 600, 30}};
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){
+    test_gemm<T>(sizes[i][0], sizes[i][1], sizes[i][2]);
+  }
+  static const unsigned int vector_sizes[] = {1, 2, 3, 4, 5, 8, 9, 17, 33, 100};
+  for(unsigned int i(0); i < sizeof(vector_sizes) / sizeof(vector_sizes[0]); i++){
+    for(unsigned int j(0); j < sizeof(vector_sizes) / sizeof(vector_sizes[0]); j++){
+      test_gemv<T>(vector_sizes[i], vector_sizes[j]);
+    }
+  }
+}
+
+#if defined(MATRIX_SIMD_X86)
+/*
+ * Each SIMD kernel is called directly and compared with the generic kernel
+ * or a reference, because the runtime dispatch selects only the widest instruction set
+ * of the running CPU (see also MATRIX_SIMD_MAX_ISA).
+ */
+template <class traits_t>
+static void test_simd_mul_kernel(
+    typename mat_mul_kernel_t<typename traits_t::float_t>::kernel_t kernel){
+  typedef typename traits_t::float_t T;
+  static const int mr(traits_t::mr), nr(traits_t::nr), kc(37), c_rs(nr + 3);
+  T a[mr * kc], b[kc * nr], c[mr * c_rs], c_ref[mr * c_rs];
+  for(int i(0); i < mr * kc; i++){a[i] = T(std::rand()) / RAND_MAX - T(0.5);}
+  for(int i(0); i < kc * nr; i++){b[i] = T(std::rand()) / RAND_MAX - T(0.5);}
+  for(int i(0); i < mr * c_rs; i++){c[i] = c_ref[i] = T(i);}
+  kernel(kc, a, 1, mr, b, nr, c, c_rs); // packed A, A(i, k) = a[i + k * mr]
+  for(int i(0); i < mr; i++){
+    for(int j(0); j < nr; j++){
+      double sum(c_ref[i * c_rs + j]);
+      for(int k(0); k < kc; k++){sum += (double)a[i + k * mr] * (double)b[k * nr + j];}
+      c_ref[i * c_rs + j] = (T)sum;
+    }
+  }
+  double err(0);
+  for(int i(0); i < mr * c_rs; i++){
+    double d(std::fabs((double)c[i] - (double)c_ref[i]));
+    if(d > err){err = d;}
+  }
+  CHECK(err < tolerance<T>(kc) * 10);
+}
+
+template <class traits_t>
+static void test_simd_gemv_kernels(
+    typename mat_gemv_kernel_t<typename traits_t::float_t>::dot_t dot,
+    typename mat_gemv_kernel_t<typename traits_t::float_t>::axpy_t axpy){
+  typedef typename traits_t::float_t T;
+  static const int sizes[] = {1, 3, 4, 7, 16, 17, 35};
+  for(unsigned int p(0); p < sizeof(sizes) / sizeof(sizes[0]); p++){
+    for(unsigned int q(0); q < sizeof(sizes) / sizeof(sizes[0]); q++){
+      const int m(sizes[p]), n(sizes[q]), ld(n + 2);
+      T a[35 * 37], x[35 * 2], y[35 * 2], y_ref[35 * 2];
+      for(int i(0); i < 35 * 37; i++){a[i] = T(std::rand()) / RAND_MAX - T(0.5);}
+      for(int i(0); i < 70; i++){
+        x[i] = T(std::rand()) / RAND_MAX - T(0.5);
+        y[i] = y_ref[i] = T(i);
+      }
+      const double tol(tolerance<T>(m + n) * 10);
+
+      dot(m, n, T(1.5), a, ld, x, y, 2);
+      mat_gemv_dot_generic(m, n, T(1.5), a, ld, x, y_ref, 2);
+      double err(0);
+      for(int i(0); i < 70; i++){
+        double d(std::fabs((double)y[i] - (double)y_ref[i]));
+        if(d > err){err = d;}
+      }
+      CHECK(err < tol);
+
+      // a is n columns of m elements, which are ld apart
+      for(int i(0); i < 70; i++){y[i] = y_ref[i] = T(i);}
+      axpy(m, n, T(-0.5), a, ld, x, 2, y);
+      mat_gemv_axpy_generic(m, n, T(-0.5), a, ld, x, 2, y_ref);
+      err = 0;
+      for(int i(0); i < 70; i++){
+        double d(std::fabs((double)y[i] - (double)y_ref[i]));
+        if(d > err){err = d;}
+      }
+      CHECK(err < tol);
+    }
+  }
+}
+
+template <class T>
+static void test_simd_transpose_kernel(
+    typename mat_transpose_kernel_t<T>::kernel_t kernel){
+  static const int r(21), c(19), x_cs(23), y_rs(25);
+  T x[r + x_cs * c], y[r * y_rs], y_ref[r * y_rs];
+  for(int i(0); i < r + x_cs * c; i++){x[i] = T(i);}
+  for(int i(0); i < r * y_rs; i++){y[i] = y_ref[i] = T(-1);}
+  kernel(r, c, x, x_cs, y, y_rs);
+  mat_transpose_kernel_generic(r, c, (const T *)x, x_cs, y_ref, y_rs);
+  bool same(true);
+  for(int i(0); i < r * y_rs; i++){same &= (y[i] == y_ref[i]);}
+  CHECK(same);
+}
+
+template <class T>
+static void test_simd_kernels(){
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse2")){
+    typedef mat_mul_simd_traits_t<T, MAT_MUL_SIMD_SSE2> traits_t;
+    test_simd_mul_kernel<traits_t>(mat_mul_simd_kernel_sse2<traits_t>);
+    test_simd_gemv_kernels<traits_t>(
+        mat_gemv_simd_dot_sse2<traits_t>, mat_gemv_simd_axpy_sse2<traits_t>);
+    test_simd_transpose_kernel<T>(mat_transpose_simd_kernel_sse2<T, 16 / sizeof(T)>);
+  }
+  if(__builtin_cpu_supports("avx")){
+    test_simd_transpose_kernel<T>(mat_transpose_simd_kernel_avx<T, 32 / sizeof(T)>);
+  }
+  if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+    typedef mat_mul_simd_traits_t<T, MAT_MUL_SIMD_AVX2> traits_t;
+    test_simd_mul_kernel<traits_t>(mat_mul_simd_kernel_avx2<traits_t>);
+    test_simd_gemv_kernels<traits_t>(
+        mat_gemv_simd_dot_avx2<traits_t>, mat_gemv_simd_axpy_avx2<traits_t>);
+  }
+  if(__builtin_cpu_supports("avx512f")){
+    typedef mat_mul_simd_traits_t<T, MAT_MUL_SIMD_AVX512> traits_t;
+    test_simd_mul_kernel<traits_t>(mat_mul_simd_kernel_avx512<traits_t>);
+    test_simd_gemv_kernels<traits_t>(
+        mat_gemv_simd_dot_avx512<traits_t>, mat_gemv_simd_axpy_avx512<traits_t>);
+  }
+}
+#endif
+
+int main(){
+  test_products<double>();
+  test_products<float>();
+
+#if defined(MATRIX_THREADING)
+  // above MATRIX_GEMM_PARALLEL_THRESHOLD and MATRIX_GEMV_PARALLEL_THRESHOLD
+  Matrix_ThreadPool::get().resize(4);
+  test_gemm<double>(200, 150, 210);
+  test_gemm<float>(150, 200, 130);
+  test_gemv<double>(5000, 120);
+  Matrix_ThreadPool::get().resize(1);
+  test_gemm<double>(200, 150, 210);
+#endif
+
+#if defined(MATRIX_SIMD_X86)
+  test_simd_kernels<double>();
+  test_simd_kernels<float>();
+#endif
+
+  return test_result("multiply");
+}
@@ -0,0 +1,133 @@
+/*
+ * Orthogonal factorizations and the solvers on them.
+ */
+#include "test.h"
+
+typedef Matrix<double> mat_t;
+
+static double max_abs(const mat_t &a){
+  return max_diff(a, mat_t(a.rows(), a.columns()));
+}
+
+static void test_qr(const unsigned int &m, const unsigned int &n){
+  mat_t a(random_matrix<double>(m, n)), b(random_matrix<double>(m, 3));
+  const unsigned int k(m < n ? m : n);
+
+  mat_t q, r;
+  a.decomposeQR(q, r);
+  CHECK((q.rows() == m) && (q.columns() == k) && (r.rows() == k) && (r.columns() == n));
+  CHECK(max_abs(q * r - a) < 1E-12);
+  CHECK(max_abs(q.transpose() * q - mat_t::getI(k)) < 1E-12);
+  bool upper(true);
+  for(unsigned int i(0); i < r.rows(); i++){
+    for(unsigned int j(0); (j < i) && (j < n); j++){upper &= (r(i, j) == 0);}
+  }
+  CHECK(upper);
+
+  mat_t q_full, r_full;
+  a.decomposeQR(q_full, r_full, false);
+  CHECK(max_abs(q_full * r_full - a) < 1E-12);
+  CHECK(max_abs(q_full * q_full.transpose() - mat_t::getI(m)) < 1E-12);
+
+  { // compact form
+    mat_t qr(a.copy());
+    double *tau(new double[k]);
+    qr.decomposeQR(tau);
+    CHECK(max_abs(qr.multiplyQ(tau, qr.multiplyQ(tau, b, true)) - b) < 1E-12);
+    delete [] tau;
+  }
+
+  mat_t x(a.leastSquares(b));
+  CHECK((x.rows() == n) && (x.columns() == 3));
+  if(m >= n){ // A^{T} (A X - B) = 0
+    CHECK(max_abs(a.transpose() * (a * x - b)) < 1E-10);
+  }else{ // exact, and of minimum norm, i.e., X in range(A^{T})
+    CHECK(max_abs(a * x - b) < 1E-10);
+    CHECK(max_abs(a.transpose() * (a * a.transpose()).solve(a * x) - x) < 1E-9);
+  }
+
+  { // in place on a view
+    mat_t big(random_matrix<double>(m + 3, n + 2)), keep(big.copy()), sub(big.partial(m, n, 2, 1).copy());
+    double *tau(new double[k]), *tau2(new double[k]);
+    mat_t::partial_t view(big.partial(m, n, 2, 1));
+    view.decomposeQR(tau);
+    sub.decomposeQR(tau2);
+    CHECK(max_diff<double>(big.partial(m, n, 2, 1), sub) == 0);
+    CHECK((big(0, 0) == keep(0, 0)) && (big(m + 2, n + 1) == keep(m + 2, n + 1)));
+    delete [] tau;
+    delete [] tau2;
+  }
+}
+
+static void test_eigen(const mat_t &a){
+  const unsigned int n(a.rows());
+  mat_t w, v, w2;
+  CHECK(a.decomposeEigenSymmetric(w, &v, true));
+  CHECK(a.decomposeEigenSymmetric(w2));
+  CHECK((w.rows() == n) && (w.columns() == 1) && (v.rows() == n) && (v.columns() == n));
+
+  const double scale((1 + max_abs(a)) * (n + 1));
+  mat_t lambda(n, n);
+  for(unsigned int i(0); i < n; i++){lambda(i, i) = w(i, 0);}
+  CHECK(max_abs(a * v - v * lambda) < 1E-12 * scale);
+  CHECK(max_abs(v.transpose() * v - mat_t::getI(n)) < 1E-12 * (n + 1));
+  CHECK(max_abs(w - w2) < 1E-12 * scale);
+  bool ascending(true);
+  for(unsigned int i(1); i < n; i++){ascending &= (w(i - 1, 0) <= w(i, 0));}
+  CHECK(ascending);
+}
+
+int main(){
+  static const unsigned int ms[] = {1, 2, 3, 7, 64, 65, 130};
+  static const unsigned int ns[] = {1, 2, 4, 7, 64, 65, 129};
+  for(unsigned int i(0); i < sizeof(ms) / sizeof(ms[0]); i++){
+    for(unsigned int j(0); j < sizeof(ns) / sizeof(ns[0]); j++){test_qr(ms[i], ns[j]);}
+  }
+  { // rank deficient, where a reflector is the identity (tau = 0)
+    mat_t a(5, 3);
+    for(unsigned int i(0); i < 5; i++){a(i, 0) = i + 1; a(i, 2) = i * i;}
+    mat_t q, r;
+    a.decomposeQR(q, r);
+    CHECK(max_abs(q * r - a) < 1E-12);
+  }
+  { // ill-conditioned polynomial fit
+    const unsigned int m(100), n(9);
+    mat_t a(m, n), c(n, 1);
+    for(unsigned int i(0); i < m; i++){
+      double x(1 + (double)i / m), p(1);
+      for(unsigned int j(0); j < n; j++){a(i, j) = p; p *= x;}
+    }
+    for(unsigned int j(0); j < n; j++){c(j, 0) = 1;}
+    CHECK(max_abs(a.leastSquares(a * c) - c) < 1E-5);
+  }
+  { // float
+    Matrix<float> b(random_matrix<float>(50, 4)), y(random_matrix<float>(50, 1));
+    CHECK(max_diff<float>(b.transpose() * (b * b.leastSquares(y) - y), Matrix<float>(4, 1)) < 1E-4);
+  }
+
+  static const unsigned int sizes[] = {0, 1, 2, 3, 5, 17, 64, 65, 130};
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){
+    const unsigned int n(sizes[i]);
+    mat_t g(random_matrix<double>(n, n)), s(g + g.transpose());
+    test_eigen(s);
+    test_eigen(s.toSymmetricPacked());
+    test_eigen(s.toBanded(1, 1)); // tridiagonal
+    test_eigen(mat_t::getScalar(n, 2.5));
+    test_eigen(mat_t(n, n));
+  }
+  { // known values
+    double v[] = {2, 1, 1, 2};
+    mat_t w;
+    mat_t(2, 2, v).decomposeEigenSymmetric(w);
+    CHECK((std::fabs(w(0, 0) - 1) < 1E-15) && (std::fabs(w(1, 0) - 3) < 1E-15));
+  }
+  { // float
+    Matrix<float> a(random_matrix<float>(20, 20)), s(a + a.transpose()), w, v;
+    CHECK(s.decomposeEigenSymmetric(w, &v));
+    Matrix<float> lambda(20, 20);
+    for(unsigned int i(0); i < 20; i++){lambda(i, i) = w(i, 0);}
+    CHECK(max_diff<float>(s * v, v * lambda) < 1E-4);
+  }
+
+  return test_result("qr_eigen");
+}
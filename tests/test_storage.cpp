@@ -0,0 +1,265 @@
+/*
+ * Dense storage: ownership and sharing of the buffer, views, 
+ * memory layout, and allocation.
+ */
+#include "test.h"
+
+#if defined(MATRIX_THREADING) && defined(MATRIX_ATOMIC_REFCOUNT)
+#include <thread>
+#endif
+
+typedef Matrix<double> mat_t;
+
+static mat_t sequence(const unsigned int &rows, const unsigned int &columns){
+  mat_t res(rows, columns);
+  for(unsigned int i(0); i < rows; i++){
+    for(unsigned int j(0); j < columns; j++){res(i, j) = i * 10 + j;}
+  }
+  return res;
+}
+
+static const double *buffer_of(const mat_t &m){
+  mat_t::view_t v;
+  return m.storage()->view(v) ? v.buffer : NULL;
+}
+
+#if __cplusplus >= 201103L
+static void test_move(){
+  mat_t a(sequence(3, 3));
+  const double *buffer(buffer_of(a));
+  mat_t b(std::move(a));
+  CHECK(buffer_of(b) == buffer);
+  mat_t c;
+  c = std::move(b);
+  CHECK((buffer_of(c) == buffer) && (c(2, 1) == 21));
+  c = std::move(c);
+  CHECK((buffer_of(c) == buffer) && (c(1, 2) == 12));
+}
+#endif
+
+static void test_views(){
+  mat_t a(random_matrix<double>(7, 9)), b(random_matrix<double>(9, 7));
+  mat_t pt(a.transpose().partial(4, 3, 2, 1));
+  mat_t::view_t v;
+  CHECK(pt.storage()->view(v));
+  bool same(true);
+  for(int i(0); i < 4; i++){
+    for(int j(0); j < 3; j++){
+      same &= (v.buffer[i * v.row_stride + j * v.column_stride] == a(j + 1, i + 2));
+    }
+  }
+  CHECK(same);
+  mat_t pt_copy(pt.copy());
+  CHECK(max_diff<double>(pt + b.partial(4, 3, 0, 0), pt_copy + b.partial(4, 3, 0, 0).copy()) == 0);
+  CHECK(max_diff<double>(pt * 2.0, pt_copy * 2.0) == 0);
+
+  mat_t c(a.copy()), expected(a.copy());
+  {mat_t::partial_t p(c.partial(3, 4, 2, 3)); p *= 3.0; p += b.partial(3, 4, 0, 0);}
+  for(int i(0); i < 3; i++){
+    for(int j(0); j < 4; j++){expected(i + 2, j + 3) = expected(i + 2, j + 3) * 3.0 + b(i, j);}
+  }
+  CHECK(max_diff(c, expected) == 0);
+}
+
+static void test_shared_buffer(){
+  // the buffer and its counter are released together with the last copy, whichever it is
+  mat_t *a(new mat_t(sequence(3, 3)));
+  const double *buffer(buffer_of(*a));
+  mat_t b(*a), c;
+  c = b;
+  delete a;
+  CHECK((buffer_of(b) == buffer) && (buffer_of(c) == buffer));
+  b = mat_t();
+  const mat_t &c_const(c);
+  CHECK((buffer_of(c) == buffer) && (c_const(2, 1) == 21));
+}
+
+#if defined(MATRIX_THREADING) && defined(MATRIX_ATOMIC_REFCOUNT)
+static void test_atomic_refcount(){
+  // copies of a matrix shared among threads
+  mat_t a(sequence(20, 20));
+  std::vector<std::thread> threads;
+  std::atomic<int> failures(0);
+  for(int t(0); t < 4; t++){
+    threads.push_back(std::thread([&a, &failures, t](){
+      for(int k(0); k < 1000; k++){
+        mat_t b(a);
+        b(0, 0) = t;
+        if((b(0, 0) != t) || (b(19, 19) != 209)){++failures;}
+      }
+    }));
+  }
+  for(int t(0); t < 4; t++){threads[t].join();}
+  CHECK((failures == 0) && (a(0, 0) == 0));
+}
+#endif
+
+static void test_copy_on_write(){
+  { // copies share the buffer until written
+    mat_t a(sequence(3, 3)), b(a);
+    CHECK(buffer_of(a) == buffer_of(b));
+    const mat_t &b_const(b);
+    CHECK(b_const(1, 1) == 11);
+    CHECK(buffer_of(a) == buffer_of(b));
+    b(1, 1) = -1;
+    CHECK(buffer_of(a) != buffer_of(b));
+    CHECK((a(1, 1) == 11) && (b(1, 1) == -1) && (b(2, 2) == 22));
+  }
+  { // member functions writing in place
+    mat_t a(sequence(3, 3));
+    mat_t b(a); b *= 2;
+    mat_t c(a); c += a;
+    mat_t d(a); d.exchangeRows(0, 1);
+    mat_t e(a); e.clear();
+    mat_t f(a); add_into(f, a, 1., 1.);
+    CHECK((a(2, 2) == 22) && (a(1, 0) == 10) && (a(0, 0) == 0));
+    CHECK((b(2, 2) == 44) && (c(1, 0) == 20) && (d(0, 0) == 10) && (e(1, 0) == 0) && (f(1, 1) == 22));
+  }
+  { // views write through, and a copy taken while a view is alive is deep
+    mat_t a(sequence(3, 3)), b(a);
+    a.partial(2, 2, 1, 1) = mat_t(2, 2);
+    CHECK((a(1, 1) == 0) && (b(1, 1) == 11));
+    mat_t::partial_t p(a.partial(2, 2, 0, 0));
+    p(0, 1) = 7;
+    CHECK(a(0, 1) == 7);
+    mat_t c(a);
+    CHECK(buffer_of(c) != buffer_of(a));
+    c(0, 0) = 100;
+    CHECK((a(0, 0) == 0) && (p(0, 0) == 0));
+    a.transpose() = sequence(3, 3);
+    CHECK((a(1, 0) == 1) && (b(1, 0) == 10));
+    a.rowVector(2) *= 0.;
+    CHECK((a(2, 1) == 0) && (b(2, 1) == 21));
+  }
+  { // the buffer becomes shareable again after the views are gone
+    mat_t a(sequence(3, 3));
+    {mat_t::partial_t p(a.partial(1, 1, 0, 0)); p(0, 0) = 1;}
+    mat_t b(a);
+    CHECK(buffer_of(a) == buffer_of(b));
+    b(0, 0) = 2;
+    CHECK(a(0, 0) == 1);
+  }
+}
+
+static double allocator_step(const mat_t &a, const mat_t &b){
+  mat_t c(a * b), d(c + a), e(d.transpose() * b), f(e.copy());
+  f *= 2.;
+  return f(1, 1) + f.inverse()(0, 0);
+}
+
+static void test_allocators(){
+  mat_t a(3, 3), b(3, 3);
+  for(unsigned int i(0); i < 3; i++){
+    for(unsigned int j(0); j < 3; j++){
+      a(i, j) = 1 + i + j * j + (i == j) * 5;
+      b(i, j) = (i == j) + 0.1 * j;
+    }
+  }
+  const double expected(allocator_step(a, b));
+  {
+    Matrix_PoolAllocator pool;
+    Matrix_Allocator::scope_t scope(pool);
+    for(int k(0); k < 100; k++){CHECK(allocator_step(a, b) == expected);}
+  }
+  {
+    Matrix_ArenaAllocator arena(4096);
+    for(int frame(0); frame < 20; frame++){
+      {
+        Matrix_Allocator::scope_t scope(arena);
+        CHECK(allocator_step(a, b) == expected);
+        mat_t big(100, 100); // larger than a chunk
+        big(99, 99) = 1;
+        CHECK(big(99, 99) == 1);
+      }
+      CHECK(arena.live() == 0);
+      arena.reset();
+    }
+  }
+  { // a matrix outliving the scope returns its buffer to its allocator
+    Matrix_PoolAllocator pool;
+    mat_t keep;
+    {Matrix_Allocator::scope_t scope(pool); keep = a * b;}
+    mat_t other(keep);
+    other(0, 0) = 3;
+    CHECK(keep(0, 0) != 3);
+    keep = mat_t();
+  }
+  CHECK(&Matrix_Allocator::current() == &Matrix_Allocator::heap());
+}
+
+static void test_layout(){
+  static const unsigned int sizes[] = {1, 3, 31, 32, 33, 67, 256, 513};
+  for(unsigned int p(0); p < sizeof(sizes) / sizeof(sizes[0]); p++){
+    for(unsigned int q(0); q < sizeof(sizes) / sizeof(sizes[0]); q++){
+      const unsigned int r(sizes[p]), c(sizes[q]);
+      if(r * c > 100000){continue;}
+      mat_t x(random_matrix<double>(r, c));
+      mat_t::view_t v;
+      x.storage()->view(v);
+      CHECK(v.row_stride >= (int)c);
+#if !defined(MATRIX_NO_ROW_PADDING)
+      if((r > 1) && (c * sizeof(double) >= MATRIX_ROW_PADDING_THRESHOLD)){
+        CHECK((v.row_stride * sizeof(double)) % MATRIX_SIMD_WIDTH == 0);
+        CHECK((v.row_stride * sizeof(double)) % 4096 != 0);
+      }
+#endif
+      if(r * c * sizeof(double) >= 4 * MATRIX_ALIGNMENT){
+        CHECK(((std::size_t)v.buffer) % MATRIX_ALIGNMENT == 0);
+      }
+      // the padding is invisible from the element access and the serialized form
+      double *serialized(new double[r * c]);
+      for(unsigned int i(0); i < r; i++){
+        for(unsigned int j(0); j < c; j++){serialized[i * c + j] = x(i, j);}
+      }
+      CHECK(max_diff(mat_t(r, c, serialized), x) == 0);
+      delete [] serialized;
+    }
+  }
+}
+
+static void test_transpose(){
+  static const unsigned int sizes[] = {1, 3, 31, 32, 33, 67, 256, 513};
+  for(unsigned int p(0); p < sizeof(sizes) / sizeof(sizes[0]); p++){
+    for(unsigned int q(0); q < sizeof(sizes) / sizeof(sizes[0]); q++){
+      const unsigned int r(sizes[p]), c(sizes[q]);
+      if(r * c > 100000){continue;}
+      mat_t x(random_matrix<double>(r, c)), t(x.transpose().copy());
+      bool same(t.rows() == c);
+      for(unsigned int i(0); same && (i < r); i++){
+        for(unsigned int j(0); j < c; j++){same &= (t(j, i) == x(i, j));}
+      }
+      CHECK(same);
+      if(r == c){
+        mat_t s(x);
+        s.transposeInPlace();
+        CHECK((max_diff(s, t) == 0) && (max_diff(x, t.transpose().copy()) == 0));
+      }
+    }
+  }
+  Matrix<float> f(random_matrix<float>(37, 70));
+  CHECK(max_diff<float>(Matrix<float>(f.transpose().copy()).transpose(), f) == 0);
+}
+
+int main(){
+#if __cplusplus >= 201103L
+  test_move();
+#endif
+
+  test_views();
+
+  test_shared_buffer();
+
+#if defined(MATRIX_THREADING) && defined(MATRIX_ATOMIC_REFCOUNT)
+  test_atomic_refcount();
+#endif
+
+  test_copy_on_write();
+
+  test_allocators();
+
+  test_layout();
+
+  test_transpose();
+
+  return test_result("storage");
+}
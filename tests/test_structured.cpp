@@ -0,0 +1,299 @@
+/*
+ * Structured storage, each compared with the same matrix stored densely.
+ */
+#include "test.h"
+
+typedef Matrix<double> mat_t;
+
+static const double tol(1E-12);
+
+static void test_symmetric_packed(const unsigned int &n, const unsigned int &m){
+  mat_t g(random_matrix<double>(n, n)), d(g + g.transpose()), s(d.toSymmetricPacked());
+  mat_t::storage_t::symmetric_view_t sv;
+  CHECK(s.storage()->symmetric_view(sv) && s.isSymmetric());
+  CHECK((max_diff(s, d) == 0) && (max_diff(s.copy(), d) == 0));
+  CHECK(max_diff<double>(s.transpose().copy(), d) == 0);
+
+  mat_t b(random_matrix<double>(n, m)), bt(random_matrix<double>(m, n)), x(random_matrix<double>(n, 1));
+  CHECK(max_diff<double>(s * b, d * b) < tol);
+  CHECK(max_diff<double>(bt * s, bt * d) < tol);
+  CHECK(max_diff<double>(s * bt.transpose(), d * bt.transpose()) < tol);
+  CHECK(max_diff<double>(s * s, d * d) < tol);
+  CHECK(max_diff<double>(s * x, d * x) < tol);
+  CHECK(max_diff<double>(x.transpose() * s, x.transpose() * d) < tol);
+  {
+    mat_t c(random_matrix<double>(n + 2, m + 1)), c2(c.copy());
+    mat_t::partial_t p(c.partial(n, m, 1, 1)), p2(c2.partial(n, m, 1, 1));
+    multiply_into(p, s, b, 2., 0.5);
+    multiply_into(p2, d, b, 2., 0.5);
+    CHECK(max_diff(c, c2) < tol);
+  }
+  { // writes keep the symmetry, and copy on write
+    mat_t s2(s);
+    s2(0, n - 1) = 42;
+    CHECK((s2(n - 1, 0) == 42) && (s(n - 1, 0) == d(n - 1, 0)));
+    mat_t s3(s);
+    s3 *= 3;
+    s3 += s;
+    CHECK((max_diff<double>(s3, d * 4) < tol) && (max_diff(s, d) == 0));
+    mat_t s4(s);
+    add_into(s4, s, 2., 3.);
+    CHECK(max_diff<double>(s4, d * 5) < tol);
+  }
+  { // rank-k update
+    mat_t a(random_matrix<double>(n, m + 3));
+    mat_t p(mat_t::getSymmetricPacked(n)), q(n, n), r(mat_t::getSymmetricPacked(m + 3));
+    symmetric_rank_k_into(p, a);
+    symmetric_rank_k_into(q, a);
+    symmetric_rank_k_into(r, a, 1., 0., true);
+    CHECK(max_diff<double>(p, a * a.transpose()) < tol);
+    CHECK(max_diff<double>(q, a * a.transpose()) < tol);
+    CHECK(max_diff<double>(r, a.transpose() * a) < tol);
+  }
+}
+
+static mat_t sparse_random(const unsigned int &rows, const unsigned int &columns, const int &density){
+  mat_t res(rows, columns);
+  for(unsigned int i(0); i < rows; i++){
+    for(unsigned int j(0); j < columns; j++){
+      if(std::rand() % 100 < density){res(i, j) = double(std::rand()) / RAND_MAX * 2 - 1;}
+    }
+  }
+  return res;
+}
+
+static void test_sparse(const unsigned int &r, const unsigned int &c, const unsigned int &n, const int &density){
+  mat_t d(sparse_random(r, c, density)), s(d.toSparse()), t(d.toSparse(true));
+  mat_t::storage_t::sparse_view_t sv;
+  CHECK(s.storage()->sparse_view(sv) && t.storage()->sparse_view(sv));
+  CHECK((max_diff(s, d) == 0) && (max_diff(t, d) == 0));
+  CHECK((max_diff(s.toDense(), d) == 0) && (max_diff(s.toSparse(true), d) == 0));
+  CHECK(max_diff<double>(s.transpose().toSparse(), d.transpose()) == 0);
+
+  mat_t b(random_matrix<double>(c, n)), l(random_matrix<double>(n, r)), y(random_matrix<double>(r, 1));
+  CHECK(max_diff<double>(s * b, d * b) < tol);
+  CHECK(max_diff<double>(t * b, d * b) < tol);
+  CHECK(max_diff<double>(l * s, l * d) < tol);
+  CHECK(max_diff<double>(l * t, l * d) < tol);
+  CHECK(max_diff<double>(s.transpose() * y, d.transpose() * y) < tol);
+  CHECK(max_diff<double>(t.transpose() * y, d.transpose() * y) < tol);
+  CHECK(max_diff<double>(s * s.transpose(), d * d.transpose()) < tol);
+  CHECK(max_diff<double>(s * t.transpose(), d * d.transpose()) < tol);
+  {
+    mat_t e(random_matrix<double>(r + 2, n + 1)), e2(e.copy());
+    mat_t::partial_t p(e.partial(r, n, 1, 1)), p2(e2.partial(r, n, 1, 1));
+    multiply_into(p, s, b, 2., 0.5);
+    multiply_into(p2, d, b, 2., 0.5);
+    CHECK(max_diff(e, e2) < tol);
+  }
+  { // insertion, copy on write
+    mat_t s2(s), d2(d.copy());
+    s2(0, 0) = 42; s2(r - 1, c - 1) = 7; s2(r / 2, c / 2) += 1;
+    d2(0, 0) = 42; d2(r - 1, c - 1) = 7; d2(r / 2, c / 2) += 1;
+    CHECK((max_diff(s2, d2) == 0) && (max_diff(s, d) == 0));
+    mat_t z(mat_t::getSparse(r, c));
+    for(unsigned int j(c); j-- > 0;){
+      for(unsigned int i(r); i-- > 0;){
+        if(d(i, j) != 0){z(i, j) = d(i, j);}
+      }
+    }
+    CHECK(max_diff(z, d) == 0);
+  }
+}
+
+static void test_sparse_views(){
+  { // insertion into the matrix, then writing through the view
+    mat_t s(mat_t::getSparse(4, 4));
+    mat_t::partial_t p(s.partial(2, 2, 0, 0));
+    s(1, 2) = 5;
+    s(0, 0) = 1;
+    p(0, 0) = 42;
+    CHECK((s(0, 0) == 42) && (s(1, 2) == 5) && (p(0, 0) == 42));
+  }
+  { // insertion through the view, then into the matrix
+    mat_t s(mat_t::getSparse(4, 4));
+    mat_t::transposed_t t(s.transpose());
+    t(2, 1) = 5;
+    s(3, 3) = 2;
+    s(1, 2) += 1;
+    CHECK((s(1, 2) == 6) && (t(2, 1) == 6) && (t(3, 3) == 2));
+    mat_t c(s); // deep, because the view is alive
+    c(0, 0) = 1;
+    CHECK((s(0, 0) == 0) && (t(0, 0) == 0) && (c(1, 2) == 6));
+  }
+  { // insertions from both sides, which reallocate the arrays several times
+    mat_t s(mat_t::getSparse(6, 6, true)), d(6, 6);
+    mat_t::partial_t p(s.partial(3, 4, 2, 1));
+    for(unsigned int k(0); k < 18; k++){
+      const unsigned int i(k % 3), j((k * 5) % 4);
+      if(k % 2){p(i, j) += k; d(i + 2, j + 1) += k;}
+      else{s(5 - i, j) = k; d(5 - i, j) = k;}
+    }
+    mat_t::storage_t::sparse_view_t sv;
+    CHECK(s.storage()->sparse_view(sv) && (max_diff(s, d) == 0));
+    CHECK(max_diff<double>(p, d.partial(3, 4, 2, 1)) == 0);
+  }
+}
+
+static mat_t band_of(const mat_t &a, const int &lower, const int &upper){
+  mat_t res(a.rows(), a.columns());
+  for(int i(0); i < (int)a.rows(); i++){
+    for(int j(0); j < (int)a.columns(); j++){
+      if((j - i >= -lower) && (j - i <= upper)){res(i, j) = a(i, j);}
+    }
+  }
+  return res;
+}
+
+static void test_banded(const unsigned int &r, const unsigned int &c, const int &lower, const int &upper){
+  mat_t d0(random_matrix<double>(r, c));
+  for(unsigned int i(0); (i < r) && (i < c); i++){d0(i, i) += 4 + lower + upper;} // diagonally dominant
+  mat_t d(band_of(d0, lower, upper)), s(d0.toBanded(lower, upper));
+  mat_t::storage_t::band_view_t bv;
+  CHECK(s.storage()->band_view(bv));
+  CHECK((max_diff(s, d) == 0) && (max_diff(s.toDense(), d) == 0));
+
+  mat_t b(random_matrix<double>(c, 3)), l(random_matrix<double>(3, r)), x(random_matrix<double>(c, 1));
+  CHECK(max_diff<double>(s * b, d * b) < tol);
+  CHECK(max_diff<double>(l * s, l * d) < tol);
+  CHECK(max_diff<double>(s.transpose() * l.transpose(), d.transpose() * l.transpose()) < tol);
+  CHECK(max_diff<double>(s * x, d * x) < tol);
+  CHECK(max_diff<double>(s * s.transpose(), d * d.transpose()) < tol * (c + 1));
+  { // addition of other band widths and dense ones
+    mat_t s2(s);
+    s2 *= 3;
+    s2 += s;
+    CHECK((max_diff<double>(s2, d * 4) < tol) && (max_diff(s, d) == 0));
+    mat_t e(d0.toBanded(lower + 1, upper));
+    e -= s;
+    CHECK(max_diff<double>(e, band_of(d0, lower + 1, upper) - d) < tol);
+    mat_t f(random_matrix<double>(r, c)), g(s);
+    g += f;
+    CHECK(max_diff<double>(g, d + f) < tol);
+  }
+  if(r == c){
+    CHECK(max_diff<double>(d * s.solve(b), b) < 1E-9);
+    CHECK(max_diff<double>(d.transpose() * s.transpose().solve(b), b) < 1E-9);
+  }
+}
+
+static void test_diagonal_triangular(){
+  mat_t I(mat_t::getI(5)), a(random_matrix<double>(5, 5)), b(random_matrix<double>(5, 2));
+  for(unsigned int i(0); i < 5; i++){a(i, i) += 3;}
+  CHECK(I.isDiagonal() && (max_diff<double>(I * a, a) == 0) && (max_diff<double>(a * I, a) == 0));
+  CHECK(max_diff<double>(mat_t::getScalar(5, 3.) * a, a * 3.) == 0);
+  CHECK(max_diff<double>(I + a, a + I.toDense()) == 0);
+  CHECK(max_diff<double>(a.inverse() * a, I) < tol);
+  CHECK(I.determinant() == 1);
+
+  mat_t lu(a.copy());
+  unsigned int pivot[5];
+  lu.decomposeLUP(pivot);
+  mat_t lower(lu.toTriangular(true, true)), upper(lu.toTriangular(false)), pa(a.copy());
+  for(unsigned int i(0); i < 5; i++){pa.exchangeRows(i, pivot[i]);}
+  CHECK(max_diff<double>(lower * upper, pa) < tol);
+  CHECK(max_diff<double>(upper * upper.solve(b), b) < 1E-10);
+  CHECK(max_diff<double>(lower * lower.solve(b), b) < 1E-10);
+
+  mat_t t(mat_t::getTriangular(4, true)), t2(t);
+  t(3, 0) = 1;
+  CHECK((t(3, 0) == 1) && (t(0, 3) == 0) && (t2(3, 0) == 0));
+  mat_t y(mat_t::getI(5));
+  assign_into(y, a + I);
+  CHECK(max_diff<double>(y, a + I) == 0);
+}
+
+static void test_structural_zero_views(){
+  mat_t block(2, 2), x(1, 3);
+  block(0, 0) = 0; block(0, 1) = 1; block(1, 0) = 10; block(1, 1) = 11;
+  x(0, 0) = 0; x(0, 1) = 1; x(0, 2) = 2;
+
+  // views created from getI() must be able to write the off-diagonal elements
+  {mat_t I(mat_t::getI(3)); I.partial(2, 2, 0, 0)(0, 1) = 5; CHECK(I(0, 1) == 5);}
+  {mat_t I(mat_t::getI(3)); I.transpose()(1, 0) = 6; CHECK(I(0, 1) == 6);}
+  {
+    mat_t I(mat_t::getI(3));
+    I.partial(2, 2, 0, 0) = block;
+    CHECK((I(0, 1) == 1) && (I(1, 0) == 10) && (I(1, 1) == 11) && (I(2, 2) == 1));
+  }
+  {
+    mat_t I(mat_t::getI(3));
+    I.rowVector(1) = x + x;
+    CHECK((I(1, 0) == 0) && (I(1, 1) == 2) && (I(1, 2) == 4));
+    I.columnVector(2) = mat_t(x.transpose());
+    CHECK((I(0, 2) == 0) && (I(1, 2) == 1) && (I(2, 2) == 2));
+  }
+  {
+    mat_t I(mat_t::getI(3));
+    I.partial(3, 3, 0, 0).exchangeRows(0, 1);
+    CHECK((I(0, 1) == 1) && (I(1, 0) == 1) && (I(0, 0) == 0) && (I(2, 2) == 1));
+  }
+  { // read-only access and copies keep the diagonal storage
+    mat_t D(mat_t::getScalar(3, 2)), C(D);
+    C.partial(3, 3, 0, 0)(0, 2) = 7;
+    const mat_t &D_const(D);
+    mat_t::storage_t::band_view_t bv;
+    CHECK(D.storage()->band_view(bv) && (D_const(0, 2) == 0) && (C(0, 2) == 7));
+    CHECK((D_const.transpose()(1, 1) == 2) && D.storage()->band_view(bv));
+    D(1, 1) = 3;
+    CHECK(D.storage()->band_view(bv) && (D(1, 1) == 3));
+    D(1, 0) = 4;
+    CHECK(!D.storage()->band_view(bv) && (D(1, 0) == 4) && (D(1, 1) == 3));
+  }
+  { // reading through the views keeps the storage, which is made dense by the first structural zero written
+    mat_t L(mat_t::getTriangular(3, true)), x(3, 1), y;
+    for(unsigned int i(0); i < 3; i++){
+      for(unsigned int j(0); j <= i; j++){L(i, j) = i * 3 + j + 1;}
+      x(i, 0) = i + 1;
+    }
+    mat_t dense_L(L.toDense());
+    mat_t::storage_t::band_view_t bv;
+    y = L.transpose() * x;
+    CHECK(L.storage()->band_view(bv) && (max_diff<double>(y, dense_L.transpose() * x) == 0));
+    mat_t::partial_t p(L.partial(2, 3, 1, 0));
+    CHECK((max_diff<double>(p * x, dense_L.partial(2, 3, 1, 0) * x) == 0) && L.storage()->band_view(bv));
+    p(1, 1) = -1;
+    CHECK(L.storage()->band_view(bv) && (L(2, 1) == -1));
+    p(0, 2) = 9;
+    CHECK(!L.storage()->band_view(bv) && (L(1, 2) == 9) && (p(0, 2) == 9) && (L(2, 1) == -1));
+  }
+  { // a view of a const matrix is a snapshot, which is made dense by itself
+    const mat_t cI(mat_t::getI(3));
+    mat_t::partial_t p(cI.partial(3, 3, 0, 0));
+    p(0, 1) = 5;
+    mat_t::storage_t::band_view_t bv;
+    CHECK((p(0, 1) == 5) && (p(1, 1) == 1) && (cI(0, 1) == 0) && cI.storage()->band_view(bv));
+  }
+}
+
+int main(){
+  static const unsigned int ns[] = {1, 2, 3, 5, 17, 64, 65, 130};
+  for(unsigned int i(0); i < sizeof(ns) / sizeof(ns[0]); i++){
+    test_symmetric_packed(ns[i], 1);
+    test_symmetric_packed(ns[i], 7);
+  }
+
+  static const unsigned int rs[] = {1, 2, 7, 64, 150}, cs[] = {1, 3, 65, 200};
+  static const int densities[] = {0, 5, 50, 100};
+  for(unsigned int i(0); i < sizeof(rs) / sizeof(rs[0]); i++){
+    for(unsigned int j(0); j < sizeof(cs) / sizeof(cs[0]); j++){
+      for(unsigned int k(0); k < sizeof(densities) / sizeof(densities[0]); k++){
+        test_sparse(rs[i], cs[j], 5, densities[k]);
+      }
+    }
+  }
+  test_sparse_views();
+
+  static const unsigned int sizes[] = {1, 2, 5, 70, 150};
+  static const int widths[][2] = {{0, 0}, {1, 1}, {0, 3}, {2, 0}, {7, 2}, {200, 0}, {0, 64}, {80, 90}};
+  for(unsigned int i(0); i < sizeof(sizes) / sizeof(sizes[0]); i++){
+    for(unsigned int j(0); j < sizeof(widths) / sizeof(widths[0]); j++){
+      test_banded(sizes[i], sizes[i], widths[j][0], widths[j][1]);
+      test_banded(sizes[i], sizes[i] + 3, widths[j][0], widths[j][1]);
+    }
+  }
+  test_diagonal_triangular();
+  test_structural_zero_views();
+
+  return test_result("structured");
+}
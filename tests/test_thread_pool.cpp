@@ -0,0 +1,89 @@
+#include "test.h"
+
+#if defined(MATRIX_THREADING)
+#include <chrono>
+
+struct pool_t : public Matrix_ThreadPool {
+  pool_t(const unsigned int &threads) : Matrix_ThreadPool(threads) {}
+  unsigned int active(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active;
+  }
+};
+
+struct count_context_t {
+  std::atomic<unsigned int> hits[64];
+  std::atomic<unsigned int> calls;
+  count_context_t() : calls(0) {
+    for(int i(0); i < 64; i++){hits[i] = 0;}
+  }
+  static void task(void *context, const unsigned int &index){
+    count_context_t &self(*static_cast<count_context_t *>(context));
+    ++self.hits[index];
+    ++self.calls;
+  }
+  bool each_once(const unsigned int &tasks){
+    for(unsigned int i(0); i < tasks; i++){
+      if(hits[i] != 1){return false;}
+    }
+    return calls == tasks;
+  }
+};
+
+static void test_run(pool_t &pool, const unsigned int &tasks){
+  count_context_t context;
+  pool.run(count_context_t::task, &context, tasks);
+  CHECK(context.each_once(tasks));
+  CHECK(pool.active() == 0);
+}
+
+int main(){
+  pool_t pool(4);
+  CHECK(pool.size() == 4);
+  test_run(pool, 64);
+
+  // The workers created by resize() must not run the job before it.
+  count_context_t previous;
+  pool.run(count_context_t::task, &previous, 16);
+  CHECK(previous.each_once(16));
+  pool.resize(3);
+  CHECK(pool.size() == 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  CHECK(previous.calls == 16);
+  CHECK(pool.active() == 0);
+  test_run(pool, 64);
+
+  pool.resize(1);
+  CHECK(pool.size() == 1);
+  test_run(pool, 8);
+  pool.resize(5);
+  test_run(pool, 64);
+  test_run(pool, 1);
+
+  { // run() and size() concurrently with resize()
+    std::atomic<bool> done(false);
+    std::atomic<int> failures(0);
+    std::thread caller([&pool, &done, &failures](){
+      while(!done){
+        count_context_t context;
+        unsigned int size(pool.size());
+        pool.run(count_context_t::task, &context, 32);
+        if((size < 1) || (size > 5) || !context.each_once(32)){++failures;}
+      }
+    });
+    for(int k(0); k < 200; k++){pool.resize((k % 4) + 1);}
+    done = true;
+    caller.join();
+    CHECK(failures == 0);
+    CHECK(pool.active() == 0);
+  }
+  pool.resize(2);
+  test_run(pool, 64);
+
+  return test_result("thread_pool");
+}
+#else
+int main(){
+  return test_result("thread_pool (threading disabled)");
+}
+#endif